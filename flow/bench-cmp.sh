@@ -0,0 +1,18 @@
+#!/bin/bash
+#   bench-cmp.sh
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+#   Compare two "make bench" results (e.g. of two commits): a, b, change.
+
+if [ "$#" -ne 2 ]; then
+    echo "Usage: bench-cmp <a/bench.txt> <b/bench.txt>"
+    exit 1
+fi
+
+awk -F '\t' '
+    $1 != "[bench]" { next }
+    NR == FNR { a[$2] = $3; next }
+    $2 == "rev" { printf("%-16s\t%12s\t%12s\n", "rev", a[$2], $3); next }
+    $2 in a {
+        printf("%-16s\t%12.3f\t%12.3f\t%+7.1f%%\t%s\n", $2, a[$2], $3,
+                a[$2] != 0 ? 100 * ($3 / a[$2] - 1) : 0, $4)
+    }' $1 $2
@@ -0,0 +1,54 @@
+#!/bin/bash
+#   bench.sh
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+#   End-to-end benchmarks in <dir>: readvcd on a synthetic VCD, and the
+#   simulation speed of each operation if mldsa_wrap is built.
+#   Prints "[bench] name value unit" lines like vcdbench.
+
+if [ "$#" -ne 1 ]; then
+    echo "Usage: bench <dir>"
+    exit 1
+fi
+
+flow="$(dirname $(realpath $0))"
+root="$(dirname $flow)"
+mkdir -p $1
+cd $1
+
+put() {
+    printf "[bench]\t%-16s\t%12.3f\t%s\n" $1 $2 $3
+}
+
+#   readvcd: read, parse, write the toggle log
+$root/vcdbench gen > bench.vcd
+t0=`date +%s.%N`
+$root/readvcd bench.vcd dec_prim.cyc > bench.log
+t1=`date +%s.%N`
+put readvcd `awk -v s=$(stat -c %s bench.vcd) -v t=$t0 -v u=$t1 \
+    'BEGIN { print s / (u - t) * 1E-6 }'` MB/s
+rm -f bench.vcd bench.log
+
+if [ ! -x $root/mldsa_wrap ]; then
+    echo "[bench] no mldsa_wrap; simulation skipped" 1>&2
+    exit 0
+fi
+
+#   same inputs every time (as the pgo training run)
+if [ ! -e sk_in.dat ]; then
+    python3 $flow/mldsa-gen.py bench 0123456789ABCDEF > /dev/null
+    python3 -c "import hashlib; open('ent_in.dat', 'wb').write(hashlib.shake_256(b'bench').digest(64))"
+fi
+
+#   cycles/s from the [TIME] line
+sim() {
+    name=$1
+    shift
+    $root/mldsa_wrap "$@" > run-$name.log
+    put sim_$name `grep -a '^\[TIME\]' run-$name.log | awk '{ print $(NF-1) }'` cycles/s
+}
+
+sim keygen keygen
+sim sign sign
+sim verify verify
+sim sign_vcd -vcd /dev/null sign
+sim sign_state -state /dev/null sign
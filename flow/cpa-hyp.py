@@ -0,0 +1,139 @@
+#   cpa-hyp.py
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+
+#   Leakage-model hypotheses for src/cpa.c: one row per trace of a campaign
+#   store, one column per (model, intermediate). Secrets are read from the
+#   trace directories recorded in the store (sk_in.dat, label.txt), found
+#   under the trace root (-d, default: the directory of the store).
+
+import sys, os, struct, array
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from fips204 import ML_DSA
+
+HYP_MAGIC   =   0x3150594852424100      #   "\0ABRHYP1"
+HYP_NAME    =   32
+META_FMT    =   '<BBhiq32s64s'          #   trs_meta_t
+
+def hw(x):
+    return bin(x).count('1')
+
+def store_names(store):
+    """ Source directories of the traces, in store order."""
+    sz  = struct.calcsize(META_FMT)
+    b   = open(os.path.join(store, 'trs.meta'), 'rb').read()
+    return [ struct.unpack_from(META_FMT, b, i)[6].rstrip(b'\0').decode()
+                for i in range(0, len(b) - sz + 1, sz) ]
+
+#   input files that were not found
+missing = []
+
+def need(fn):
+    if os.path.exists(fn):
+        return True
+    missing.append(fn)
+    return False
+
+#   --- models: (names, function of a trace directory -> values or None)
+
+def m_label(arg):
+    names = [ 'label', 'hw(label)', 'label%16' ] + [
+                'label.b%d' % i for i in range(8) ]
+    def f(d):
+        fn = os.path.join(d, 'label.txt')
+        if not need(fn):
+            return None
+        x = int(open(fn).read().split()[0])
+        return [ x, hw(x), x % 16 ] + [ (x >> i) & 1 for i in range(8) ]
+    return names, f
+
+#   secret polynomials, cached per key (fixed-key traces share one)
+sk_cache = {}
+ml_dsa  = ML_DSA()
+
+def sk_polys(d, vec, ntt):
+    fn = os.path.join(d, 'sk_in.dat')
+    if not need(fn):
+        return None
+    sk  = open(fn, 'rb').read()
+    key = (sk, vec, ntt)
+    if key not in sk_cache:
+        (rho, kk, tr, s1, s2, t0) = ml_dsa.sk_decode(sk)
+        v = s1 if vec == 's1' else s2
+        v = [ [ x % ml_dsa.q for x in p ] for p in v ]
+        if ntt:
+            v = [ ml_dsa.ntt(p) for p in v ]
+        sk_cache[key] = v
+    return sk_cache[key]
+
+def m_sk(model, arg):
+    """ s1, s2, s1ntt, s2ntt: Hamming weight of each coefficient mod q;
+        "s1:3" restricts to polynomial 3."""
+    vec = model[:2]
+    ntt = model.endswith('ntt')
+    npoly = ml_dsa.ell if vec == 's1' else ml_dsa.k
+    polys = [ int(arg) ] if arg != None else range(npoly)
+    tag = vec + ('^' if ntt else '')
+    names = [ 'hw(%s[%d][%d])' % (tag, i, j) for i in polys
+                for j in range(256) ]
+    def f(d):
+        v = sk_polys(d, vec, ntt)
+        if v == None:
+            return None
+        return [ hw(v[i][j]) for i in polys for j in range(256) ]
+    return names, f
+
+def model(s):
+    (m, _, arg) = s.partition(':')
+    if m == 'label':
+        return m_label(arg or None)
+    if m in [ 's1', 's2', 's1ntt', 's2ntt' ]:
+        return m_sk(m, arg or None)
+    sys.exit('unknown model: ' + s)
+
+if __name__ == '__main__':
+    argv = sys.argv[1:]
+    root = None
+    if len(argv) >= 2 and argv[0] == '-d':
+        root = argv[1]
+        argv = argv[2:]
+    if len(argv) < 3:
+        print('Usage: cpa-hyp.py [-d <trace root>] <store> <out.hyp> <model> ..')
+        print('models: label, s1, s2, s1ntt, s2ntt (":i" for one poly)')
+        print('trace root: directory of the _tr_* dirs (default: that of the store)')
+        sys.exit(1)
+    if root == None:
+        root = os.path.dirname(os.path.abspath(argv[0]))
+
+    dirs    =   [ os.path.join(root, x) for x in store_names(argv[0]) ]
+    models  =   [ model(s) for s in argv[2:] ]
+    names   =   [ x for (n, f) in models for x in n ]
+    nh      =   len(names)
+
+    with open(argv[1], 'wb') as fp:
+        fp.write(struct.pack('<QQQ40x', HYP_MAGIC, len(dirs), nh))
+        for x in names:
+            fp.write(x.encode()[:HYP_NAME - 1].ljust(HYP_NAME, b'\0'))
+        nan = 0
+        for d in dirs:
+            row = []
+            for (n, f) in models:
+                v = f(d)
+                if v == None:
+                    break
+                row += v
+            if len(row) != nh:
+                row = [ float('nan') ] * nh
+                nan += 1
+            fp.write(array.array('f', row).tobytes())
+
+    for fn in missing[:10]:
+        print('cpa-hyp.py: missing', fn, file=sys.stderr)
+    if len(missing) > 10:
+        print('cpa-hyp.py: ..', len(missing) - 10, 'more missing',
+                file=sys.stderr)
+    print('[hyp]', argv[1] + ':', len(dirs), 'traces,', nh,
+            'hypotheses,', nan, 'skipped')
+    if nan > 0 and nan == len(dirs):
+        sys.exit('cpa-hyp.py: no trace has its inputs under ' + root +
+                    ' (-d <trace root>)')
@@ -0,0 +1,75 @@
+#!/bin/bash
+#   edge-check.sh
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+#   In a _tr_* directory (as flow/sim.sh): run the operation twice, with a
+#   dump at both clock edges and with mldsa_wrap -edge, and compare the
+#   per-cycle toggle counts (total, rise, fall) and the totals of the two.
+
+if [ "$#" -lt 3 ]; then
+    echo "Usage: edge-check <maxcyc> <op> <clock globs> [readvcd options]"
+    echo "  e.g. edge-check 40000 sign 'mldsa_wrap.clk,*clk_g' dec_prim.cyc 1"
+    exit 1
+fi
+
+maxcyc="$1"
+op="$2"
+clk="$3"
+shift 3
+vcdprm="$@"
+if [ -z "$vcdprm" ]; then
+    vcdprm="dec_prim.cyc 1"
+fi
+wrap=../mldsa_wrap
+rvcd=../readvcd
+
+#   one run; bytes and time steps of the vcd stream go to <x>.sz
+run() {
+    local x="$1"
+    shift
+    rm -f $x.vcd $x.rv
+    mkfifo $x.vcd $x.rv
+    $rvcd -clk "$clk" -rf -s $RV $x.rv $vcdprm > $x.log &
+    $wrap -t $maxcyc "$@" -vcd $x.vcd $op > $x.run &
+    tee $x.rv < $x.vcd | \
+        awk '{ b += length($0) + 1 } /^#/ { t++ } END { print b, t }' > $x.sz
+    wait
+    rm -f $x.vcd $x.rv
+}
+
+RV=""   run full
+RV="-e" run edge -edge
+
+awk '
+    FNR == 1 { f++ }
+    /^# *[0-9]+ \[togd\]/ {
+        s = $0; sub(/^#/, "", s); split(s, v)
+        c = v[1] + 0
+        if (f == 1) { a[c] = v[3] " " v[4] " " v[5]; ta += v[3] }
+        else        { b[c] = v[3] " " v[4] " " v[5]; tb += v[3] }
+        if (c0 == "" || c < c0) c0 = c
+        n[c] = 1
+        if (c1 == "" || c > c1) c1 = c
+    }
+    END {
+        for (c = c0; c <= c1; c++) {
+            if (!(c in n))
+                continue
+            m++
+            if (a[c] == "") a[c] = "0 0 0"
+            if (b[c] == "") b[c] = "0 0 0"
+            if (a[c] != b[c]) {
+                d++
+                if (d <= 10)
+                    printf("cycle %d: full %s, edge %s\n", c, a[c], b[c])
+            }
+        }
+        printf("=== edge check: %d cycles, %d differ; total full %d, edge %d\n",
+                m, d, ta, tb)
+        exit d > 0 || ta != tb
+    }' full.log edge.log
+st=$?
+
+read fb ft < full.sz
+read eb et < edge.sz
+echo "=== full: $fb bytes, $ft steps; edge: $eb bytes, $et steps"
+exit $st
@@ -8,7 +8,17 @@ maxcyc="$1"
 vcdprm="$(cat $2)"
 
 #   make _build/Vmldsa_wrap readvcd
+#   SEED=<hex>: inputs from the seed and the run name (repeatable)
+#   SIM_CACHE=<dir>: reuse the outputs of identical runs (flow/sim.sh)
+#   TRS=<store>: append each finished trace to the store (exit status 1
+#   if any could not be added)
+#   TVLA_STOP=<file>: end early once it exists (tvla -f -x <file>)
+fail=0
 for x in `seq $4`; do
+    if [ -n "$TVLA_STOP" ] && [ -e "$TVLA_STOP" ]; then
+        echo "=== stop: `cat $TVLA_STOP`"
+        break
+    fi
     tmpdir="_tr_fix-$3-$x"
     echo "=== $tmpdir ==="
     mkdir -p $tmpdir
@@ -16,16 +26,29 @@ for x in `seq $4`; do
     echo "tmpdir=${tmpdir}" | tee param.txt
     echo "maxcyc=${maxcyc}" | tee -a param.txt
     echo "vcdprm=${vcdprm}" | tee -a param.txt
-    dd if=/dev/urandom of=ent_in.dat bs=1 count=64
-    randxi=`cat /dev/urandom | tr -dc '0-9A-F' | head -c 64`
+    if [ -n "$SEED" ]; then
+        python3 -c "import hashlib; open('ent_in.dat', 'wb').write(hashlib.shake_256(b'$SEED/$tmpdir').digest(64))"
+        randxi=`echo -n "$SEED/$tmpdir" | sha256sum | cut -c 1-64 | tr a-f A-F`
+    else
+        dd if=/dev/urandom of=ent_in.dat bs=1 count=64
+        randxi=`cat /dev/urandom | tr -dc '0-9A-F' | head -c 64`
+    fi
     echo "randxi=${randxi}" | tee -a param.txt
     fixkey=00
     echo "fixkey=${fixkey}" | tee -a param.txt
     python3 ../flow/mldsa-gen.py $tmpdir $randxi $fixkey
-    mkfifo trace.vcd
-    ../readvcd trace.vcd $vcdprm > trace.log &
-    ../mldsa_wrap -t $maxcyc -vcd trace.vcd sign | tee run.log
-    gzip *.log
+    ../flow/sim.sh $maxcyc sign $vcdprm
     cd ..
+    if [ -n "$TRS" ]; then
+        #   75: another writer holds the store; anything else is an error
+        while ./trs add $TRS $tmpdir; st=$?; [ $st -eq 75 ]; do
+            sleep 1
+        done
+        if [ $st -ne 0 ]; then
+            echo "=== $tmpdir: not added to $TRS"
+            fail=1
+        fi
+    fi
 done
+exit $fail
 
@@ -8,6 +8,8 @@ maxcyc="$1"
 vcdprm="$(cat $2)"
 
 #   make _build/Vmldsa_wrap readvcd
+#   SEED=<hex>: inputs from the seed and the run name (repeatable)
+#   SIM_CACHE=<dir>: reuse the outputs of identical runs (flow/sim.sh)
 for x in `seq $4`; do
     tmpdir="_tr_kgr-$3-$x"
     echo "=== $tmpdir ==="
@@ -16,14 +18,16 @@ for x in `seq $4`; do
     echo "tmpdir=${tmpdir}" | tee param.txt
     echo "maxcyc=${maxcyc}" | tee -a param.txt
     echo "vcdprm=${vcdprm}" | tee -a param.txt
-    dd if=/dev/urandom of=ent_in.dat bs=1 count=64
-    randxi=`cat /dev/urandom | tr -dc '0-9A-F' | head -c 64`
+    if [ -n "$SEED" ]; then
+        python3 -c "import hashlib; open('ent_in.dat', 'wb').write(hashlib.shake_256(b'$SEED/$tmpdir').digest(64))"
+        randxi=`echo -n "$SEED/$tmpdir" | sha256sum | cut -c 1-64 | tr a-f A-F`
+    else
+        dd if=/dev/urandom of=ent_in.dat bs=1 count=64
+        randxi=`cat /dev/urandom | tr -dc '0-9A-F' | head -c 64`
+    fi
     echo "randxi=${randxi}" | tee -a param.txt
     python3 ../flow/mldsa-gen.py $tmpdir $randxi
-    mkfifo trace.vcd
-    ../readvcd trace.vcd $vcdprm > trace.log &
-    ../mldsa_wrap -t $maxcyc -vcd trace.vcd kgsign | tee run.log
-    gzip *.log
+    ../flow/sim.sh $maxcyc kgsign $vcdprm
     cd ..
 done
 
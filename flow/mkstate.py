@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+
+#   mkstate.py
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+
+#   Generate the model-state table for mldsa_wrap -state: every signal
+#   and register stored in the Verilator root class, as a function that
+#   reports (name, address, size) of each member to the harness.
+
+import sys, re
+
+#   member declarations in Vmldsa_wrap___024root.h
+DATA    =   r'(?:CData|SData|IData|QData|EData|VlWide<\d+>)(?:/\*\d+:\d+\*/)?'
+RE_VAR  =   re.compile(r'^\s*(' + DATA + r'|VlUnpacked<.*>)\s+(\w+);')
+RE_PORT =   re.compile(r'^\s*VL_(?:IN|OUT|INOUT)(?:8|16|64|W)?\((\w+),')
+
+def signame(s):
+    """ Flattened C++ member name to a hierarchical signal name."""
+    s = s.replace('__DOT__', '.')
+    s = s.replace('__05F', '_').replace('__024', '$')
+    return s
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print('Usage: mkstate.py <Vmodel___024root.h> [timing signal]')
+        sys.exit(1)
+    root_h  = sys.argv[1]
+    timing  = sys.argv[2] if len(sys.argv) > 2 else 'dec_prim.cyc'
+    root    = root_h.split('/')[-1][:-2]
+
+    mem = []
+    for line in open(root_h):
+        m = RE_VAR.match(line) or RE_PORT.match(line)
+        if m:
+            mem += [ m.groups()[-1] ]
+
+    #   timing (cycle) signal: shortest member name with the suffix
+    cyc = sorted([ x for x in mem
+                    if signame(x).endswith('.' + timing) ], key=len)
+
+    print('//  generated by flow/mkstate.py from', root_h.split('/')[-1])
+    print()
+    print('#include "' + root + '.h"')
+    print()
+    print('#define STATE_ROOT', root)
+    if len(cyc) > 0:
+        print('#define STATE_CYC(r) ((int64_t) (r)->' + cyc[0] + ')')
+    else:
+        sys.stderr.write('mkstate.py: no timing signal ' + timing + '\n')
+        print('#define STATE_CYC(r) ((int64_t) -1)')
+    print('#define STATE_N', len(mem))
+    print()
+    print('static void state_vars(const ' + root + ' *r)')
+    print('{')
+    for x in mem:
+        print('    state_var("' + signame(x) + '", &r->' + x +
+                ', sizeof(r->' + x + '));')
+    print('}')
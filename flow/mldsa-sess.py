@@ -0,0 +1,39 @@
+#   mldsa-sess.py
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi> See LICENSE.
+
+#   Session lists for mldsa_wrap -sess: n random messages under one key.
+#   sign.sess (hash rnd ent) and verify.sess (hash sig) are the inputs,
+#   sign.ref has the expected signatures in the format of the result lines
+#   (index, signature), for  cut -f1,4 sess_res.txt | diff - sign.ref
+
+import sys, os
+from fips204 import ML_DSA
+
+from Crypto.Hash import SHA512
+
+if __name__ == '__main__':
+    ml_dsa = ML_DSA()
+
+    n       = int(sys.argv[1]) if len(sys.argv) > 1 else 10
+    kg_seed = bytes.fromhex(sys.argv[2]) if len(sys.argv) > 2 else bytes(32)
+
+    pk, sk  = ml_dsa.keygen_internal(kg_seed, 'ML-DSA-87')
+
+    with open("pk_in.dat", "wb") as f:
+        f.write(pk)
+    with open("sk_in.dat", "wb") as f:
+        f.write(sk)
+
+    with open("sign.sess", "w") as fs, open("verify.sess", "w") as fv, \
+         open("sign.ref", "w") as fr:
+        for i in range(n):
+            mhash   = SHA512.new(os.urandom(32)).digest()
+            rnd     = os.urandom(32)
+            ent     = os.urandom(64)
+            mp      = bytes([ 0, 0 ]) + mhash
+            sig     = ml_dsa.sign_internal(sk, mp, rnd)
+            fs.write(mhash.hex() + ' ' + rnd.hex() + ' ' + ent.hex() + '\n')
+            fv.write(mhash.hex() + ' ' + sig.hex() + '\n')
+            fr.write(str(i) + '\t' + sig.hex() + '\n')
+
+    print('#', n, 'operations: sign.sess verify.sess sign.ref')
@@ -0,0 +1,30 @@
+#!/bin/bash
+#   pgo-run.sh
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+#   Training / benchmark workload for the profile-guided build:
+#   keygen, verify, and a traced sign with fixed inputs in <dir>.
+
+if [ "$#" -ne 2 ]; then
+    echo "Usage: pgo-run <mldsa_wrap> <dir>"
+    exit 1
+fi
+
+flow="$(dirname $(realpath $0))"
+wrap="$(realpath $1)"
+mkdir -p $2
+cd $2
+
+#   same inputs every time
+if [ ! -e sk_in.dat ]; then
+    python3 $flow/mldsa-gen.py pgo 0123456789ABCDEF > /dev/null
+    python3 -c "import hashlib; open('ent_in.dat', 'wb').write(hashlib.shake_256(b'pgo').digest(64))"
+fi
+
+#   sign last: a --prof-pgo model writes profile.vlt at exit
+rm -f run.log
+$wrap keygen >> run.log
+$wrap verify >> run.log
+$wrap -vcd /dev/null sign >> run.log
+
+grep -a '^\[TIME\]' run.log | awk -v w="$1" \
+    '{ c += $2; s += $3 } END { printf("[pgo-run] %s: %d cycles, %.3f s, %.0f cycles/s\n", w, c, s, c / s) }'
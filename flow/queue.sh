@@ -0,0 +1,201 @@
+#!/bin/bash
+#   queue.sh
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+#   Work queue in a shared directory, for campaigns over many hosts.
+#   A job is a bash script in todo/. A worker claims one by renaming it to
+#   lease/<job>@<host>.<pid> (only one rename succeeds), keeps the lease
+#   alive by touching it, and renames it to done/ or fail/ at the end.
+#   A lease that has not been touched for QUEUE_TTL seconds belongs to a
+#   dead worker; any worker moves it back to todo/. Jobs must therefore
+#   be safe to run twice (write their results with a rename). A job with
+#   a "#barrier" line waits until nothing else is queued or leased.
+
+QUEUE_HB=${QUEUE_HB:-10}        #   heartbeat interval, seconds
+QUEUE_TTL=${QUEUE_TTL:-60}      #   lease expiry, seconds
+QUEUE_MAX=${QUEUE_MAX:-3}       #   leases per job before it fails
+
+usage() {
+    echo "Usage: queue <command> <queue dir> .."
+    echo "  init <q>                    new queue; jobs run in this directory"
+    echo "  add <q> <job> <command..>   add a job (a line of bash)"
+    echo "  tvla <q> <cyc0> <ncyc> <maxcyc> <readvcd.prm> <jobs> <n>"
+    echo "                              fix/rnd campaign: jobs x n traces of"
+    echo "                              each class, one merged tvla state"
+    echo "  work <q>                    run jobs until the queue is empty"
+    echo "  stat <q>                    job counts and leases"
+    exit 1
+}
+
+if [ "$#" -lt 2 ]; then
+    usage
+fi
+cmd="$1"
+q="$(realpath -m $2)"
+shift 2
+me="`hostname -s`.$$"
+
+#   job file, written aside and renamed in
+put() {
+    if [ -e $q/done/$1 ]; then
+        return
+    fi
+    cat > $q/tmp/$1.$me
+    mv $q/tmp/$1.$me $q/todo/$1
+}
+
+#   time on the shared filesystem (hosts may disagree on the clock)
+now() {
+    touch $q/tmp/now.$me
+    stat -c %Y $q/tmp/now.$me
+}
+
+#   expired leases back to todo/, or to fail/ after QUEUE_MAX leases
+reap() {
+    local t=`now` f job n
+    for f in $q/lease/*; do
+        if [ ! -e "$f" ] || [ $((t - `stat -c %Y $f 2> /dev/null || echo $t`)) -lt $QUEUE_TTL ]; then
+            continue
+        fi
+        job="`basename $f`"
+        job="${job%@*}"
+        n=`grep -c '^#lease ' $f 2> /dev/null`
+        if [ "$n" -ge $QUEUE_MAX ]; then
+            mv $f $q/fail/$job 2> /dev/null && echo "=== queue: $job failed, lease expired $n times"
+        else
+            mv $f $q/todo/$job 2> /dev/null && echo "=== queue: $job re-leased"
+        fi
+    done
+}
+
+#   claim a job; prints the lease file
+claim() {
+    local f job busy
+    for f in `ls $q/todo 2> /dev/null | sort`; do
+        if grep -q '^#barrier' $q/todo/$f 2> /dev/null; then
+            busy=`ls $q/todo $q/lease | grep -v -x -e "$f" -e '' -e '.*:' | wc -l`
+            if [ $busy -gt 0 ]; then
+                continue
+            fi
+        fi
+        if mv $q/todo/$f $q/lease/$f@$me 2> /dev/null; then
+            echo "#lease $me `date +%s`" >> $q/lease/$f@$me
+            echo $q/lease/$f@$me
+            return
+        fi
+    done
+}
+
+case $cmd in
+
+    init)
+        mkdir -p $q/todo $q/lease $q/done $q/fail $q/tmp $q/part $q/log
+        echo "$PWD" > $q/root
+        echo "=== queue $q in $PWD"
+        ;;
+
+    add)
+        if [ "$#" -lt 2 ]; then
+            usage
+        fi
+        job="$1"
+        shift
+        echo "$@" | put $job
+        ;;
+
+    tvla)
+        if [ "$#" -ne 6 ]; then
+            usage
+        fi
+        cyc0="$1"; ncyc="$2"; maxcyc="$3"; prm="$4"; jobs="$5"; n="$6"
+
+        #   each job: its own store and state, built under a name of this
+        #   attempt (a worker that lost its lease may still be running)
+        #   and renamed into place; a rerun replaces both
+        for k in `seq -w $jobs`; do
+            st="$q/part/tvla-$k"
+            put tvla-$k <<EOF
+set -e
+t=$q/part/.tvla-$k.\`hostname -s\`.\$\$
+trap "rm -rf \$t.trs \$t.acc" EXIT
+rm -rf \$t.trs
+./trs create \$t.trs $cyc0 $ncyc
+TRS=\$t.trs ./flow/gen-fix.sh $maxcyc $prm q$k $n
+TRS=\$t.trs ./flow/gen-rnd.sh $maxcyc $prm q$k $n
+./tvla -s \$t.acc \$t.trs
+rm -rf $st.trs
+mv -T \$t.trs $st.trs
+mv \$t.acc $st.acc
+EOF
+        done
+        #   the barrier does not wait for failed jobs: count the states
+        put zz-tvla-merge <<EOF
+#barrier
+n=\`ls $q/part/tvla-*.acc 2> /dev/null | wc -l\`
+if [ \$n -ne $jobs ]; then
+    echo "tvla merge: \$n of $jobs job states"
+    exit 1
+fi
+./tvla -o $q/tvla.txt -m $q/tvla.acc $q/part/tvla-*.acc
+EOF
+        echo "=== queue: $jobs jobs of 2 x $n traces, result $q/tvla.acc"
+        ;;
+
+    work)
+        cd "`cat $q/root`"
+        while true; do
+            reap
+            lease=`claim`
+            if [ -z "$lease" ]; then
+                if [ -z "`ls $q/todo $q/lease | grep -v -e '^$' -e ':$'`" ]; then
+                    break
+                fi
+                sleep $QUEUE_HB
+                continue
+            fi
+            job="`basename $lease`"
+            job="${job%@*}"
+            echo "=== queue: $job on $me"
+
+            #   heartbeat while this worker lives; -c: never recreate
+            ( while kill -0 $$ 2> /dev/null && [ -e $lease ]; do
+                touch -c $lease
+                sleep $QUEUE_HB
+            done ) &
+            hb=$!
+
+            bash -c "`cat $lease`" > $q/log/$job.$me.log 2>&1
+            st=$?
+            kill $hb 2> /dev/null
+            wait $hb 2> /dev/null
+
+            if [ ! -e $lease ]; then
+                echo "=== queue: $job lease lost (re-leased)"
+            elif [ $st -eq 0 ]; then
+                mv $lease $q/done/$job
+                echo "=== queue: $job done"
+            else
+                mv $lease $q/fail/$job
+                echo "=== queue: $job failed ($st), log $q/log/$job.$me.log"
+            fi
+        done
+        rm -f $q/tmp/now.$me
+        echo "=== queue: empty"
+        ;;
+
+    stat)
+        for d in todo lease done fail; do
+            echo "$d `ls $q/$d | wc -l`"
+        done
+        t=`now`
+        for f in $q/lease/*; do
+            if [ -e "$f" ]; then
+                echo "  `basename $f` $((t - `stat -c %Y $f`)) s"
+            fi
+        done
+        rm -f $q/tmp/now.$me
+        ;;
+
+    *)
+        usage
+        ;;
+esac
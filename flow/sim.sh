@@ -0,0 +1,95 @@
+#!/bin/bash
+#   sim.sh
+#   2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+#   One traced run in the current (_tr_*) directory, as in the gen scripts:
+#   mldsa_wrap -vcd through a fifo into readvcd, logs gzipped.
+#   SIM_CACHE=<dir>: result cache keyed by the hash of the two binaries,
+#   the operation, the limit, the readvcd and SIM_OPTS options, the files
+#   named by the readvcd options, and the input files the operation reads.
+#   A hit copies the outputs instead.
+
+if [ "$#" -lt 2 ]; then
+    echo "Usage: sim <maxcyc> <keygen|sign|verify|kgsign> [readvcd options]"
+    exit 1
+fi
+
+maxcyc="$1"
+op="$2"
+shift 2
+vcdprm="$@"
+wrap=../mldsa_wrap
+rvcd=../readvcd
+
+case $op in
+    keygen) inp="seed ent" ;;
+    sign)   inp="hash sk rnd ent" ;;
+    verify) inp="hash pk sig" ;;
+    kgsign) inp="seed hash rnd ent" ;;
+    *)      echo "sim: unknown operation $op"; exit 1 ;;
+esac
+
+#   everything the outputs depend on
+simkey() {
+    sha256sum $wrap $rvcd | cut -d ' ' -f 1
+    echo "op=$op"
+    echo "maxcyc=$maxcyc"
+    echo "vcdprm=$vcdprm"
+    echo "opts=$SIM_OPTS"
+    #   contents of the weight file (-w) and of -clk if it is a file
+    local -a w
+    read -ra w <<< "$vcdprm"            #   no pathname expansion of globs
+    prev=""
+    for x in "${w[@]}"; do
+        if [ "$prev" = "-w" -o "$prev" = "-clk" ] && [ -f "$x" ]; then
+            echo "$prev $x=`sha256sum < $x | cut -d ' ' -f 1`"
+        fi
+        prev="$x"
+    done
+    for x in $inp; do
+        if [ -e ${x}_in.dat ]; then
+            echo "$x=`sha256sum < ${x}_in.dat | cut -d ' ' -f 1`"
+        else
+            echo "$x=-"
+        fi
+    done
+}
+
+outs="run.log.gz trace.log.gz sk_out.dat pk_out.dat sig_out.dat metrics.json
+    sram.log.gz sram.txt"
+
+if [ -n "$SIM_CACHE" ]; then
+    key=`simkey | sha256sum | cut -c 1-64`
+    ent="$SIM_CACHE/${key:0:2}/$key"
+    echo "simkey=${key}" >> param.txt
+    if [ -e $ent/run.log.gz ]; then
+        echo "=== cache hit $key"
+        for x in $outs; do
+            if [ -e $ent/$x ]; then
+                cp $ent/$x .
+            fi
+        done
+        exit 0
+    fi
+fi
+
+mkfifo trace.vcd
+$rvcd trace.vcd $vcdprm > trace.log &
+$wrap -t $maxcyc $SIM_OPTS -vcd trace.vcd $op | tee run.log
+st=${PIPESTATUS[0]}
+wait
+rm -f trace.vcd
+gzip -f *.log
+
+#   only complete runs; entries appear atomically (rename)
+if [ -n "$SIM_CACHE" ] && [ $st -eq 0 ] && \
+    zgrep -q '^\[EXIT\]' run.log.gz; then
+    tmp="$SIM_CACHE/tmp.$$"
+    mkdir -p $tmp $SIM_CACHE/${key:0:2}
+    for x in $outs; do
+        if [ -e $x ]; then
+            cp $x $tmp/
+        fi
+    done
+    mv -T $tmp $ent 2> /dev/null || rm -rf $tmp
+fi
+exit $st
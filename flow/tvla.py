@@ -159,7 +159,7 @@ def read_trace(fn, d, beg):
                 continue
             t = int(line[1:i])
             if line[i:i+6] == '[togd]':
-                y   = int(line[i+6:])
+                y   = int(line[i+6:].split()[0])   # sram columns may follow
                 if t not in d:
                     d[t] = fdist()
                 d[t].addx(y)
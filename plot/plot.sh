@@ -5,21 +5,44 @@
 #	just the signing time range
 cat tvla11k.txt | grep -v read | grep -v tag | sort -n > sign.dat
 
+#	with ../dsamp (make tools) the series are cut down to the plot width
+#	(min/max envelope, same columns); zooms come from the saved pyramid
+DS=../dsamp
+W=2000
+
+if [ -x $DS ]; then
+	$DS -p sign.pyr sign.dat
+	zcat trace.log.gz | $DS -w $W - > trace.dat
+	$DS -w $W -k tvla sign.pyr > sign-tvla.dat
+	$DS -w $W -k tvla -x 2553:13000 sign.pyr > sign-tvla-zoom.dat
+	$DS -w $W -k avg sign.pyr > avg-fixrnd.dat
+	$DS -w $W -k std sign.pyr > std-fixrnd.dat
+	$DS -w $W -k std -x 2553:3100 sign.pyr > std-fixrnd-zoom.dat
+else
+	zcat trace.log.gz | grep togd | colrm 1 1 | sed 's/\[togd\]//g' > trace.dat
+	cat sign.dat | colrm 16 > sign-tvla.dat
+	cp sign-tvla.dat sign-tvla-zoom.dat
+	cat sign.dat | awk '{print $1 "\t" $6 $10}' | tr ',' '\t' > avg-fixrnd.dat
+	cat sign.dat | awk '{print $1 "\t" $7 $11}' | tr ')' '\t' > std-fixrnd.dat
+	cp std-fixrnd.dat std-fixrnd-zoom.dat
+fi
+
 #	raw trace
-zcat trace.log.gz | grep togd | colrm 1 1 | sed 's/\[togd\]//g' > trace.dat
 gnuplot -c gnuplot.trace
 
 #	tvla
-cat sign.dat | colrm 16 > sign-tvla.dat
 gnuplot -c gnuplot.tvla
 gnuplot -c gnuplot.tvla2
 
 #	average avtivities of fix and rnd
-cat sign.dat | awk '{print $1 "\t" $6 $10}' | tr ',' '\t' > avg-fixrnd.dat
 gnuplot -c gnuplot.avg2
 
 #	standard deviation
-cat sign.dat | awk '{print $1 "\t" $7 $11}' | tr ')' '\t' > std-fixrnd.dat 
 gnuplot -c gnuplot.std2
 gnuplot -c gnuplot.std-zoom
 
+#abr-sign-tvla.dat:	trace.txt
+#	cat trace.txt | colrm 16 > abr-sign-tvla.dat
+
+#trace.pdf:	abr-sign-tvla.dat trace.gnuplot
+#	gnuplot -c trace.gnuplot
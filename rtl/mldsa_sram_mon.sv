@@ -0,0 +1,61 @@
+//  mldsa_sram_mon.sv
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+
+//  === SRAM port activity monitor, bound into every 1r1w RAM instance
+
+//  Counts reads, writes and bit flips on the write and read data buses
+//  of a RAM without tracing its array. Each instance registers with the
+//  harness (src/mldsa_wrap.cpp, -sram); the harness only enables those
+//  under mldsa_mem_top, others get id -1 and stay silent.
+
+module mldsa_sram_mon
+    #(
+        parameter   DATA_WIDTH  = 32,
+        parameter   ADDR_WIDTH  = 6
+    )
+    (
+        input logic                     clk_i,
+        input logic                     we_i,
+        input logic [ADDR_WIDTH-1:0]    waddr_i,
+        input logic [DATA_WIDTH-1:0]    wdata_i,
+        input logic                     re_i,
+        input logic [ADDR_WIDTH-1:0]    raddr_i,
+        input logic [DATA_WIDTH-1:0]    rdata_o
+    );
+    int id = -1;
+    logic [DATA_WIDTH-1:0] wdata_p = '0;
+    logic [DATA_WIDTH-1:0] rdata_p = '0;
+
+    //  harness hooks: instance table and per-cycle port activity
+    import "DPI-C" function int mldsa_sram_reg(input string path,
+                                               input int dw,
+                                               input int aw);
+    import "DPI-C" function void mldsa_sram_event(input int id,
+                                                  input int we,
+                                                  input int re,
+                                                  input int hdw,
+                                                  input int hdr);
+
+    initial id = mldsa_sram_reg($sformatf("%m"), DATA_WIDTH, ADDR_WIDTH);
+
+    always_ff @(posedge clk_i) begin
+        if (id >= 0) begin
+            if (we_i || re_i || wdata_i != wdata_p || rdata_o != rdata_p)
+                mldsa_sram_event(id, int'(we_i), int'(re_i),
+                                $countones(wdata_i ^ wdata_p),
+                                $countones(rdata_o ^ rdata_p));
+            wdata_p <=  wdata_i;
+            rdata_p <=  rdata_o;
+        end
+    end
+
+endmodule
+
+//  ports are connected by name in the target RAM
+bind abr_1r1w_ram mldsa_sram_mon
+    #(  .DATA_WIDTH(DATA_WIDTH), .ADDR_WIDTH(ADDR_WIDTH) )
+    sram_mon ( .* );
+
+bind abr_1r1w_be_ram mldsa_sram_mon
+    #(  .DATA_WIDTH(DATA_WIDTH), .ADDR_WIDTH(ADDR_WIDTH) )
+    sram_mon ( .* );
@@ -0,0 +1,405 @@
+//  accum.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Mergeable statistics accumulators and a parallel pass over a store.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "accum.h"
+
+//  === accumulator files
+
+acc_t *acc_new(const char *kind, int64_t cyc0, int64_t ncyc,
+                uint64_t dim, size_t len)
+{
+    acc_t *a;
+
+    a = calloc(1, sizeof(acc_t));
+    if (a == NULL)
+        exit(-1);
+    a->hdr.magic    = ACC_MAGIC;
+    strncpy(a->hdr.kind, kind, sizeof(a->hdr.kind) - 1);
+    a->hdr.cyc0     = cyc0;
+    a->hdr.ncyc     = ncyc;
+    a->hdr.dim      = dim;
+    a->hdr.len      = len;
+    a->v = calloc(len > 0 ? len : 1, sizeof(double));
+    if (a->v == NULL)
+        exit(-1);
+    return a;
+}
+
+acc_t *acc_load(const char *fn)
+{
+    acc_t   *a;
+    FILE    *fp;
+
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return NULL;
+    }
+    a = calloc(1, sizeof(acc_t));
+    if (a == NULL)
+        exit(-1);
+    if (fread(&a->hdr, sizeof(acc_hdr_t), 1, fp) != 1 ||
+        a->hdr.magic != ACC_MAGIC) {
+        fprintf(stderr, "%s: not an accumulator file\n", fn);
+        goto fail;
+    }
+    a->v = malloc((a->hdr.len > 0 ? a->hdr.len : 1) * sizeof(double));
+    if (a->v == NULL)
+        exit(-1);
+    if (fread(a->v, sizeof(double), a->hdr.len, fp) != a->hdr.len) {
+        fprintf(stderr, "%s: truncated\n", fn);
+        goto fail;
+    }
+    fclose(fp);
+    return a;
+
+fail:
+    fclose(fp);
+    acc_free(a);
+    return NULL;
+}
+
+int acc_save(const acc_t *a, const char *fn)
+{
+    char    tmp[FILENAME_MAX];
+    FILE    *fp;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", fn);
+    fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        perror(tmp);
+        return -1;
+    }
+    if (fwrite(&a->hdr, sizeof(acc_hdr_t), 1, fp) != 1 ||
+        fwrite(a->v, sizeof(double), a->hdr.len, fp) != a->hdr.len) {
+        perror(tmp);
+        fclose(fp);
+        return -1;
+    }
+    if (fclose(fp) != 0 || rename(tmp, fn) != 0) {
+        perror(fn);
+        return -1;
+    }
+    return 0;
+}
+
+int acc_merge(acc_t *a, const acc_t *b)
+{
+    size_t i;
+
+    if (strncmp(a->hdr.kind, b->hdr.kind, sizeof(a->hdr.kind)) != 0 ||
+        a->hdr.cyc0 != b->hdr.cyc0 || a->hdr.ncyc != b->hdr.ncyc ||
+        a->hdr.dim != b->hdr.dim || a->hdr.len != b->hdr.len ||
+        a->hdr.fix != b->hdr.fix || a->hdr.fix > a->hdr.len ||
+        memcmp(a->v, b->v, a->hdr.fix * sizeof(double)) != 0)
+        return -1;
+
+    for (i = a->hdr.fix; i < a->hdr.len; i++)
+        a->v[i] += b->v[i];
+    a->hdr.n += b->hdr.n;
+    if (b->hdr.next > a->hdr.next)
+        a->hdr.next = b->hdr.next;
+    return 0;
+}
+
+void acc_free(acc_t *a)
+{
+    if (a == NULL)
+        return;
+    free(a->v);
+    free(a);
+}
+
+acc_t *acc_merge_files(int n, char **fn)
+{
+    acc_t   *a = NULL, *b;
+    int     i;
+
+    for (i = 0; i < n; i++) {
+        b = acc_load(fn[i]);
+        if (b == NULL)
+            goto fail;
+        if (a == NULL) {
+            a = b;
+            continue;
+        }
+        if (acc_merge(a, b) != 0) {
+            fprintf(stderr, "%s: does not match %s\n", fn[i], fn[0]);
+            acc_free(b);
+            goto fail;
+        }
+        acc_free(b);
+    }
+    return a;
+
+fail:
+    acc_free(a);
+    return NULL;
+}
+
+int acc_resume(acc_t **a, const char *fn, const char *kind, uint64_t dim,
+                acc_sel_t *sel, const trs_t *t)
+{
+    *a = NULL;
+    if (access(fn, F_OK) != 0)
+        return 0;
+    *a = acc_load(fn);
+    if (*a == NULL)
+        return -1;
+    if (strncmp((*a)->hdr.kind, kind, sizeof((*a)->hdr.kind)) != 0 ||
+        (dim != 0 && (*a)->hdr.dim != dim)) {
+        fprintf(stderr, "%s: not a matching %s state\n", fn, kind);
+        acc_free(*a);
+        *a = NULL;
+        return -1;
+    }
+    sel->cyc0 = (*a)->hdr.cyc0;
+    sel->ncyc = (*a)->hdr.ncyc;
+    if (sel->i0 < (*a)->hdr.next)
+        sel->i0 = (*a)->hdr.next;
+    acc_sel_clip(sel, t);
+    return 0;
+}
+
+//  === trace selection
+
+void acc_sel_init(acc_sel_t *sel, const trs_t *t)
+{
+    sel->cls    = -1;
+    sel->all    = false;
+    sel->i0     = 0;
+    sel->i1     = t != NULL ? t->hdr.n : UINT64_MAX;
+    sel->cyc0   = t != NULL ? t->hdr.cyc0 : INT64_MIN / 4;
+    sel->ncyc   = t != NULL ? t->hdr.ncyc : INT64_MAX / 2;
+    sel->keep   = NULL;
+    sel->keep_arg = NULL;
+}
+
+//  "a:b", either side may be empty
+static void range_arg(const char *s, int64_t *a, int64_t *b)
+{
+    const char *p = strchr(s, ':');
+
+    if (s[0] != ':')
+        *a = strtoll(s, NULL, 0);
+    if (p != NULL && p[1] != 0)
+        *b = strtoll(p + 1, NULL, 0);
+}
+
+int acc_sel_arg(acc_sel_t *sel, int argc, char **argv, int i)
+{
+    int64_t a, b;
+
+    if (strcmp(argv[i], "-a") == 0) {
+        sel->all = true;
+        return 1;
+    }
+    if (i + 1 >= argc)
+        return 0;
+
+    if (strcmp(argv[i], "-c") == 0) {
+        if (strcmp(argv[i + 1], "fix") == 0)
+            sel->cls = TRS_FIX;
+        else if (strcmp(argv[i + 1], "rnd") == 0)
+            sel->cls = TRS_RND;
+        else if (strcmp(argv[i + 1], "kgr") == 0)
+            sel->cls = TRS_KGR;
+        else
+            sel->cls = TRS_UNK;
+        return 2;
+    }
+    if (strcmp(argv[i], "-r") == 0) {
+        a = sel->i0;
+        b = sel->i1;
+        range_arg(argv[i + 1], &a, &b);
+        sel->i0 = a;
+        sel->i1 = b;
+        return 2;
+    }
+    if (strcmp(argv[i], "-w") == 0) {
+        a = sel->cyc0;
+        b = sel->cyc0 + sel->ncyc;
+        range_arg(argv[i + 1], &a, &b);
+        sel->cyc0 = a;
+        sel->ncyc = b - a;
+        return 2;
+    }
+    return 0;
+}
+
+void acc_sel_clip(acc_sel_t *sel, const trs_t *t)
+{
+    int64_t c1 = sel->cyc0 + sel->ncyc;
+
+    if (sel->i1 > t->hdr.n)
+        sel->i1 = t->hdr.n;
+    if (sel->i0 > sel->i1)
+        sel->i0 = sel->i1;
+    if (sel->cyc0 < t->hdr.cyc0)
+        sel->cyc0 = t->hdr.cyc0;
+    if (c1 > t->hdr.cyc0 + t->hdr.ncyc)
+        c1 = t->hdr.cyc0 + t->hdr.ncyc;
+    sel->ncyc = c1 > sel->cyc0 ? c1 - sel->cyc0 : 0;
+}
+
+bool acc_sel_trace(const trs_t *t, const acc_sel_t *sel, size_t i)
+{
+    const trs_meta_t *m;
+
+    if (i < sel->i0 || i >= sel->i1 || i >= t->hdr.n)
+        return false;
+    m = &t->meta[i];
+    if (sel->cls >= 0 && m->cls != sel->cls)
+        return false;
+    if (!sel->all && m->status == TRS_TIMEOUT)
+        return false;
+    if (sel->keep != NULL && !sel->keep(sel->keep_arg, i))
+        return false;
+    return true;
+}
+
+//  === parallel pass
+
+typedef struct {
+    const trs_t     *t;
+    const acc_sel_t *sel;
+    acc_fn_t        fn;
+    void            *ctx;
+    size_t          chk0, chk1;     //  chunks overlapping the window
+    size_t          next;           //  next chunk to claim
+    int             nthr;
+} scan_t;
+
+typedef struct {
+    scan_t      *s;
+    int         thr;
+    pthread_t   tid;
+} scan_thr_t;
+
+static void *scan_thread(void *arg)
+{
+    scan_thr_t  *th = (scan_thr_t *) arg;
+    scan_t      *s = th->s;
+    const trs_t *t = s->t;
+    const acc_sel_t *sel = s->sel;
+    uint32_t    *buf, idx[TRS_TILE];
+    double      *x;
+    acc_blk_t   b;
+    size_t      chk, tile, tile0, tile1, rows, cols, r0, r1, i, j, m;
+    int64_t     c;
+
+    buf = malloc(TRS_ROWS * TRS_TILE * sizeof(uint32_t));
+    x = malloc(TRS_TILE * ACC_LD * sizeof(double));
+    if (buf == NULL || x == NULL)
+        exit(-1);
+
+    tile0 = sel->i0 / TRS_TILE;
+    tile1 = (sel->i1 + TRS_TILE - 1) / TRS_TILE;
+
+    for (;;) {
+        chk = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED);
+        if (chk >= s->chk1)
+            break;
+
+        //  rows of this chunk inside the window
+        c = t->hdr.cyc0 + chk * TRS_ROWS;
+        r0 = sel->cyc0 > c ? sel->cyc0 - c : 0;
+        r1 = sel->cyc0 + sel->ncyc - c;
+        if (r1 > TRS_ROWS)
+            r1 = TRS_ROWS;
+
+        for (tile = tile0; tile < tile1; tile++) {
+
+            //  selected columns
+            m = 0;
+            for (j = 0; j < TRS_TILE; j++) {
+                if (acc_sel_trace(t, sel, tile * TRS_TILE + j))
+                    idx[m++] = tile * TRS_TILE + j;
+            }
+            if (m == 0)
+                continue;
+
+            cols = trs_chunk(t, tile, chk, buf, &rows);
+            if (r1 > rows)
+                r1 = rows;
+            if (cols == 0 || r0 >= r1)
+                continue;
+
+            //  transpose to trace-major doubles
+            for (j = 0; j < m; j++) {
+                const uint32_t *p = buf + (idx[j] - tile * TRS_TILE);
+                double *q = x + j * ACC_LD;
+                for (i = r0; i < r1; i++)
+                    q[i - r0] = (double) p[i * TRS_TILE];
+            }
+
+            b.thr   = th->thr;
+            b.off   = c + r0 - sel->cyc0;
+            b.rows  = r1 - r0;
+            b.m     = m;
+            b.x     = x;
+            b.idx   = idx;
+            s->fn(s->ctx, &b);
+        }
+    }
+
+    free(x);
+    free(buf);
+    return NULL;
+}
+
+int acc_scan(const trs_t *t, const acc_sel_t *sel, int nthr,
+                acc_fn_t fn, void *ctx)
+{
+    scan_t      s;
+    scan_thr_t  *th;
+    int         i;
+
+    if (sel->ncyc <= 0 || sel->i0 >= sel->i1)
+        return 0;
+
+    s.t     = t;
+    s.sel   = sel;
+    s.fn    = fn;
+    s.ctx   = ctx;
+    s.chk0  = (sel->cyc0 - t->hdr.cyc0) / TRS_ROWS;
+    s.chk1  = (sel->cyc0 + sel->ncyc - t->hdr.cyc0 + TRS_ROWS - 1) / TRS_ROWS;
+    s.next  = s.chk0;
+    if (nthr < 1)
+        nthr = 1;
+    if ((size_t) nthr > s.chk1 - s.chk0)
+        nthr = s.chk1 - s.chk0;
+    s.nthr  = nthr;
+
+    th = calloc(nthr, sizeof(scan_thr_t));
+    if (th == NULL)
+        exit(-1);
+    for (i = 0; i < nthr; i++) {
+        th[i].s = &s;
+        th[i].thr = i;
+        if (pthread_create(&th[i].tid, NULL, scan_thread, &th[i]) != 0) {
+            perror("pthread_create");
+            exit(-1);
+        }
+    }
+    for (i = 0; i < nthr; i++)
+        pthread_join(th[i].tid, NULL);
+    free(th);
+
+    return 0;
+}
+
+int acc_nthr(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n > 0 ? (int) n : 1;
+}
@@ -0,0 +1,114 @@
+//  accum.h
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Mergeable statistics accumulators and a parallel pass over a store.
+
+//  Analysis tools (cpa, snr, ..) keep only power sums (n, sum x, sum x^2,
+//  sum x*y, ..) so that partial results from threads, trace ranges, or
+//  hosts combine by plain addition. acc_scan() hands each thread whole
+//  chunks (TRS_ROWS cycles) of the store; a chunk's tiles are visited in
+//  order by one thread, so per-cycle sums are disjoint between threads
+//  and results do not depend on the thread count.
+
+#ifndef _ACCUM_H_
+#define _ACCUM_H_
+
+#include "trstore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACC_MAGIC   0x3143434152424100llu   //  "\0ABRACC1"
+
+typedef struct {
+    uint64_t    magic;
+    char        kind[8];    //  tool name, e.g. "cpa"
+    int64_t     cyc0;       //  first cycle of the window
+    int64_t     ncyc;       //  window length
+    uint64_t    dim;        //  tool-specific: hypotheses, classes, ..
+    uint64_t    n;          //  traces accumulated
+    uint64_t    next;       //  store position to continue from
+    uint64_t    len;        //  number of sums (doubles) that follow
+    uint64_t    fix;        //  leading values that must match, not add
+    uint64_t    pad[7];
+} acc_hdr_t;
+
+typedef struct {
+    acc_hdr_t   hdr;
+    double      *v;
+} acc_t;
+
+//  new zeroed accumulator of "len" sums
+acc_t *acc_new(const char *kind, int64_t cyc0, int64_t ncyc,
+                uint64_t dim, size_t len);
+
+//  load / save (atomically via rename)
+acc_t *acc_load(const char *fn);
+int acc_save(const acc_t *a, const char *fn);
+
+//  a += b; the shapes and the first hdr.fix values must match
+int acc_merge(acc_t *a, const acc_t *b);
+
+void acc_free(acc_t *a);
+
+//  load and merge n files (shards)
+acc_t *acc_merge_files(int n, char **fn);
+
+//  === trace selection
+
+typedef struct {
+    int         cls;        //  TRS_FIX, TRS_RND, TRS_KGR or -1 for any
+    bool        all;        //  include runs that timed out
+    uint64_t    i0, i1;     //  trace range [i0, i1)
+    int64_t     cyc0, ncyc; //  cycle window
+    bool        (*keep)(void *arg, size_t i);   //  tool filter (optional)
+    void        *keep_arg;
+} acc_sel_t;
+
+//  all complete traces, all cycles (unbounded if t is NULL)
+void acc_sel_init(acc_sel_t *sel, const trs_t *t);
+
+//  parse a common option at argv[i] (-c cls, -r i0:i1, -w c0:c1, -a);
+//  returns the number of arguments consumed, 0 if not a selection option
+int acc_sel_arg(acc_sel_t *sel, int argc, char **argv, int i);
+
+//  clip the selection to the store
+void acc_sel_clip(acc_sel_t *sel, const trs_t *t);
+
+//  is trace i selected?
+bool acc_sel_trace(const trs_t *t, const acc_sel_t *sel, size_t i);
+
+//  load a saved state of "kind" to continue from, or NULL if "fn" does
+//  not exist yet (dim 0 matches any); restricts sel to the traces it has
+//  not seen
+int acc_resume(acc_t **a, const char *fn, const char *kind, uint64_t dim,
+                acc_sel_t *sel, const trs_t *t);
+
+//  === parallel pass
+
+#define ACC_LD      TRS_ROWS            //  row stride of acc_blk_t.x
+
+//  selected traces of one chunk of one tile, trace-major
+typedef struct {
+    int             thr;    //  thread index
+    int64_t         off;    //  window offset of x[.][0]
+    size_t          rows;   //  cycles per trace
+    size_t          m;      //  traces (selected columns of the tile)
+    const double    *x;     //  x[j * ACC_LD + r]: trace j, cycle off + r
+    const uint32_t  *idx;   //  store index of trace j
+} acc_blk_t;
+
+typedef void (*acc_fn_t)(void *ctx, const acc_blk_t *b);
+
+//  call fn on every (chunk, tile) of the selection with nthr threads
+int acc_scan(const trs_t *t, const acc_sel_t *sel, int nthr,
+                acc_fn_t fn, void *ctx);
+
+//  default thread count (online processors)
+int acc_nthr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
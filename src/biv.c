@@ -0,0 +1,614 @@
+//  biv.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Bivariate (second-order) TVLA over all cycle pairs of a window.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <zlib.h>
+
+#include "accum.h"
+
+//  For a trace x of class k, the centered product of cycles i and j is
+//  y = (x_i - m_i)(x_j - m_j), where m is the mean of class k. Welch t
+//  between fix and rnd is computed on y for every pair i <= j of a window
+//  of W cycles. Over a batch of traces, with Z the centered traces and Q
+//  their squares, the sums of y and y^2 are the triangles of Z^T Z and
+//  Q^T Q. They are updated one store tile (256 traces) at a time, in
+//  square blocks of the triangle that threads claim, so each sum has one
+//  writer. The inner loops run along cycles and vectorize.
+//
+//  The means come from a first pass over the same traces, or from a tvla
+//  state (-M) merged over all shards. They are kept in the state, and
+//  only states with the same means merge.
+
+#define BIV_TB      64              //  block side in the pair triangle
+#define BIV_WMAX    16384           //  window limit (W^2 / 2 pairs)
+
+typedef struct {
+    acc_t       *a;
+    int64_t     w;                  //  window
+    size_t      np;                 //  pairs, w * (w + 1) / 2
+} biv_t;
+
+//  accumulator layout: m[2][w] (fixed), n[2], s1[2][np], s2[2][np]
+#define BIV_M(s)    ((s)->a->v)
+#define BIV_N(s)    ((s)->a->v + 2 * (s)->w)
+#define BIV_S1(s)   ((s)->a->v + 2 * (s)->w + 2)
+#define BIV_S2(s)   ((s)->a->v + 2 * (s)->w + 2 + 2 * (s)->np)
+
+//  packed upper triangle, row-major: pair (i, j), i <= j
+static inline size_t biv_ix(int64_t w, int64_t i, int64_t j)
+{
+    return i * w - i * (i - 1) / 2 + (j - i);
+}
+
+const char usage[] =
+    "Usage: biv [options] <store>\n"
+    "       biv [options] -m <out.acc> <in.acc> ..\n\n"
+    "Bivariate second-order Welch t-test between the fix and rnd traces\n"
+    "of campaign <store>, on the centered products of all cycle pairs of\n"
+    "a window.\n\n"
+    "\t-w\t<c:d>\tcycle window\n"
+    "\t-p\t<log>\tphase tags ([prim] lines) from a run log, for -P\n"
+    "\t-P\t<name[:k]>\twindow: k:th segment of a phase (default 1)\n"
+    "\t-M\t<fn>\tclass means from a tvla state (same for all shards)\n"
+    "\t-T\t<t>\tthreshold (default 4.5)\n"
+    "\t-t\t<n>\tthreads (default: all processors)\n"
+    "\t-r\t<a:b>\ttrace range\n"
+    "\t-a\t\tinclude runs that timed out\n"
+    "\t-s\t<fn>\tsave the accumulator state\n"
+    "\t-u\t<fn>\tupdate: continue from a saved state, save it back\n"
+    "\t-m\t\tmerge saved states of shards instead of reading a store\n"
+    "\t-k\t<n>\treport the n highest pairs (default 10)\n"
+    "\t-o\t<fn>\tt-values as a W x W matrix (gnuplot: matrix with image)\n";
+
+static bool biv_keep(void *arg, size_t i)
+{
+    const trs_t *t = (const trs_t *) arg;
+
+    return t->meta[i].cls == TRS_FIX || t->meta[i].cls == TRS_RND;
+}
+
+//  window from the k:th segment of a phase in a (gzipped) run log; the
+//  segment ends at the next tag of another phase
+
+static int biv_phase(const char *fn, const char *arg,
+                        int64_t *c0, int64_t *c1)
+{
+    gzFile  gz;
+    char    buf[256], nm[40], want[40], prev[40] = "";
+    char    *p;
+    int64_t cyc;
+    int     k = 1, seg = 0;
+
+    snprintf(want, sizeof(want), "%s", arg);
+    if ((p = strchr(want, ':')) != NULL) {
+        *p = 0;
+        k = atoi(p + 1);
+    }
+    gz = gzopen(fn, "r");
+    if (gz == NULL) {
+        perror(fn);
+        return -1;
+    }
+    *c0 = *c1 = -1;
+    while (gzgets(gz, buf, sizeof(buf)) != NULL) {
+        //  a tag may follow the progress counter on the same line
+        if ((p = strchr(buf, '#')) == NULL)
+            continue;
+        cyc = strtoll(p + 1, &p, 10);
+        while (*p == ' ')
+            p++;
+        if (strncmp(p, "[prim]", 6) != 0 || (p = strchr(p, ':')) == NULL ||
+            sscanf(p + 1, "%39s", nm) != 1 || strcmp(nm, prev) == 0)
+            continue;
+        if (seg == k) {
+            *c1 = cyc;
+            break;
+        }
+        strcpy(prev, nm);
+        if (strcmp(nm, want) == 0 && ++seg == k)
+            *c0 = cyc;
+    }
+    gzclose(gz);
+    if (*c0 < 0 || *c1 < 0) {
+        fprintf(stderr, "%s: no complete segment %d of %s\n", fn, k, want);
+        return -1;
+    }
+    return 0;
+}
+
+//  === first pass: class means
+
+typedef struct {
+    const trs_t *t;
+    int64_t     w;
+    double      *s;                 //  s[2][w]
+} biv_mean_t;
+
+static void biv_mean_blk(void *ctx, const acc_blk_t *b)
+{
+    const biv_mean_t *mc = (const biv_mean_t *) ctx;
+    const double *x;
+    double  *s;
+    size_t  j, r;
+
+    for (j = 0; j < b->m; j++) {
+        x = b->x + j * ACC_LD;
+        s = mc->s + mc->t->meta[b->idx[j]].cls * mc->w + b->off;
+        for (r = 0; r < b->rows; r++)
+            s[r] += x[r];
+    }
+}
+
+static void biv_means(biv_t *s, const trs_t *t, const acc_sel_t *sel,
+                        int nthr)
+{
+    biv_mean_t  mc;
+    double      n[2] = { 0.0, 0.0 };
+    size_t      i;
+    int64_t     c;
+    int         k;
+
+    for (i = sel->i0; i < sel->i1; i++) {
+        if (acc_sel_trace(t, sel, i))
+            n[t->meta[i].cls] += 1.0;
+    }
+    mc.t = t;
+    mc.w = s->w;
+    mc.s = BIV_M(s);
+    memset(mc.s, 0, 2 * s->w * sizeof(double));
+    acc_scan(t, sel, nthr, biv_mean_blk, &mc);
+    for (k = 0; k < 2; k++) {
+        for (c = 0; c < s->w; c++)
+            mc.s[k * s->w + c] = n[k] > 0.0 ? mc.s[k * s->w + c] / n[k] : 0.0;
+    }
+}
+
+//  means from a tvla state: n[2], s1[2][nc], s2[2][nc]
+
+static int biv_means_tvla(biv_t *s, const char *fn)
+{
+    acc_t   *a;
+    int64_t c, off, nc;
+    int     k;
+    double  n;
+
+    a = acc_load(fn);
+    if (a == NULL)
+        return -1;
+    off = s->a->hdr.cyc0 - a->hdr.cyc0;
+    nc = a->hdr.ncyc;
+    if (strcmp(a->hdr.kind, "tvla") != 0 || off < 0 || off + s->w > nc) {
+        fprintf(stderr, "%s: not a tvla state covering the window\n", fn);
+        acc_free(a);
+        return -1;
+    }
+    for (k = 0; k < 2; k++) {
+        n = a->v[k];
+        for (c = 0; c < s->w; c++)
+            BIV_M(s)[k * s->w + c] = n > 0.0 ?
+                a->v[2 + k * nc + off + c] / n : 0.0;
+    }
+    acc_free(a);
+    return 0;
+}
+
+//  === second pass: sums of centered products
+
+//  one trace into rows i..i+3 (or just i) of a block; pointers are
+//  offset so that a[j] is pair (i, j)
+
+static void biv_row4(double *restrict a0, double *restrict a1,
+                        double *restrict a2, double *restrict a3,
+                        double *restrict b0, double *restrict b1,
+                        double *restrict b2, double *restrict b3,
+                        const double *restrict z, const double *restrict q,
+                        int64_t i, int64_t j0, int64_t j1)
+{
+    const double z0 = z[i], z1 = z[i + 1], z2 = z[i + 2], z3 = z[i + 3];
+    const double q0 = q[i], q1 = q[i + 1], q2 = q[i + 2], q3 = q[i + 3];
+    int64_t j;
+
+    for (j = j0; j < j1; j++) {
+        a0[j] += z0 * z[j];
+        a1[j] += z1 * z[j];
+        a2[j] += z2 * z[j];
+        a3[j] += z3 * z[j];
+        b0[j] += q0 * q[j];
+        b1[j] += q1 * q[j];
+        b2[j] += q2 * q[j];
+        b3[j] += q3 * q[j];
+    }
+}
+
+static void biv_row1(double *restrict a0, double *restrict b0,
+                        const double *restrict z, const double *restrict q,
+                        int64_t i, int64_t j0, int64_t j1)
+{
+    const double z0 = z[i], q0 = q[i];
+    int64_t j;
+
+    for (j = j0; j < j1; j++) {
+        a0[j] += z0 * z[j];
+        b0[j] += q0 * q[j];
+    }
+}
+
+//  block rows [i0, i1) x cols [j0, j1) of class k over m traces
+
+static void biv_block(const biv_t *s, int k, const double *z,
+                        const double *q, size_t m,
+                        int64_t i0, int64_t i1, int64_t j0, int64_t j1)
+{
+    double  *s1 = BIV_S1(s) + k * s->np, *s2 = BIV_S2(s) + k * s->np;
+    double  *a[4], *b[4];
+    int64_t i, jb, w = s->w;
+    size_t  t;
+    int     r, l;
+
+    for (i = i0; i < i1; i += l) {
+        jb = j0 > i ? j0 : i;
+        l = (i + 4 <= i1 && i + 3 <= jb) ? 4 : 1;
+        for (r = 0; r < l; r++) {
+            a[r] = s1 + biv_ix(w, i + r, jb) - jb;
+            b[r] = s2 + biv_ix(w, i + r, jb) - jb;
+        }
+        for (t = 0; t < m; t++) {
+            if (l == 4)
+                biv_row4(a[0], a[1], a[2], a[3], b[0], b[1], b[2], b[3],
+                        z + t * w, q + t * w, i, jb, j1);
+            else
+                biv_row1(a[0], b[0], z + t * w, q + t * w, i, jb, j1);
+        }
+    }
+}
+
+typedef struct {
+    const biv_t *s;
+    const double *z[2], *q[2];
+    size_t      m[2];
+    int64_t     nb;                 //  blocks per side
+    size_t      nblk;               //  blocks in the triangle
+    size_t      next;
+} biv_job_t;
+
+static void *biv_thread(void *arg)
+{
+    biv_job_t *jb = (biv_job_t *) arg;
+    const biv_t *s = jb->s;
+    size_t  x;
+    int64_t bi, bj, i1, j1;
+    int     k;
+
+    for (;;) {
+        x = __atomic_fetch_add(&jb->next, 1, __ATOMIC_RELAXED);
+        if (x >= jb->nblk)
+            break;
+
+        //  x-th block of the triangle, row by row
+        for (bi = 0; (size_t) (jb->nb - bi) <= x; bi++)
+            x -= jb->nb - bi;
+        bj = bi + x;
+
+        i1 = (bi + 1) * BIV_TB < s->w ? (bi + 1) * BIV_TB : s->w;
+        j1 = (bj + 1) * BIV_TB < s->w ? (bj + 1) * BIV_TB : s->w;
+        for (k = 0; k < 2; k++) {
+            if (jb->m[k] > 0)
+                biv_block(s, k, jb->z[k], jb->q[k], jb->m[k],
+                            bi * BIV_TB, i1, bj * BIV_TB, j1);
+        }
+    }
+    return NULL;
+}
+
+//  add traces [sel->i0, sel->i1) to the sums
+
+static void biv_add(biv_t *s, const trs_t *t, const acc_sel_t *sel,
+                    int nthr)
+{
+    biv_job_t   jb;
+    pthread_t   *tid;
+    uint32_t    *buf;
+    double      *z[2], *q[2];
+    size_t      col[2][TRS_TILE], m[2], tile, chk, rows, i, j;
+    int64_t     w = s->w, c, cw, r0, r1, r;
+    int         k, nt;
+
+    buf = malloc(TRS_ROWS * TRS_TILE * sizeof(uint32_t));
+    tid = malloc((nthr > 0 ? nthr : 1) * sizeof(pthread_t));
+    for (k = 0; k < 2; k++) {
+        z[k] = malloc(TRS_TILE * w * sizeof(double));
+        q[k] = malloc(TRS_TILE * w * sizeof(double));
+        if (z[k] == NULL || q[k] == NULL)
+            exit(-1);
+    }
+    if (buf == NULL || tid == NULL)
+        exit(-1);
+
+    memset(&jb, 0, sizeof(jb));
+    jb.s    = s;
+    jb.nb   = (w + BIV_TB - 1) / BIV_TB;
+    jb.nblk = jb.nb * (jb.nb + 1) / 2;
+    nt = nthr < 1 ? 1 : (size_t) nthr > jb.nblk ? (int) jb.nblk : nthr;
+
+    for (tile = sel->i0 / TRS_TILE;
+        tile < (sel->i1 + TRS_TILE - 1) / TRS_TILE; tile++) {
+
+        m[0] = m[1] = 0;
+        for (j = 0; j < TRS_TILE; j++) {
+            i = tile * TRS_TILE + j;
+            if (!acc_sel_trace(t, sel, i))
+                continue;
+            k = t->meta[i].cls;
+            col[k][m[k]++] = j;
+            BIV_N(s)[k] += 1.0;
+            s->a->hdr.n++;
+        }
+        if (m[0] + m[1] == 0)
+            continue;
+
+        //  centered traces of the window, trace-major
+        for (chk = (sel->cyc0 - t->hdr.cyc0) / TRS_ROWS;
+            (int64_t) (chk * TRS_ROWS) < sel->cyc0 + w - t->hdr.cyc0; chk++) {
+            trs_chunk(t, tile, chk, buf, &rows);
+            c = t->hdr.cyc0 + chk * TRS_ROWS;
+            r0 = sel->cyc0 > c ? sel->cyc0 - c : 0;
+            r1 = sel->cyc0 + w - c < (int64_t) rows ?
+                    sel->cyc0 + w - c : (int64_t) rows;
+            for (k = 0; k < 2; k++) {
+                const double *mu = BIV_M(s) + k * w;
+                for (j = 0; j < m[k]; j++) {
+                    for (r = r0; r < r1; r++) {
+                        cw = c + r - sel->cyc0;
+                        z[k][j * w + cw] = buf[r * TRS_TILE + col[k][j]] - mu[cw];
+                    }
+                }
+            }
+        }
+        for (k = 0; k < 2; k++) {
+            for (i = 0; i < m[k] * w; i++)
+                q[k][i] = z[k][i] * z[k][i];
+            jb.z[k] = z[k];
+            jb.q[k] = q[k];
+            jb.m[k] = m[k];
+        }
+
+        jb.next = 0;
+        for (k = 0; k < nt; k++) {
+            if (pthread_create(&tid[k], NULL, biv_thread, &jb) != 0) {
+                perror("pthread_create");
+                exit(-1);
+            }
+        }
+        for (k = 0; k < nt; k++)
+            pthread_join(tid[k], NULL);
+    }
+    s->a->hdr.next = sel->i1;
+
+    for (k = 0; k < 2; k++) {
+        free(z[k]);
+        free(q[k]);
+    }
+    free(tid);
+    free(buf);
+}
+
+//  === report
+
+//  welch t of pair index x; 0 if undefined
+
+static double biv_at(const biv_t *s, size_t x)
+{
+    double  n0 = BIV_N(s)[0], n1 = BIV_N(s)[1];
+    double  m0, m1, v0, v1, c;
+
+    if (n0 <= 0.0 || n1 <= 0.0)
+        return 0.0;
+    m0 = BIV_S1(s)[x] / n0;
+    m1 = BIV_S1(s)[s->np + x] / n1;
+    v0 = BIV_S2(s)[x] / n0 - m0 * m0;
+    v1 = BIV_S2(s)[s->np + x] / n1 - m1 * m1;
+    c = v0 / n0 + v1 / n1;
+    return c > 0.0 ? (m0 - m1) / sqrt(c) : 0.0;
+}
+
+typedef struct {
+    int64_t i, j;
+    double  t;
+} biv_top_t;
+
+static int top_cmp(const void *a, const void *b)
+{
+    double x = fabs(((const biv_top_t *) a)->t);
+    double y = fabs(((const biv_top_t *) b)->t);
+
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static void biv_report(const biv_t *s, double th, size_t k, const char *fn)
+{
+    int64_t     w = s->w, c0 = s->a->hdr.cyc0, i, j;
+    biv_top_t   *top;
+    float       *tv;
+    size_t      nab = 0, x, l;
+    double      y;
+    FILE        *fp;
+
+    tv = malloc(s->np * sizeof(float));
+    top = calloc(k > 0 ? k : 1, sizeof(biv_top_t));
+    if (tv == NULL || top == NULL)
+        exit(-1);
+
+    //  keep the k largest by insertion
+    l = 0;
+    for (i = 0; i < w; i++) {
+        for (j = i; j < w; j++) {
+            x = biv_ix(w, i, j);
+            y = biv_at(s, x);
+            tv[x] = y;
+            if (fabs(y) > th)
+                nab++;
+            if (k == 0 || (l == k && fabs(y) <= fabs(top[k - 1].t)))
+                continue;
+            x = l < k ? l++ : k - 1;
+            top[x].i = i;
+            top[x].j = j;
+            top[x].t = y;
+            qsort(top, l, sizeof(biv_top_t), top_cmp);
+        }
+    }
+
+    printf("[biv] %.0f fix + %.0f rnd, cycles %ld .. %ld, %zu pairs, "
+            "%zu above %.1f\n", BIV_N(s)[0], BIV_N(s)[1],
+            c0, c0 + w - 1, s->np, nab, th);
+    for (x = 0; x < l; x++)
+        printf("[pair] %8ld %8ld  %9.3f\n",
+                c0 + top[x].i, c0 + top[x].j, top[x].t);
+
+    if (fn != NULL) {
+        fp = fopen(fn, "w");
+        if (fp == NULL) {
+            perror(fn);
+        } else {
+            fprintf(fp, "# biv: cycles %ld .. %ld (row, column), "
+                    "%.0f fix + %.0f rnd\n", c0, c0 + w - 1,
+                    BIV_N(s)[0], BIV_N(s)[1]);
+            for (i = 0; i < w; i++) {
+                for (j = 0; j < w; j++)
+                    fprintf(fp, j > 0 ? " %.3f" : "%.3f",
+                            tv[i <= j ? biv_ix(w, i, j) : biv_ix(w, j, i)]);
+                fputc('\n', fp);
+            }
+            fclose(fp);
+        }
+    }
+    free(top);
+    free(tv);
+}
+
+int main(int argc, char **argv)
+{
+    biv_t       s;
+    trs_t       *t;
+    acc_sel_t   sel;
+    const char  *save_fn = NULL, *upd_fn = NULL, *out_fn = NULL;
+    const char  *ph_fn = NULL, *ph_arg = NULL, *mean_fn = NULL;
+    const char  *arg = NULL;
+    int         nthr = acc_nthr(), i, j;
+    int64_t     c0, c1;
+    size_t      k = 10;
+    double      th = 4.5;
+    bool        merge = false;
+
+    memset(&s, 0, sizeof(s));
+    acc_sel_init(&sel, NULL);
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            fputs(usage, stderr);
+            return 1;
+        } else if ((j = acc_sel_arg(&sel, argc, argv, i)) > 0) {
+            i += j - 1;
+        } else if (strcmp(argv[i], "-m") == 0) {
+            merge = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            ph_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-P") == 0) {
+            ph_arg = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-M") == 0) {
+            mean_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-T") == 0) {
+            th = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            nthr = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            save_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-u") == 0) {
+            upd_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-k") == 0) {
+            k = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (argv[i][0] != '-' && arg == NULL) {
+            arg = argv[i];
+        } else if (argv[i][0] != '-' && merge) {
+            break;
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (arg == NULL || (merge && i >= argc) || (ph_arg != NULL) != (ph_fn != NULL)) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (merge) {
+        s.a = acc_merge_files(argc - i, argv + i);
+        if (s.a == NULL)
+            return 1;
+        if (strcmp(s.a->hdr.kind, "biv") != 0) {
+            fprintf(stderr, "%s: not a biv state\n", argv[i]);
+            return 1;
+        }
+        s.w = s.a->hdr.ncyc;
+        s.np = s.w * (s.w + 1) / 2;
+        acc_save(s.a, arg);
+        biv_report(&s, th, k, out_fn);
+        acc_free(s.a);
+        return 0;
+    }
+
+    if (ph_arg != NULL) {
+        if (biv_phase(ph_fn, ph_arg, &c0, &c1) != 0)
+            return 1;
+        sel.cyc0 = c0;
+        sel.ncyc = c1 - c0;
+    }
+
+    t = trs_open(arg, false);
+    if (t == NULL)
+        return 1;
+    acc_sel_clip(&sel, t);
+    if (upd_fn != NULL && acc_resume(&s.a, upd_fn, "biv", 2, &sel, t) != 0)
+        return 1;
+    sel.keep = biv_keep;
+    sel.keep_arg = t;
+
+    if (s.a == NULL) {
+        if (sel.ncyc <= 0 || sel.ncyc > BIV_WMAX) {
+            fprintf(stderr, "%s: window of %ld cycles (1 .. %d)\n",
+                    arg, sel.ncyc, BIV_WMAX);
+            return 1;
+        }
+        s.w = sel.ncyc;
+        s.np = s.w * (s.w + 1) / 2;
+        s.a = acc_new("biv", sel.cyc0, s.w, 2, 2 * s.w + 2 + 4 * s.np);
+        s.a->hdr.fix = 2 * s.w;
+        if (mean_fn != NULL) {
+            if (biv_means_tvla(&s, mean_fn) != 0)
+                return 1;
+        } else {
+            biv_means(&s, t, &sel, nthr);
+        }
+    } else {
+        s.w = s.a->hdr.ncyc;
+        s.np = s.w * (s.w + 1) / 2;
+    }
+
+    biv_add(&s, t, &sel, nthr);
+
+    if (upd_fn != NULL)
+        acc_save(s.a, upd_fn);
+    if (save_fn != NULL)
+        acc_save(s.a, save_fn);
+    biv_report(&s, th, k, out_fn);
+
+    acc_free(s.a);
+    trs_close(t);
+    return 0;
+}
@@ -0,0 +1,379 @@
+//  cpa.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Correlation power analysis: many hypotheses, one pass over a store.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "accum.h"
+
+//  hypothesis matrix (written by flow/cpa-hyp.py):
+//      cpa_hyp_t header, char name[nh][CPA_NAME], float h[n][nh]
+//  row i belongs to trace i of the store; NaN in column 0 skips the trace
+
+#define CPA_MAGIC   0x3150594852424100llu   //  "\0ABRHYP1"
+#define CPA_NAME    32
+
+typedef struct {
+    uint64_t    magic;
+    uint64_t    n;          //  rows (traces)
+    uint64_t    nh;         //  columns (hypotheses)
+    uint64_t    pad[5];
+} cpa_hyp_t;
+
+//  cache blocking of the hypothesis x cycle kernel: a CPA_HB x CPA_RB
+//  block of cross sums stays in L1 while the traces of a tile stream by
+
+#define CPA_HB      32
+#define CPA_RB      64
+
+typedef struct {
+    const cpa_hyp_t *hyp;
+    size_t          hyp_sz;
+    const char      *name;
+    const float     *h;
+    acc_t           *a;
+    size_t          nh;
+    int64_t         nc;
+} cpa_t;
+
+const char usage[] =
+    "Usage: cpa [options] <store> <hyp>\n"
+    "       cpa [options] -m <hyp> <out.acc> <in.acc> ..\n\n"
+    "Correlate every hypothesis column of <hyp> (flow/cpa-hyp.py) with\n"
+    "every cycle of the traces in campaign <store>; report the strongest.\n\n"
+    "\t-t\t<n>\tthreads (default: all processors)\n"
+    "\t-c\t<cls>\tonly traces of class fix, rnd, or kgr\n"
+    "\t-r\t<a:b>\ttrace range\n"
+    "\t-w\t<c:d>\tcycle window\n"
+    "\t-a\t\tinclude runs that timed out\n"
+    "\t-s\t<fn>\tsave the accumulator state\n"
+    "\t-u\t<fn>\tupdate: continue from a saved state, save it back\n"
+    "\t-m\t\tmerge saved states of shards instead of reading a store\n"
+    "\t-k\t<n>\treport the n strongest hypotheses (default 10)\n"
+    "\t-o\t<fn>\twrite their correlation per cycle (plot columns)\n";
+
+static int hyp_open(cpa_t *c, const char *fn)
+{
+    struct stat sb;
+    int     fd;
+    void    *p;
+
+    fd = open(fn, O_RDONLY);
+    if (fd < 0 || fstat(fd, &sb) != 0) {
+        perror(fn);
+        return -1;
+    }
+    p = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror(fn);
+        return -1;
+    }
+    c->hyp = (const cpa_hyp_t *) p;
+    c->hyp_sz = sb.st_size;
+    if ((size_t) sb.st_size < sizeof(cpa_hyp_t) ||
+        c->hyp->magic != CPA_MAGIC || (size_t) sb.st_size !=
+            sizeof(cpa_hyp_t) + c->hyp->nh * CPA_NAME +
+            c->hyp->n * c->hyp->nh * sizeof(float)) {
+        fprintf(stderr, "%s: not a hypothesis file\n", fn);
+        return -1;
+    }
+    c->nh   = c->hyp->nh;
+    c->name = ((const char *) p) + sizeof(cpa_hyp_t);
+    c->h    = (const float *) (c->name + c->nh * CPA_NAME);
+    return 0;
+}
+
+//  accumulator layout
+#define CPA_SX(c)   ((c)->a->v)
+#define CPA_SXX(c)  ((c)->a->v + (c)->nc)
+#define CPA_SH(c)   ((c)->a->v + 2 * (c)->nc)
+#define CPA_SHH(c)  ((c)->a->v + 2 * (c)->nc + (c)->nh)
+#define CPA_SHX(c)  ((c)->a->v + 2 * (c)->nc + 2 * (c)->nh)
+
+static bool cpa_keep(void *arg, size_t i)
+{
+    const cpa_t *c = (const cpa_t *) arg;
+
+    return i < c->hyp->n && !isnan(c->h[i * c->nh]);
+}
+
+//  one chunk of one tile: cross sums h * x for all hypotheses
+
+static void cpa_blk(void *ctx, const acc_blk_t *b)
+{
+    const cpa_t *c = (const cpa_t *) ctx;
+    const size_t nh = c->nh, nc = c->nc;
+    double  *sx = CPA_SX(c) + b->off;
+    double  *sxx = CPA_SXX(c) + b->off;
+    double  *shx = CPA_SHX(c) + b->off;
+    const double *x;
+    const float *y;
+    size_t  r0, rn, h0, hn, h, j, r;
+    double  a;
+
+    for (j = 0; j < b->m; j++) {
+        x = b->x + j * ACC_LD;
+        for (r = 0; r < b->rows; r++) {
+            sx[r] += x[r];
+            sxx[r] += x[r] * x[r];
+        }
+    }
+
+    for (r0 = 0; r0 < b->rows; r0 += CPA_RB) {
+        rn = b->rows - r0 < CPA_RB ? b->rows - r0 : CPA_RB;
+        for (h0 = 0; h0 < nh; h0 += CPA_HB) {
+            hn = nh - h0 < CPA_HB ? nh - h0 : CPA_HB;
+
+            //  4 traces x 2 hypotheses per load/store of the sums
+            for (j = 0; j + 4 <= b->m; j += 4) {
+                const double *x0 = b->x + j * ACC_LD + r0;
+                const double *x1 = x0 + ACC_LD;
+                const double *x2 = x1 + ACC_LD;
+                const double *x3 = x2 + ACC_LD;
+                const float *y0 = c->h + b->idx[j] * nh + h0;
+                const float *y1 = c->h + b->idx[j + 1] * nh + h0;
+                const float *y2 = c->h + b->idx[j + 2] * nh + h0;
+                const float *y3 = c->h + b->idx[j + 3] * nh + h0;
+                for (h = 0; h + 2 <= hn; h += 2) {
+                    double *restrict s = shx + (h0 + h) * nc + r0;
+                    double *restrict t = s + nc;
+                    const double a0 = y0[h], a1 = y1[h],
+                                a2 = y2[h], a3 = y3[h];
+                    const double b0 = y0[h + 1], b1 = y1[h + 1],
+                                b2 = y2[h + 1], b3 = y3[h + 1];
+                    for (r = 0; r < rn; r++) {
+                        s[r] += a0 * x0[r] + a1 * x1[r] +
+                                a2 * x2[r] + a3 * x3[r];
+                        t[r] += b0 * x0[r] + b1 * x1[r] +
+                                b2 * x2[r] + b3 * x3[r];
+                    }
+                }
+                if (h < hn) {
+                    double *restrict s = shx + (h0 + h) * nc + r0;
+                    const double a0 = y0[h], a1 = y1[h],
+                                a2 = y2[h], a3 = y3[h];
+                    for (r = 0; r < rn; r++) {
+                        s[r] += a0 * x0[r] + a1 * x1[r] +
+                                a2 * x2[r] + a3 * x3[r];
+                    }
+                }
+            }
+
+            //  remaining traces
+            for (; j < b->m; j++) {
+                x = b->x + j * ACC_LD + r0;
+                y = c->h + b->idx[j] * nh + h0;
+                for (h = 0; h < hn; h++) {
+                    double *restrict s = shx + (h0 + h) * nc + r0;
+                    a = y[h];
+                    for (r = 0; r < rn; r++)
+                        s[r] += a * x[r];
+                }
+            }
+        }
+    }
+}
+
+//  hypothesis sums and count over the selected traces
+
+static void cpa_hsum(cpa_t *c, const trs_t *t, const acc_sel_t *sel)
+{
+    double  *sh = CPA_SH(c), *shh = CPA_SHH(c);
+    const float *y;
+    size_t  i, h;
+
+    for (i = sel->i0; i < sel->i1; i++) {
+        if (!acc_sel_trace(t, sel, i))
+            continue;
+        y = c->h + i * c->nh;
+        for (h = 0; h < c->nh; h++) {
+            sh[h] += y[h];
+            shh[h] += (double) y[h] * y[h];
+        }
+        c->a->hdr.n++;
+    }
+    c->a->hdr.next = sel->i1;
+}
+
+//  pearson correlation of hypothesis h at cycle j
+
+static double cpa_rho(const cpa_t *c, size_t h, size_t j)
+{
+    double  n = c->a->hdr.n;
+    double  sx = CPA_SX(c)[j], sxx = CPA_SXX(c)[j];
+    double  sh = CPA_SH(c)[h], shh = CPA_SHH(c)[h];
+    double  shx = CPA_SHX(c)[h * c->nc + j];
+    double  d;
+
+    d = (n * sxx - sx * sx) * (n * shh - sh * sh);
+    if (d <= 0.0)
+        return 0.0;
+    return (n * shx - sh * sx) / sqrt(d);
+}
+
+typedef struct {
+    size_t  h;
+    int64_t j;
+    double  rho;
+} cpa_top_t;
+
+static int top_cmp(const void *a, const void *b)
+{
+    double x = fabs(((const cpa_top_t *) a)->rho);
+    double y = fabs(((const cpa_top_t *) b)->rho);
+
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static void cpa_report(const cpa_t *c, size_t k, const char *out_fn)
+{
+    cpa_top_t   *top;
+    FILE        *fp;
+    size_t      h, i;
+    int64_t     j;
+    double      rho;
+
+    top = calloc(c->nh, sizeof(cpa_top_t));
+    if (top == NULL)
+        exit(-1);
+    for (h = 0; h < c->nh; h++) {
+        top[h].h = h;
+        for (j = 0; j < c->nc; j++) {
+            rho = cpa_rho(c, h, j);
+            if (fabs(rho) > fabs(top[h].rho)) {
+                top[h].rho = rho;
+                top[h].j = j;
+            }
+        }
+    }
+    qsort(top, c->nh, sizeof(cpa_top_t), top_cmp);
+    if (k > c->nh)
+        k = c->nh;
+
+    printf("[info] %lu traces, %zu hypotheses, cycles %ld .. %ld, "
+            "|rho| > %.4f at z = 4.5\n", c->a->hdr.n, c->nh,
+            c->a->hdr.cyc0, c->a->hdr.cyc0 + c->nc - 1,
+            c->a->hdr.n > 0 ? 4.5 / sqrt(c->a->hdr.n) : 1.0);
+    for (i = 0; i < k; i++) {
+        printf("[cpa] %-24.*s %+8.5f  at %8ld\n", CPA_NAME,
+                c->name + top[i].h * CPA_NAME, top[i].rho,
+                c->a->hdr.cyc0 + top[i].j);
+    }
+
+    if (out_fn != NULL) {
+        fp = fopen(out_fn, "w");
+        if (fp == NULL) {
+            perror(out_fn);
+        } else {
+            fprintf(fp, "# cycle");
+            for (i = 0; i < k; i++)
+                fprintf(fp, " %.*s", CPA_NAME, c->name + top[i].h * CPA_NAME);
+            fprintf(fp, "\n");
+            for (j = 0; j < c->nc; j++) {
+                fprintf(fp, "%ld", c->a->hdr.cyc0 + j);
+                for (i = 0; i < k; i++)
+                    fprintf(fp, " %.6f", cpa_rho(c, top[i].h, j));
+                fprintf(fp, "\n");
+            }
+            fclose(fp);
+        }
+    }
+    free(top);
+}
+
+int main(int argc, char **argv)
+{
+    cpa_t       c;
+    trs_t       *t = NULL;
+    acc_sel_t   sel;
+    const char  *save_fn = NULL, *upd_fn = NULL, *out_fn = NULL;
+    char        *arg[3];
+    int         nthr = acc_nthr(), i, j, narg = 0;
+    size_t      k = 10;
+    bool        merge = false;
+
+    memset(&c, 0, sizeof(c));
+    acc_sel_init(&sel, NULL);
+
+    for (i = 1; i < argc; i++) {
+        if ((j = acc_sel_arg(&sel, argc, argv, i)) > 0) {
+            i += j - 1;
+        } else if (strcmp(argv[i], "-m") == 0) {
+            merge = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            nthr = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            save_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-u") == 0) {
+            upd_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-k") == 0) {
+            k = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (argv[i][0] != '-' && narg < 2) {
+            arg[narg++] = argv[i];
+        } else if (argv[i][0] != '-' && merge) {
+            break;
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (narg < 2 || (merge && i >= argc)) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (merge) {
+        if (hyp_open(&c, arg[0]) != 0 ||
+            (c.a = acc_merge_files(argc - i, argv + i)) == NULL)
+            return 1;
+        c.nc = c.a->hdr.ncyc;
+        if (c.a->hdr.dim != c.nh || strcmp(c.a->hdr.kind, "cpa") != 0) {
+            fprintf(stderr, "%s: does not match %s\n", argv[i], arg[0]);
+            return 1;
+        }
+        acc_save(c.a, arg[1]);
+        cpa_report(&c, k, out_fn);
+        acc_free(c.a);
+        return 0;
+    }
+
+    t = trs_open(arg[0], false);
+    if (t == NULL || hyp_open(&c, arg[1]) != 0)
+        return 1;
+    acc_sel_clip(&sel, t);
+    sel.keep = cpa_keep;
+    sel.keep_arg = &c;
+
+    //  continue from a saved state?
+    if (upd_fn != NULL &&
+        acc_resume(&c.a, upd_fn, "cpa", c.nh, &sel, t) != 0)
+        return 1;
+    if (c.a == NULL) {
+        c.a = acc_new("cpa", sel.cyc0, sel.ncyc, c.nh,
+                        2 * sel.ncyc + 2 * c.nh + c.nh * sel.ncyc);
+    }
+    c.nc = c.a->hdr.ncyc;
+
+    cpa_hsum(&c, t, &sel);
+    acc_scan(t, &sel, nthr, cpa_blk, &c);
+
+    if (upd_fn != NULL)
+        acc_save(c.a, upd_fn);
+    if (save_fn != NULL)
+        acc_save(c.a, save_fn);
+    cpa_report(&c, k, out_fn);
+
+    acc_free(c.a);
+    trs_close(t);
+    return 0;
+}
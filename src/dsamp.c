@@ -0,0 +1,652 @@
+//  dsamp.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Plot-width downsampling of toggle traces and TVLA output.
+
+//  The series (one value per cycle, in one or more columns) is kept as a
+//  pyramid: the raw values and, for blocks of 4, 16, 64, .. cycles, the
+//  min / max / sum / count of each column. The aggregate of any window
+//  is put together from O(log n) whole blocks, so an envelope of w pixel
+//  columns costs O(w log n) regardless of the trace length. The pyramid
+//  can be saved (-p) and memory-mapped by later calls for zooming.
+//  Output rows are "cycle v1 v2 ..", the format the plot/gnuplot.* files
+//  read: min / max envelope (two rows per pixel, so that lines fill the
+//  band), mean per pixel, or LTTB (largest-triangle-three-buckets)
+//  selected points.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#define PYR_MAGIC   0x3152595041524241llu   //  "ABRAPYR1"
+#define PYR_FAN     4                       //  block growth per level
+#define PYR_LEV_MAX 32
+#define DS_COL_MAX  16
+
+const char usage[] =
+    "Usage: dsamp [options] <input | ->\n\n"
+    "Downsamples a per-cycle series for plotting. The input is a toggle\n"
+    "log (\"# c [togd] n\", may be gzipped), tvla output (\"c t # f:(n,\n"
+    "mean, std) r:(..)\": columns t, fix mean, rnd mean, fix std, rnd std),\n"
+    "numeric columns \"c v1 v2 ..\", or a pyramid saved with -p.\n\n"
+    "\t-p\t<fn>\tsave the pyramid of all columns and exit\n"
+    "\t-k\t<cols>\tvalue columns to print, e.g. 2,3, or tvla (1),\n"
+    "\t\t\tavg (2,3), std (4,5) (default: all)\n"
+    "\t-x\t<c:d>\tcycle window [c, d] (default: all)\n"
+    "\t-w\t<n>\tpixel width (default 1000)\n"
+    "\t-m\t<mode>\tenv: min and max rows per pixel (default),\n"
+    "\t\t\tmean: one row per pixel, band: \"c mean min max\" per\n"
+    "\t\t\tcolumn, lttb: n points selected by the first column\n"
+    "\t-o\t<fn>\toutput file (default stdout)\n";
+
+//  block aggregate
+
+typedef struct {
+    double      min, max, sum;
+    uint64_t    n;
+} blk_t;
+
+typedef struct {
+    uint64_t    magic;
+    uint32_t    ncol, nlev;
+    int64_t     x0, n;              //  first cycle, number of cycles
+    uint64_t    pad[4];
+} pyr_hdr_t;
+
+typedef struct {
+    pyr_hdr_t   hdr;
+    double      *raw;               //  [ncol][n], NaN for no value
+    blk_t       *lev[PYR_LEV_MAX];  //  level l >= 1: [ncol][nb(l)]
+    void        *map;
+    size_t      map_sz;
+} pyr_t;
+
+//  block size and count of a level
+
+static inline int64_t pyr_bs(int l)
+{
+    return (int64_t) 1 << (2 * l);
+}
+
+static inline int64_t pyr_nb(const pyr_t *p, int l)
+{
+    return (p->hdr.n + pyr_bs(l) - 1) / pyr_bs(l);
+}
+
+static void blk_clr(blk_t *b)
+{
+    b->min = INFINITY;
+    b->max = -INFINITY;
+    b->sum = 0.0;
+    b->n = 0;
+}
+
+static void blk_add(blk_t *b, const blk_t *a)
+{
+    if (a->n == 0)
+        return;
+    if (a->min < b->min)
+        b->min = a->min;
+    if (a->max > b->max)
+        b->max = a->max;
+    b->sum += a->sum;
+    b->n += a->n;
+}
+
+static void blk_val(blk_t *b, double v)
+{
+    if (isnan(v))
+        return;
+    if (v < b->min)
+        b->min = v;
+    if (v > b->max)
+        b->max = v;
+    b->sum += v;
+    b->n++;
+}
+
+//  aggregate of column c over cycles [a, b) (relative to x0)
+
+static void pyr_agg(const pyr_t *p, uint32_t c, int64_t a, int64_t b,
+                    blk_t *r)
+{
+    int     l;
+    int64_t bs;
+
+    blk_clr(r);
+    while (a < b) {
+        for (l = 0; l + 1 < (int) p->hdr.nlev; l++) {
+            bs = pyr_bs(l + 1);
+            if (a % bs != 0 || a + bs > b)
+                break;
+        }
+        if (l == 0) {
+            blk_val(r, p->raw[c * p->hdr.n + a]);
+            a++;
+        } else {
+            blk_add(r, &p->lev[l][c * pyr_nb(p, l) + a / pyr_bs(l)]);
+            a += pyr_bs(l);
+        }
+    }
+}
+
+//  levels from the raw values (or the pointers into a mapped file)
+
+static size_t pyr_size(const pyr_t *p)
+{
+    size_t  sz;
+    int     l;
+
+    sz = sizeof(pyr_hdr_t) + p->hdr.ncol * p->hdr.n * sizeof(double);
+    for (l = 1; l < (int) p->hdr.nlev; l++)
+        sz += p->hdr.ncol * pyr_nb(p, l) * sizeof(blk_t);
+    return sz;
+}
+
+static void pyr_build(pyr_t *p)
+{
+    int64_t i, j, nb, np;
+    uint32_t c;
+    blk_t   *b;
+    int     l;
+
+    for (l = 1; l < PYR_LEV_MAX && pyr_bs(l) < p->hdr.n; l++)
+        ;
+    p->hdr.nlev = l;
+
+    for (l = 1; l < (int) p->hdr.nlev; l++) {
+        nb = pyr_nb(p, l);
+        np = pyr_nb(p, l - 1);
+        p->lev[l] = (blk_t *) malloc(p->hdr.ncol * nb * sizeof(blk_t));
+        if (p->lev[l] == NULL)
+            exit(-1);
+        for (c = 0; c < p->hdr.ncol; c++) {
+            for (i = 0; i < nb; i++) {
+                b = &p->lev[l][c * nb + i];
+                blk_clr(b);
+                for (j = i * PYR_FAN; j < (i + 1) * PYR_FAN && j < np; j++) {
+                    if (l == 1)
+                        blk_val(b, p->raw[c * p->hdr.n + j]);
+                    else
+                        blk_add(b, &p->lev[l - 1][c * np + j]);
+                }
+            }
+        }
+    }
+}
+
+static int pyr_save(const pyr_t *p, const char *fn)
+{
+    FILE    *fp;
+    int     l;
+
+    fp = fopen(fn, "w");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    fwrite(&p->hdr, sizeof(pyr_hdr_t), 1, fp);
+    fwrite(p->raw, sizeof(double), p->hdr.ncol * p->hdr.n, fp);
+    for (l = 1; l < (int) p->hdr.nlev; l++)
+        fwrite(p->lev[l], sizeof(blk_t), p->hdr.ncol * pyr_nb(p, l), fp);
+    if (fclose(fp) != 0) {
+        perror(fn);
+        return -1;
+    }
+    return 0;
+}
+
+//  a saved pyramid; 1 if fn is not one
+
+static int pyr_map(pyr_t *p, const char *fn)
+{
+    struct stat sb;
+    uint8_t *m;
+    size_t  off;
+    int     fd, l;
+
+    fd = open(fn, O_RDONLY);
+    if (fd < 0 || fstat(fd, &sb) != 0) {
+        perror(fn);
+        exit(-1);
+    }
+    if ((size_t) sb.st_size < sizeof(pyr_hdr_t) ||
+        pread(fd, &p->hdr, sizeof(pyr_hdr_t), 0) != sizeof(pyr_hdr_t) ||
+        p->hdr.magic != PYR_MAGIC) {
+        close(fd);
+        return 1;
+    }
+    if (p->hdr.ncol > DS_COL_MAX || p->hdr.nlev > PYR_LEV_MAX ||
+        pyr_size(p) != (size_t) sb.st_size) {
+        fprintf(stderr, "%s: bad pyramid\n", fn);
+        exit(-1);
+    }
+    m = (uint8_t *) mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        perror("mmap");
+        exit(-1);
+    }
+    p->map = m;
+    p->map_sz = sb.st_size;
+    off = sizeof(pyr_hdr_t);
+    p->raw = (double *) (m + off);
+    off += p->hdr.ncol * p->hdr.n * sizeof(double);
+    for (l = 1; l < (int) p->hdr.nlev; l++) {
+        p->lev[l] = (blk_t *) (m + off);
+        off += p->hdr.ncol * pyr_nb(p, l) * sizeof(blk_t);
+    }
+    return 0;
+}
+
+//  === text input
+
+typedef struct {
+    int64_t     *x;
+    double      *v;                 //  [n][ncol]
+    size_t      n, max;
+    uint32_t    ncol;
+    bool        togd;               //  a missing cycle had no toggles
+} rows_t;
+
+static void rows_add(rows_t *r, int64_t x, const double *v, uint32_t nc)
+{
+    if (r->ncol == 0)
+        r->ncol = nc;
+    if (nc != r->ncol)
+        return;
+    if (r->n == r->max) {
+        r->max = r->max > 0 ? 2 * r->max : 0x10000;
+        r->x = (int64_t *) realloc(r->x, r->max * sizeof(int64_t));
+        r->v = (double *) realloc(r->v, r->max * nc * sizeof(double));
+        if (r->x == NULL || r->v == NULL)
+            exit(-1);
+    }
+    r->x[r->n] = x;
+    memcpy(r->v + r->n * nc, v, nc * sizeof(double));
+    r->n++;
+}
+
+static int read_text(rows_t *r, const char *fn)
+{
+    gzFile  gz;
+    char    buf[1024];
+    char    *p, *q;
+    double  v[DS_COL_MAX], x, f[3], g[3];
+    long    c;
+    uint32_t nc;
+
+    gz = strcmp(fn, "-") == 0 ? gzdopen(0, "r") : gzopen(fn, "r");
+    if (gz == NULL) {
+        perror(fn);
+        return -1;
+    }
+    while (gzgets(gz, buf, sizeof(buf)) != NULL) {
+
+        //  toggle log
+        if ((p = strstr(buf, "[togd]")) != NULL) {
+            if ((q = strchr(buf, '#')) == NULL || q > p)
+                continue;
+            c = strtol(q + 1, NULL, 10);
+            v[0] = strtod(p + 6, NULL);
+            r->togd = true;
+            rows_add(r, c, v, 1);
+            continue;
+        }
+
+        //  tvla.py / tvla -o
+        if (strstr(buf, "# f:(") != NULL) {
+            if (sscanf(buf, "%ld %lf # f:( %lf, %lf, %lf) r:( %lf, %lf, %lf)",
+                        &c, &v[0], &f[0], &f[1], &f[2],
+                        &g[0], &g[1], &g[2]) != 8)
+                continue;
+            v[1] = f[1];
+            v[2] = g[1];
+            v[3] = f[2];
+            v[4] = g[2];
+            rows_add(r, c, v, 5);
+            continue;
+        }
+
+        //  numeric columns
+        x = strtod(buf, &p);
+        if (p == buf)
+            continue;
+        for (nc = 0; nc < DS_COL_MAX; nc++) {
+            v[nc] = strtod(p, &q);
+            if (q == p)
+                break;
+            p = q;
+        }
+        if (nc > 0)
+            rows_add(r, llround(x), v, nc);
+    }
+    gzclose(gz);
+
+    if (r->n == 0) {
+        fprintf(stderr, "%s: no data\n", fn);
+        return -1;
+    }
+    return 0;
+}
+
+//  dense columns from the rows
+
+static void pyr_rows(pyr_t *p, const rows_t *r)
+{
+    int64_t x0, x1;
+    size_t  i, k;
+    uint32_t c;
+
+    x0 = x1 = r->x[0];
+    for (i = 1; i < r->n; i++) {
+        if (r->x[i] < x0)
+            x0 = r->x[i];
+        if (r->x[i] > x1)
+            x1 = r->x[i];
+    }
+    memset(p, 0, sizeof(pyr_t));
+    p->hdr.magic = PYR_MAGIC;
+    p->hdr.ncol = r->ncol;
+    p->hdr.x0 = x0;
+    p->hdr.n = x1 - x0 + 1;
+    p->raw = (double *) malloc(r->ncol * p->hdr.n * sizeof(double));
+    if (p->raw == NULL)
+        exit(-1);
+    for (k = 0; k < r->ncol * (size_t) p->hdr.n; k++)
+        p->raw[k] = r->togd ? 0.0 : NAN;
+    for (i = 0; i < r->n; i++) {
+        for (c = 0; c < r->ncol; c++)
+            p->raw[c * p->hdr.n + r->x[i] - x0] = r->v[i * r->ncol + c];
+    }
+    pyr_build(p);
+}
+
+//  === output
+
+typedef struct {
+    const pyr_t *p;
+    uint32_t    col[DS_COL_MAX];
+    uint32_t    ncol;
+    FILE        *out;
+} ds_t;
+
+static void put_row(ds_t *d, double x, const double *v)
+{
+    uint32_t c;
+
+    if (x == floor(x))
+        fprintf(d->out, "%ld", (long) x);
+    else
+        fprintf(d->out, "%.1f", x);
+    for (c = 0; c < d->ncol; c++) {
+        if (isnan(v[c]))
+            fprintf(d->out, "\tnan");
+        else
+            fprintf(d->out, "\t%.8g", v[c]);
+    }
+    fprintf(d->out, "\n");
+}
+
+//  bin i of w over [a, b)
+
+static inline int64_t bin_at(int64_t a, int64_t b, int64_t w, int64_t i)
+{
+    return a + (b - a) * i / w;
+}
+
+static void out_bins(ds_t *d, int64_t a, int64_t b, int64_t w, int mode)
+{
+    const pyr_t *p = d->p;
+    double  lo[DS_COL_MAX], hi[DS_COL_MAX], mu[DS_COL_MAX];
+    blk_t   r;
+    int64_t i, b0, b1;
+    uint32_t c;
+
+    if (b - a < w)
+        w = b - a;
+    for (i = 0; i < w; i++) {
+        b0 = bin_at(a, b, w, i);
+        b1 = bin_at(a, b, w, i + 1);
+        for (c = 0; c < d->ncol; c++) {
+            pyr_agg(p, d->col[c], b0, b1, &r);
+            lo[c] = r.n > 0 ? r.min : NAN;
+            hi[c] = r.n > 0 ? r.max : NAN;
+            mu[c] = r.n > 0 ? r.sum / r.n : NAN;
+        }
+        if (mode == 'b') {
+            fprintf(d->out, "%ld", (long) (p->hdr.x0 + b0));
+            for (c = 0; c < d->ncol; c++) {
+                if (isnan(mu[c]))
+                    fprintf(d->out, "\tnan\tnan\tnan");
+                else
+                    fprintf(d->out, "\t%.8g\t%.8g\t%.8g",
+                            mu[c], lo[c], hi[c]);
+            }
+            fprintf(d->out, "\n");
+        } else if (mode == 'm' || b1 - b0 == 1) {
+            put_row(d, p->hdr.x0 + 0.5 * (b0 + b1 - 1), mu);
+        } else {
+            put_row(d, p->hdr.x0 + b0, lo);
+            put_row(d, p->hdr.x0 + b1 - 1, hi);
+        }
+    }
+}
+
+//  largest-triangle-three-buckets over per-chunk means, driven by the
+//  first printed column; the chunks are ~1/8 of a bucket
+
+static void out_lttb(ds_t *d, int64_t a, int64_t b, int64_t w)
+{
+    const pyr_t *p = d->p;
+    double  *x, *y, ax, ay, ar, am;
+    int64_t m, n, i, j, k, s, j0, j1, sel;
+    blk_t   r;
+    uint32_t c;
+
+    s = (b - a) / (8 * w);
+    if (s < 1)
+        s = 1;
+    m = (b - a + s - 1) / s;
+    x = (double *) malloc(m * sizeof(double));
+    y = (double *) malloc(m * d->ncol * sizeof(double));
+    if (x == NULL || y == NULL)
+        exit(-1);
+
+    //  points with a value in the driving column
+    n = 0;
+    for (i = 0; i < m; i++) {
+        j0 = a + i * s;
+        j1 = j0 + s < b ? j0 + s : b;
+        pyr_agg(p, d->col[0], j0, j1, &r);
+        if (r.n == 0)
+            continue;
+        x[n] = p->hdr.x0 + 0.5 * (j0 + j1 - 1);
+        for (c = 0; c < d->ncol; c++) {
+            if (c > 0)
+                pyr_agg(p, d->col[c], j0, j1, &r);
+            y[n * d->ncol + c] = r.n > 0 ? r.sum / r.n : NAN;
+        }
+        n++;
+    }
+
+    if (n <= w || w < 3) {
+        for (i = 0; i < n; i++)
+            put_row(d, x[i], y + i * d->ncol);
+        free(x);
+        free(y);
+        return;
+    }
+
+    put_row(d, x[0], y);
+    k = 0;
+    for (i = 0; i < w - 2; i++) {
+
+        //  average of the next bucket
+        j0 = 1 + (i + 1) * (n - 2) / (w - 2);
+        j1 = 1 + (i + 2) * (n - 2) / (w - 2);
+        if (j1 > n)
+            j1 = n;
+        ax = ay = 0.0;
+        for (j = j0; j < j1; j++) {
+            ax += x[j];
+            ay += y[j * d->ncol];
+        }
+        if (j1 > j0) {
+            ax /= j1 - j0;
+            ay /= j1 - j0;
+        } else {
+            ax = x[n - 1];
+            ay = y[(n - 1) * d->ncol];
+        }
+
+        //  point of this bucket with the largest triangle
+        j0 = 1 + i * (n - 2) / (w - 2);
+        j1 = 1 + (i + 1) * (n - 2) / (w - 2);
+        sel = j0;
+        am = -1.0;
+        for (j = j0; j < j1; j++) {
+            ar = fabs((x[k] - ax) * (y[j * d->ncol] - y[k * d->ncol]) -
+                        (x[k] - x[j]) * (ay - y[k * d->ncol]));
+            if (ar > am) {
+                am = ar;
+                sel = j;
+            }
+        }
+        put_row(d, x[sel], y + sel * d->ncol);
+        k = sel;
+    }
+    put_row(d, x[n - 1], y + (n - 1) * d->ncol);
+
+    free(x);
+    free(y);
+}
+
+//  "2,3", or a name for the tvla columns
+
+static int parse_cols(ds_t *d, const char *s)
+{
+    char    *p;
+    long    c;
+
+    if (strcmp(s, "tvla") == 0)
+        s = "1";
+    else if (strcmp(s, "avg") == 0)
+        s = "2,3";
+    else if (strcmp(s, "std") == 0)
+        s = "4,5";
+    d->ncol = 0;
+    while (*s != 0 && d->ncol < DS_COL_MAX) {
+        c = strtol(s, &p, 10);
+        if (p == s || c < 1)
+            return -1;
+        d->col[d->ncol++] = c - 1;
+        s = *p == ',' ? p + 1 : p;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    pyr_t       p;
+    rows_t      r;
+    ds_t        d;
+    const char  *in_fn = NULL, *pyr_fn = NULL, *out_fn = NULL;
+    const char  *cols = NULL;
+    char        *q;
+    int64_t     w = 1000, x0 = INT64_MIN, x1 = INT64_MAX, a, b;
+    int         mode = 'e', i;
+    uint32_t    c;
+
+    memset(&r, 0, sizeof(r));
+    memset(&d, 0, sizeof(d));
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            pyr_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-k") == 0) {
+            cols = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-x") == 0) {
+            x0 = strtoll(argv[++i], &q, 0);
+            x1 = *q == ':' ? strtoll(q + 1, NULL, 0) : x0;
+        } else if (i + 1 < argc && strcmp(argv[i], "-w") == 0) {
+            w = strtoll(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+            i++;
+            mode =  strcmp(argv[i], "env") == 0 ? 'e' :
+                    strcmp(argv[i], "mean") == 0 ? 'm' :
+                    strcmp(argv[i], "band") == 0 ? 'b' :
+                    strcmp(argv[i], "lttb") == 0 ? 'l' : 0;
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (in_fn == NULL &&
+                    (argv[i][0] != '-' || argv[i][1] == 0)) {
+            in_fn = argv[i];
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (in_fn == NULL || mode == 0 || w < 1 || x1 < x0) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    //  a saved pyramid, or text to build one from
+    if (strcmp(in_fn, "-") == 0 || pyr_map(&p, in_fn) != 0) {
+        if (read_text(&r, in_fn) != 0)
+            return 1;
+        pyr_rows(&p, &r);
+        free(r.x);
+        free(r.v);
+    }
+    if (pyr_fn != NULL)
+        return pyr_save(&p, pyr_fn) != 0;
+
+    d.p = &p;
+    if (cols != NULL) {
+        if (parse_cols(&d, cols) != 0) {
+            fputs(usage, stderr);
+            return 1;
+        }
+    } else {
+        for (c = 0; c < p.hdr.ncol && c < DS_COL_MAX; c++)
+            d.col[d.ncol++] = c;
+    }
+    for (c = 0; c < d.ncol; c++) {
+        if (d.col[c] >= p.hdr.ncol) {
+            fprintf(stderr, "%s: %u value columns\n", in_fn, p.hdr.ncol);
+            return 1;
+        }
+    }
+
+    //  window, clipped to the data
+    a = x0 > p.hdr.x0 ? x0 - p.hdr.x0 : 0;
+    b = x1 < p.hdr.x0 + p.hdr.n - 1 ? x1 - p.hdr.x0 + 1 : p.hdr.n;
+    if (b <= a) {
+        fprintf(stderr, "%s: window outside %ld:%ld\n", in_fn,
+                p.hdr.x0, p.hdr.x0 + p.hdr.n - 1);
+        return 1;
+    }
+
+    d.out = stdout;
+    if (out_fn != NULL && (d.out = fopen(out_fn, "w")) == NULL) {
+        perror(out_fn);
+        return 1;
+    }
+    if (mode == 'l')
+        out_lttb(&d, a, b, w);
+    else
+        out_bins(&d, a, b, w, mode);
+    if (d.out != stdout)
+        fclose(d.out);
+
+    return 0;
+}
@@ -5,9 +5,26 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
 #include <verilated.h>
+#ifdef PRESI_FST
+#include "verilated_fst_c.h"
+#else
 #include "verilated_vcd_c.h"
+#endif
 #include "Vmldsa_wrap.h"
+#include "Vmldsa_wrap__Dpi.h"
+
+#include "vcd.h"
+#include "shmring.h"
 
 //#define PRESI_TRACE
 
@@ -131,6 +148,91 @@ size_t write_fn(const void *buf, size_t buf_sz, const char *fn)
 
 }
 
+//  === key-resident sessions
+
+//  One key is written once; per operation only the message, signature,
+//  rnd and entropy are. Each line of the session list has the inputs of
+//  one operation in hex (byte order as in the .dat files), and one result
+//  line per operation is written.
+
+static struct {
+    FILE        *in, *out;
+    int64_t     n;                      //  operations read
+    int64_t     line;
+    int64_t     c0;                     //  start cycle of current op
+    bool        key;                    //  key already in the device
+} sess;
+
+static int hex_nib(int c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+//  next operation: n hex fields to buf[i] of len[i] bytes; missing fields
+//  are zero. 1 = ok, 0 = end of list, -1 = error.
+
+static int sess_read(void * const *buf, const size_t *len, int n)
+{
+    static char *line = NULL;
+    static size_t sz = 0;
+    char    *p, *tok;
+    size_t  j;
+    int     i, a, b;
+
+    while (getline(&line, &sz, sess.in) > 0) {
+        sess.line++;
+        if ((p = strchr(line, '#')) != NULL)
+            *p = 0;
+        tok = strtok(line, " \t\r\n");
+        if (tok == NULL)
+            continue;
+        for (i = 0; i < n; i++) {
+            memset(buf[i], 0, len[i]);
+            if (tok == NULL)
+                continue;
+            if (strlen(tok) != 2 * len[i]) {
+                fprintf(stderr, "session line %ld: field %d is not %zu bytes\n",
+                        sess.line, i + 1, len[i]);
+                return -1;
+            }
+            for (j = 0; j < len[i]; j++) {
+                a = hex_nib(tok[2 * j]);
+                b = hex_nib(tok[2 * j + 1]);
+                if (a < 0 || b < 0) {
+                    fprintf(stderr, "session line %ld: bad hex\n", sess.line);
+                    return -1;
+                }
+                ((uint8_t *) buf[i])[j] = (a << 4) | b;
+            }
+            tok = strtok(NULL, " \t\r\n");
+        }
+        sess.n++;
+        return 1;
+    }
+    return 0;
+}
+
+//  result record: index, start cycle, cycles, result (text or hex)
+
+static void sess_put(int64_t cycle, const char *res,
+                        const void *buf, size_t len)
+{
+    size_t i;
+
+    fprintf(sess.out, "%ld\t%ld\t%ld\t", sess.n - 1, sess.c0, cycle - sess.c0);
+    if (res != NULL)
+        fputs(res, sess.out);
+    for (i = 0; i < len; i++)
+        fprintf(sess.out, "%02x", ((const uint8_t *) buf)[i]);
+    fputc('\n', sess.out);
+}
+
 //  dump bytes in hex to stdout
 
 void dump_hex(const void *buf, size_t buf_sz)
@@ -143,12 +245,1138 @@ void dump_hex(const void *buf, size_t buf_sz)
     printf("\n");
 }
 
+//  === shared-memory ring output
+
+//  Toggle counts come from model state (state_emit), except with per-signal
+//  diffs: their ids are vcd signals, so VCD text is parsed in-process
+
+static struct {
+    shmr_hdr_t  *ring;                  //  NULL if not in use
+    vcd_str_t   st;                     //  in-process vcd parser
+    bool        sig;                    //  include per-signal diffs
+    std::vector<shmr_sig_t> diff;       //  diffs of current cycle
+} shm;
+
+static void shm_cyc(void *arg, int64_t cyc, int64_t hd)
+{
+    shmr_rec_t rec;
+
+    (void) arg;
+    memset(&rec, 0, sizeof(rec));
+    rec.type    = SHMR_CYC;
+    rec.cyc     = cyc;
+    rec.val     = hd;
+    rec.nd      = shm.diff.size();
+    shmr_put(shm.ring, &rec, shm.diff.data(),
+                shm.diff.size() * sizeof(shmr_sig_t));
+    shm.diff.clear();
+}
+
+static void shm_sig(void *arg, const var_t *v, int64_t sd)
+{
+    shmr_sig_t x;
+
+    (void) arg;
+    x.id = v - shm.st.hdr->var;
+    x.sd = sd;
+    shm.diff.push_back(x);
+}
+
+//  sequencer hook in rtl/mldsa_seq_decode.sv; returns 0 if the decoder
+//  should not print the step (the second model of a lockstep run)
+
+static bool flt_trig_on = false;        //  fault campaign: phase triggers
+static void flt_seq(int unit, int addr);
+static bool lock_in_b = false;          //  lockstep: second model in eval
+
+int mldsa_seq_event(int unit, int cyc, int addr)
+{
+    shmr_rec_t rec;
+
+    if (lock_in_b)
+        return 0;
+    if (flt_trig_on)
+        flt_seq(unit, addr);
+    if (shm.ring == NULL)
+        return 1;
+    memset(&rec, 0, sizeof(rec));
+    rec.type    = SHMR_SEQ;
+    rec.unit    = unit;
+    rec.cyc     = cyc;
+    rec.val     = addr;
+    shmr_put(shm.ring, &rec, NULL, 0);
+    return 1;
+}
+
+//  vcd "file" that feeds the toggle counter, optionally also writing it
+
+#ifndef PRESI_FST
+class ShmVcdFile : public VerilatedVcdFile {
+public:
+    bool    tee     = false;            //  also write the vcd file
+    std::vector<char> buf;              //  incomplete line
+    uint64_t bytes  = 0;                //  vcd text produced
+
+    bool open(const std::string& name) override {
+        return tee ? VerilatedVcdFile::open(name) : true;
+    }
+    void close() override {
+        buf.push_back(0);
+        vcd_str_end(&shm.st, buf.data(), buf.size() - 1);
+        buf.clear();
+        if (tee)
+            VerilatedVcdFile::close();
+    }
+    ssize_t write(const char* bufp, ssize_t len) override {
+        size_t n;
+
+        bytes += len;
+        buf.insert(buf.end(), bufp, bufp + len);
+        n = vcd_str_feed(&shm.st, buf.data(), buf.size());
+        buf.erase(buf.begin(), buf.begin() + n);
+        return tee ? VerilatedVcdFile::write(bufp, len) : len;
+    }
+};
+#endif
+
+//  === SRAM port activity
+
+//  rtl/mldsa_sram_mon.sv is bound into the RAMs; instances under
+//  mldsa_mem_top report reads, writes and data-bus bit flips per cycle.
+//  Totals of a cycle go as extra columns on the -state toggle lines;
+//  -sramlog writes the counts of each instance per cycle, binned by the
+//  timing signal (with or without -state and -vcd).
+
+#define SRAM_SCOPE  ".mldsa_mem_top_inst."
+
+typedef struct {
+    int64_t     rd, wr, hdw, hdr;
+} sram_cnt_t;
+
+typedef struct {
+    std::string path;
+    int         dw, aw;
+    sram_cnt_t  tot;
+    sram_cnt_t  cur;                    //  current cycle
+} sram_inst_t;
+
+static struct {
+    bool        on;
+    std::vector<sram_inst_t> inst;
+    sram_cnt_t  cur;                    //  current cycle, all instances
+    FILE        *log;                   //  -sramlog (or NULL)
+    int64_t     cyc;                    //  its current cycle
+} sram;
+
+int mldsa_sram_reg(const char *path, int dw, int aw)
+{
+    sram_inst_t x;
+    size_t l;
+
+    if (!sram.on || lock_in_b || strstr(path, SRAM_SCOPE) == NULL)
+        return -1;
+    x.path = path;
+    l = x.path.rfind(".sram_mon");
+    if (l != std::string::npos)
+        x.path.erase(l);
+    x.dw = dw;
+    x.aw = aw;
+    memset(&x.tot, 0, sizeof(x.tot));
+    memset(&x.cur, 0, sizeof(x.cur));
+    sram.inst.push_back(x);
+
+    return sram.inst.size() - 1;
+}
+
+void mldsa_sram_event(int id, int we, int re, int hdw, int hdr)
+{
+    sram_cnt_t *t = &sram.inst[id].tot;
+    sram_cnt_t *c = &sram.inst[id].cur;
+
+    t->wr   += we;
+    t->rd   += re;
+    t->hdw  += hdw;
+    t->hdr  += hdr;
+    c->wr   += we;
+    c->rd   += re;
+    c->hdw  += hdw;
+    c->hdr  += hdr;
+    sram.cur.wr     += we;
+    sram.cur.rd     += re;
+    sram.cur.hdw    += hdw;
+    sram.cur.hdr    += hdr;
+}
+
+//  per-cycle log: a line for each instance that was active in the cycle;
+//  activity before the first cycle goes to it (as state_emit)
+
+static void sram_emit(void)
+{
+    size_t i;
+
+    if (sram.cyc < 0)
+        return;
+    for (i = 0; i < sram.inst.size(); i++) {
+        sram_cnt_t &c = sram.inst[i].cur;
+        if (c.rd == 0 && c.wr == 0 && c.hdw == 0 && c.hdr == 0)
+            continue;
+        fprintf(sram.log, "#%8ld [sram]  %zu %ld %ld %ld %ld\n",
+                sram.cyc, i, c.rd, c.wr, c.hdw, c.hdr);
+        memset(&c, 0, sizeof(c));
+    }
+}
+
+//  at every dump point, as state_step
+
+static void sram_step(int64_t ncyc)
+{
+    if (ncyc > sram.cyc) {
+        sram_emit();
+        sram.cyc = ncyc;
+    }
+}
+
+//  instance table with totals: index, widths, counts, path
+
+static void sram_table(const char *fn)
+{
+    FILE *fp;
+    size_t i;
+
+    fp = fopen(fn, "w");
+    if (fp == NULL) {
+        perror(fn);
+        return;
+    }
+    fprintf(fp, "#  id  dw  aw  reads  writes  hd_wdata  hd_rdata  path\n");
+    for (i = 0; i < sram.inst.size(); i++) {
+        const sram_inst_t &x = sram.inst[i];
+        fprintf(fp, "%zu %d %d %ld %ld %ld %ld %s\n", i, x.dw, x.aw,
+                x.tot.rd, x.tot.wr, x.tot.hdw, x.tot.hdr, x.path.c_str());
+    }
+    fclose(fp);
+    printf("[SAVE]\t%s (%zu srams)\n", fn, sram.inst.size());
+}
+
+//  === model-state toggle counter
+
+//  Instead of tracing, diff the model's own signal storage against a
+//  shadow copy. The member table of the root class is generated at build
+//  time (flow/mkstate.py); selected members are coalesced into contiguous
+//  regions that are compared 64 bits at a time.
+
+typedef struct {
+    size_t      off;                    //  offset in the root object
+    size_t      len;                    //  bytes
+    size_t      sh;                     //  regions: offset in shadow
+    const char  *name;
+    bool        on;                     //  selected
+} state_mem_t;
+
+static struct {
+    const uint8_t   *base;              //  root object
+    std::vector<state_mem_t> mem;       //  all members
+    std::vector<state_mem_t> reg;       //  coalesced regions
+    std::vector<uint8_t> shadow;        //  previous values
+    bool        on;                     //  -state, or -shm without -shmsig
+    FILE        *out;                   //  toggle log (or NULL)
+    int64_t     cyc;                    //  current cycle
+    int64_t     hd;                     //  toggles in current cycle
+} state;
+
+static void state_var(const char *name, const void *p, size_t len)
+{
+    state_mem_t m;
+
+    m.off   = (const uint8_t *) p - state.base;
+    m.len   = len;
+    m.sh    = 0;
+    m.name  = name;
+    m.on    = strstr(name, "__V") == NULL &&    //  verilator internals
+                strstr(name, ".sram_mon.") == NULL;
+    state.mem.push_back(m);
+}
+
+#include "Vmldsa_wrap__state.h"
+
+//  selection rules, one per line: "+prefix" or "prefix" selects, "-prefix"
+//  deselects; the last matching rule wins. Returns number of rules.
+
+static int state_select(const char *fn)
+{
+    char    buf[1024];
+    FILE    *fp;
+    size_t  l;
+    int     n = 0;
+    bool    on;
+    const char *s;
+
+    if (fn == NULL)
+        return 0;
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    while (fgets(buf, sizeof(buf), fp) != NULL) {
+        l = strcspn(buf, " \t\r\n#");
+        buf[l] = 0;
+        if (l == 0)
+            continue;
+        on = buf[0] != '-';
+        s = buf[0] == '-' || buf[0] == '+' ? buf + 1 : buf;
+        l = strlen(s);
+
+        //  the first rule sets the default: include rules start from none
+        if (n++ == 0 && on) {
+            for (auto &m : state.mem)
+                m.on = false;
+        }
+        for (auto &m : state.mem) {
+            if (strncmp(m.name, s, l) == 0 && strstr(m.name, "__V") == NULL)
+                m.on = on;
+        }
+    }
+    fclose(fp);
+    return n;
+}
+
+//  member table and coalesced regions; returns number of selected members
+
+static size_t state_table(const STATE_ROOT *root, const char *sel_fn)
+{
+    size_t  i, end = 0, nsel = 0;
+    bool    gap = true;                 //  unselected member since last
+
+    state.base = (const uint8_t *) root;
+    state_vars(root);
+    std::sort(state.mem.begin(), state.mem.end(),
+                [](const state_mem_t &a, const state_mem_t &b) {
+                    return a.off < b.off; });
+    state_select(sel_fn);
+
+    //  coalesce: padding between selected members is never written
+    for (i = 0; i < state.mem.size(); i++) {
+        const state_mem_t &m = state.mem[i];
+        if (!m.on) {
+            gap = true;
+            continue;
+        }
+        if (!gap && m.off >= end && m.off - end < 64) {
+            state.reg.back().len = m.off + m.len - state.reg.back().off;
+        } else {
+            state.reg.push_back(m);
+        }
+        end = m.off + m.len;
+        gap = false;
+        nsel++;
+    }
+    return nsel;
+}
+
+static void state_init(const STATE_ROOT *root, const char *sel_fn)
+{
+    size_t  nsel, bytes = 0;
+
+    nsel = state_table(root, sel_fn);
+    for (auto &r : state.reg) {
+        r.sh = bytes;
+        bytes += r.len;
+    }
+    state.shadow.resize(bytes);
+    for (auto &r : state.reg)
+        memcpy(state.shadow.data() + r.sh, state.base + r.off, r.len);
+
+    state.cyc = -1;
+    state.hd = 0;
+    printf("[INIT]\tstate: %zu of %zu members, %zu regions, %zu bytes\n",
+            nsel, state.mem.size(), state.reg.size(), bytes);
+}
+
+//  bits changed since the previous call
+
+static int64_t state_diff(void)
+{
+    int64_t hd = 0;
+    uint64_t a, b;
+    size_t  i;
+
+    for (auto &r : state.reg) {
+        const uint8_t *p = state.base + r.off;
+        uint8_t *q = state.shadow.data() + r.sh;
+        for (i = 0; i + 8 <= r.len; i += 8) {
+            memcpy(&a, p + i, 8);
+            memcpy(&b, q + i, 8);
+            hd += __builtin_popcountll(a ^ b);
+            memcpy(q + i, &a, 8);
+        }
+        for (; i < r.len; i++) {
+            hd += __builtin_popcount(p[i] ^ q[i]);
+            q[i] = p[i];
+        }
+    }
+    return hd;
+}
+
+//  at every dump point; binned by the timing signal like readvcd
+
+static void state_emit(void)
+{
+    if (state.cyc >= 0) {
+        if (sram.on) {
+            const sram_cnt_t &c = sram.cur;
+            if (state.out != NULL && (state.hd > 0 || c.rd > 0 ||
+                    c.wr > 0 || c.hdw > 0 || c.hdr > 0))
+                fprintf(state.out, "#%8ld [togd]  %ld %ld %ld %ld %ld\n",
+                        state.cyc, state.hd, c.rd, c.wr, c.hdw, c.hdr);
+            memset(&sram.cur, 0, sizeof(sram.cur));
+        } else if (state.out != NULL && state.hd > 0) {
+            fprintf(state.out, "#%8ld [togd]  %ld\n", state.cyc, state.hd);
+        }
+        if (shm.ring != NULL)
+            shm_cyc(NULL, state.cyc, state.hd);
+        state.hd = 0;
+    }
+}
+
+static void state_step(const STATE_ROOT *root, int64_t cycle)
+{
+    int64_t ncyc = STATE_CYC(root);
+
+    if (ncyc < 0)                       //  no timing signal in the model
+        ncyc = cycle;
+    state.hd += state_diff();
+    if (ncyc > state.cyc) {
+        state_emit();
+        state.cyc = ncyc;
+    }
+}
+
+//  write the signal table for per-signal diffs: index, width, name
+
+static void shm_sig_table(const char *fn)
+{
+    const vcd_hdr_t *hdr = shm.st.hdr;
+    FILE *fp;
+    size_t i;
+
+    if (fn == NULL || hdr == NULL)
+        return;
+    fp = fopen(fn, "w");
+    if (fp == NULL) {
+        perror(fn);
+        return;
+    }
+    for (i = 0; i < hdr->var_n; i++) {
+        fprintf(fp, "%zu %d %s\n", i, hdr->var[i].d,
+                vcd_signame(hdr, &hdr->var[i]));
+    }
+    fclose(fp);
+    printf("[SAVE]\t%s (%zu signals)\n", fn, hdr->var_n);
+}
+
+//  === fault injection campaign
+
+//  The golden run forks a child at the cycle of each fault, so faults are
+//  never simulated from reset. The child flips or sticks one bit of a
+//  root member (the -state member table; registers are exact, Verilator
+//  may recompute a combinational net), runs to completion or a timeout,
+//  and leaves its outcome in a shared table. The parent classifies the
+//  outcomes against its own outputs once it is done.
+
+#define FLT_FLIP    0
+#define FLT_SA0     1
+#define FLT_SA1     2
+
+typedef struct {
+    int64_t     cyc;                    //  injection cycle, -1 unresolved
+    int64_t     off;                    //  cycles after a phase trigger
+    size_t      mem;                    //  index in state.mem
+    int64_t     bit;
+    int         model;
+    std::string spec;                   //  line of the fault list
+} flt_t;
+
+typedef struct {
+    int         forked;                 //  injected
+    int         done;                   //  child got to the end
+    int         fin;                    //  operation completed
+    int         err;                    //  error_intr seen
+    int64_t     cyc;                    //  cycles after injection
+    uint64_t    hash;                   //  outputs
+} flt_res_t;
+
+static struct {
+    bool        on;                     //  parent of a campaign
+    bool        child;
+    bool        stuck;                  //  child: re-apply after evals
+    size_t      k;                      //  child: its fault
+    std::vector<flt_t> flt;
+    std::multimap<int64_t, size_t> pend;    //  cycle -> fault
+    std::multimap<int, size_t> trig;        //  unit, addr -> fault
+    flt_res_t   *res;                   //  shared with the children
+    int64_t     cyc;                    //  current cycle, for triggers
+    int         run, jobs;              //  live children, limit
+} flt;
+
+#define FLT_TRIG(unit, addr)    (((unit) << 16) | (addr))
+
+//  member by hierarchical name: exact, or shortest with the suffix
+
+static ssize_t flt_member(const char *name)
+{
+    ssize_t r = -1;
+    size_t i, l, nl = strlen(name);
+
+    for (i = 0; i < state.mem.size(); i++) {
+        const char *m = state.mem[i].name;
+        if (strcmp(m, name) == 0)
+            return i;
+        l = strlen(m);
+        if (l > nl && m[l - nl - 1] == '.' && strcmp(m + l - nl, name) == 0 &&
+            (r < 0 || l < strlen(state.mem[r].name)))
+            r = i;
+    }
+    return r;
+}
+
+//  fault list, one per line: <signal>[bit] <cycle | p<addr>[+n] |
+//  s<addr>[+n]> <flip | sa0 | sa1>. Returns number of faults.
+
+static int flt_load(const char *fn, const STATE_ROOT *root)
+{
+    FILE    *fp;
+    char    buf[1024], sig[1024], when[64], model[16], *p;
+    int     line = 0, unit;
+    ssize_t m;
+    flt_t   f;
+
+    state.base = (const uint8_t *) root;
+    state_vars(root);
+
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    while (fgets(buf, sizeof(buf), fp) != NULL) {
+        line++;
+        if ((p = strchr(buf, '#')) != NULL)
+            *p = 0;
+        if (sscanf(buf, "%1023s %63s %15s", sig, when, model) != 3)
+            continue;
+
+        f.bit = 0;
+        if ((p = strrchr(sig, '[')) != NULL) {
+            *p = 0;
+            f.bit = strtoll(p + 1, NULL, 0);
+        }
+        m = flt_member(sig);
+        if (m < 0 || f.bit < 0 ||
+            f.bit >= (int64_t) (8 * state.mem[m].len)) {
+            fprintf(stderr, "%s:%d: no such member or bit: %s\n",
+                    fn, line, sig);
+            fclose(fp);
+            return -1;
+        }
+        f.mem = m;
+
+        if (strcmp(model, "flip") == 0) {
+            f.model = FLT_FLIP;
+        } else if (strcmp(model, "sa0") == 0) {
+            f.model = FLT_SA0;
+        } else if (strcmp(model, "sa1") == 0) {
+            f.model = FLT_SA1;
+        } else {
+            fprintf(stderr, "%s:%d: bad fault model: %s\n", fn, line, model);
+            fclose(fp);
+            return -1;
+        }
+
+        f.spec = std::string(state.mem[m].name) + "[" +
+                    std::to_string(f.bit) + "] " + when + " " + model;
+        f.off = 0;
+        f.cyc = -1;
+        if (when[0] == 'p' || when[0] == 's') {
+            unit = when[0] == 'p' ? 0 : 1;
+            f.off = 0;
+            if ((p = strchr(when, '+')) != NULL)
+                f.off = strtoll(p + 1, NULL, 0);
+            flt.trig.insert(std::make_pair(
+                FLT_TRIG(unit, atoi(when + 1)), flt.flt.size()));
+        } else {
+            f.cyc = strtoll(when, NULL, 0);
+            flt.pend.insert(std::make_pair(f.cyc, flt.flt.size()));
+        }
+        flt.flt.push_back(f);
+    }
+    fclose(fp);
+
+    return flt.flt.size();
+}
+
+//  first visit of a sequencer address schedules its faults
+
+static void flt_seq(int unit, int addr)
+{
+    auto r = flt.trig.equal_range(FLT_TRIG(unit, addr));
+
+    for (auto it = r.first; it != r.second; it++) {
+        flt_t &f = flt.flt[it->second];
+        f.cyc = flt.cyc + 1 + f.off;
+        flt.pend.insert(std::make_pair(f.cyc, it->second));
+    }
+    flt.trig.erase(r.first, r.second);
+}
+
+static void flt_apply(const flt_t *f)
+{
+    uint8_t *p = (uint8_t *) state.base + state.mem[f->mem].off + f->bit / 8;
+    uint8_t b = 1 << (f->bit % 8);
+
+    switch (f->model) {
+        case FLT_FLIP:  *p ^= b;    break;
+        case FLT_SA0:   *p &= ~b;   break;
+        case FLT_SA1:   *p |= b;    break;
+    }
+}
+
+static void flt_wait(void)
+{
+    if (flt.run > 0 && wait(NULL) > 0)
+        flt.run--;
+}
+
+//  fork the faults due at this cycle; true in a child
+
+static bool flt_fork(int64_t cycle)
+{
+    pid_t pid;
+    size_t k;
+
+    while (!flt.pend.empty() && flt.pend.begin()->first <= cycle) {
+        k = flt.pend.begin()->second;
+        flt.pend.erase(flt.pend.begin());
+        while (flt.run >= flt.jobs)
+            flt_wait();
+
+        flt.res[k].forked = 1;
+        fflush(stdout);
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            exit(-1);
+        }
+        if (pid == 0) {
+            flt.on = false;
+            flt_trig_on = false;
+            flt.child = true;
+            flt.k = k;
+            flt.stuck = flt.flt[k].model != FLT_FLIP;
+            if (freopen("/dev/null", "w", stdout) == NULL)
+                _exit(1);
+            flt_apply(&flt.flt[k]);
+            return true;
+        }
+        flt.run++;
+    }
+    return false;
+}
+
+//  FNV-1a
+
+static uint64_t flt_hash(uint64_t h, const void *buf, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= ((const uint8_t *) buf)[i];
+        h *= 0x100000001B3;
+    }
+    return h;
+}
+
+//  outcome of each fault after the golden run; summary to stdout
+
+static void flt_report(const char *fn, uint64_t gold)
+{
+    static const char *cls[] =
+        { "masked", "detected", "sdc", "hang", "crash", "none" };
+    int64_t n[6] = { 0 };
+    FILE    *fp;
+    size_t  i;
+    int     c;
+
+    while (flt.run > 0)
+        flt_wait();
+
+    fp = fopen(fn, "w");
+    if (fp == NULL) {
+        perror(fn);
+        return;
+    }
+    for (i = 0; i < flt.flt.size(); i++) {
+        const flt_t &f = flt.flt[i];
+        const flt_res_t &r = flt.res[i];
+        if (!r.forked)
+            c = 5;                      //  never reached
+        else if (!r.done)
+            c = 4;
+        else if (r.err)
+            c = 1;
+        else if (!r.fin)
+            c = 3;
+        else if (r.hash == gold)
+            c = 0;
+        else
+            c = 2;
+        n[c]++;
+        fprintf(fp, "%zu\t%ld\t%s\t%ld\t%s\n",
+                i, f.cyc, cls[c], r.cyc, f.spec.c_str());
+    }
+    fclose(fp);
+    printf("[SAVE]\t%s (%zu faults)\n", fn, flt.flt.size());
+    printf("[FLT ]");
+    for (c = 0; c < 6; c++)
+        printf("\t%s= %ld", cls[c], n[c]);
+    printf("\n");
+}
+
+//  === lockstep differential simulation
+
+//  A second model gets the same bus inputs as the first, except for the
+//  words of one input field, where its own copy with a chosen difference
+//  is written. Both are evaluated every half cycle; after each rising
+//  edge the selected members of the -state table are compared directly
+//  between the two root objects, region by region, and only regions that
+//  differ are split into members. The handshake follows the first model,
+//  so a difference that changes control flow shows up as divergence.
+
+#define LOCK_ETA    2                   //  ml-dsa-87 secret coefficients
+#define LOCK_S1     (32 + 32 + 64)      //  rho, K, tr
+#define LOCK_S1_N   (7 * 256)
+#define LOCK_S2     (LOCK_S1 + 7 * 96)
+#define LOCK_S2_N   (8 * 256)
+
+typedef struct {
+    int64_t     first, last;            //  cycles of first, last difference
+    int64_t     ncyc;                   //  cycles with a difference
+    int64_t     bits;                   //  differing bits, summed
+    bool        on;                     //  differs in the current cycle
+} lock_sig_t;
+
+static struct {
+    Vmldsa_wrap *b;                     //  second model
+    const uint8_t *base;                //  its root object
+    const char  *field;                 //  rnd, ent, s1:<i>, s2:<i>
+    const char  *val;                   //  after '=', or NULL
+    uint32_t    lo, hi;                 //  bus address range of the field
+    const uint32_t *src;                //  the first model's input buffer
+    std::vector<uint32_t> buf;          //  the second model's copy
+    bool        ready;                  //  buf made
+    bool        sub;                    //  hwdata is from buf
+    uint64_t    hwdata;
+    std::vector<size_t> r0;             //  first member of each region
+    std::vector<lock_sig_t> sig;        //  per member of state.mem
+    std::vector<size_t> cur;            //  members differing now
+    FILE        *out;                   //  per-cycle log
+    int64_t     ncyc, nbits;            //  cycles, bits with a difference
+    int64_t     first;
+} lock;
+
+//  field of the first model's inputs; returns 0 if op uses it
+
+static int lock_field(const char *spec, int op, uint32_t *rnd_in,
+                        uint32_t *ent_in, uint32_t *sk_in)
+{
+    static char name[32];
+    const char  *p;
+    char        *end;
+    long        k, v;
+
+    p = strchr(spec, '=');
+    lock.val = p != NULL ? p + 1 : NULL;
+    snprintf(name, sizeof(name), "%.*s",
+                p != NULL ? (int) (p - spec) : (int) strlen(spec), spec);
+    lock.field = name;
+
+    if (strcmp(name, "rnd") == 0 && (op == 200 || op == 400)) {
+        lock.lo     = MLDSA_SIGN_RND;
+        lock.hi     = MLDSA_SIGN_RND + MLDSA_SIGN_RND_SZ;
+        lock.src    = rnd_in;
+    } else if (strcmp(name, "ent") == 0 && op != 300) {
+        lock.lo     = MLDSA_ENTROPY;
+        lock.hi     = MLDSA_ENTROPY + MLDSA_ENTROPY_SZ;
+        lock.src    = ent_in;
+    } else if ((strncmp(name, "s1:", 3) == 0 ||
+                strncmp(name, "s2:", 3) == 0) && op == 200) {
+        lock.lo     = MLDSA_PRIVKEY_IN;
+        lock.hi     = MLDSA_PRIVKEY_IN + PRIVKEY_SZ;
+        lock.src    = sk_in;
+        k = strtol(name + 3, &end, 0);
+        if (name[3] == '\0' || *end != '\0')
+            return -1;
+        v = 0;
+        if (lock.val != NULL) {
+            v = strtol(lock.val, &end, 0);
+            if (lock.val[0] == '\0' || *end != '\0')
+                return -1;
+        }
+        return k >= 0 && k < (name[1] == '1' ? LOCK_S1_N : LOCK_S2_N) &&
+                v >= -LOCK_ETA && v <= LOCK_ETA ? 0 : -1;
+    } else {
+        return -1;
+    }
+    return lock.val == NULL ||
+            (strspn(lock.val, "0123456789abcdefABCDEF") ==
+                2 * (lock.hi - lock.lo) &&
+            lock.val[2 * (lock.hi - lock.lo)] == '\0') ? 0 : -1;
+}
+
+//  the second model's copy of the field, once the first one is read
+
+static void lock_make(void)
+{
+    size_t  sz = lock.hi - lock.lo, i;
+    uint8_t *p;
+    int     a, b, c, d, j;
+    long    k;
+    size_t  bit;
+
+    lock.buf.assign(lock.src, lock.src + (sz + 3) / 4);
+    p = (uint8_t *) lock.buf.data();
+    lock.ready = true;
+
+    //  secret coefficient k of s1 or s2: 3 bits of eta - c
+    if (lock.field[0] == 's') {
+        k = strtol(lock.field + 3, NULL, 0);
+        bit = 8 * (lock.field[1] == '1' ? LOCK_S1 : LOCK_S2) + 3 * k;
+        c = 0;
+        for (j = 0; j < 3; j++)
+            c |= ((p[(bit + j) >> 3] >> ((bit + j) & 7)) & 1) << j;
+        c = LOCK_ETA - c;
+        d = lock.val != NULL ? atoi(lock.val) :
+                c < LOCK_ETA ? c + 1 : -LOCK_ETA;
+        for (j = 0; j < 3; j++) {
+            p[(bit + j) >> 3] &= ~(1 << ((bit + j) & 7));
+            p[(bit + j) >> 3] |= (((LOCK_ETA - d) >> j) & 1) << ((bit + j) & 7);
+        }
+        printf("[LOCK]\t%s: %d -> %d\n", lock.field, c, d);
+        return;
+    }
+
+    //  rnd, ent: hex value, or the first bit flipped
+    if (lock.val == NULL) {
+        p[0] ^= 1;
+    } else {
+        for (i = 0; i < sz; i++) {
+            a = hex_nib(lock.val[2 * i]);
+            b = hex_nib(lock.val[2 * i + 1]);
+            p[i] = (a << 4) | b;
+        }
+    }
+    printf("[LOCK]\t%s: ", lock.field);
+    dump_hex(p, sz);
+}
+
+static int lock_init(const STATE_ROOT *root, const char *sel_fn,
+                        const char *log_fn)
+{
+    size_t  nsel;
+
+    if (log_fn != NULL) {
+        lock.out = fopen(log_fn, "w");
+        if (lock.out == NULL) {
+            perror(log_fn);
+            return -1;
+        }
+    }
+    lock.b = new Vmldsa_wrap(new VerilatedContext);
+    lock.base = (const uint8_t *) lock.b->rootp;
+
+    //  shares the -state table and selection
+    if (state.mem.empty())
+        nsel = state_table(root, sel_fn);
+    else
+        nsel = std::count_if(state.mem.begin(), state.mem.end(),
+                                [](const state_mem_t &m) { return m.on; });
+    for (auto &r : state.reg) {
+        lock.r0.push_back(std::lower_bound(state.mem.begin(),
+                            state.mem.end(), r.off,
+                            [](const state_mem_t &m, size_t off) {
+                                return m.off < off; }) - state.mem.begin());
+    }
+    lock.sig.assign(state.mem.size(), lock_sig_t { -1, -1, 0, 0, false });
+    lock.first = -1;
+    printf("[INIT]\tlock: %s, %zu members, %zu regions\n",
+            lock.field, nsel, state.reg.size());
+    return 0;
+}
+
+//  differing bits of two byte ranges
+
+static int64_t lock_hd(const uint8_t *p, const uint8_t *q, size_t len)
+{
+    int64_t hd = 0;
+    uint64_t a, b;
+    size_t  i;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        memcpy(&a, p + i, 8);
+        memcpy(&b, q + i, 8);
+        hd += __builtin_popcountll(a ^ b);
+    }
+    for (; i < len; i++)
+        hd += __builtin_popcount(p[i] ^ q[i]);
+    return hd;
+}
+
+//  compare the two models; log members that start or stop differing
+
+static void lock_cmp(int64_t cycle)
+{
+    const uint8_t *pa = state.base, *pb = lock.base;
+    std::vector<size_t> now;
+    int64_t hd, bits = 0;
+    size_t  i, j;
+
+    for (i = 0; i < state.reg.size(); i++) {
+        const state_mem_t &r = state.reg[i];
+        if (memcmp(pa + r.off, pb + r.off, r.len) == 0)
+            continue;
+        for (j = lock.r0[i]; j < state.mem.size() &&
+                state.mem[j].off < r.off + r.len; j++) {
+            const state_mem_t &m = state.mem[j];
+            if (!m.on)
+                continue;
+            hd = lock_hd(pa + m.off, pb + m.off, m.len);
+            if (hd == 0)
+                continue;
+            lock_sig_t &s = lock.sig[j];
+            if (s.first < 0)
+                s.first = cycle;
+            s.last = cycle;
+            s.ncyc++;
+            s.bits += hd;
+            bits += hd;
+            if (!s.on && lock.out != NULL)
+                fprintf(lock.out, "#%8ld [ldon]  %s\n", cycle, m.name);
+            s.on = true;
+            now.push_back(j);
+        }
+    }
+    for (j = 0; j < lock.cur.size(); j++) {
+        lock_sig_t &s = lock.sig[lock.cur[j]];
+        if (s.last == cycle)
+            continue;
+        s.on = false;
+        if (lock.out != NULL)
+            fprintf(lock.out, "#%8ld [ldoff] %s\n", cycle,
+                    state.mem[lock.cur[j]].name);
+    }
+    lock.cur.swap(now);
+    if (bits == 0)
+        return;
+    if (lock.first < 0) {
+        lock.first = cycle;
+        printf("[LOCK]\t%ld\tfirst difference\n", cycle);
+    }
+    lock.ncyc++;
+    lock.nbits += bits;
+    if (lock.out != NULL)
+        fprintf(lock.out, "#%8ld [ldif]  %zu %ld\n",
+                cycle, lock.cur.size(), bits);
+}
+
+//  same inputs as the first model (but the field); eval and compare
+
+static void lock_eval(const Vmldsa_wrap *a, int64_t cycle)
+{
+    Vmldsa_wrap *b = lock.b;
+    uint32_t    x;
+
+    //  a write to the field: the word from our copy, until the next write
+    if (a->hsel_i && a->hwrite_i && a->htrans_i == 2) {
+        lock.sub = a->haddr_i >= lock.lo && a->haddr_i < lock.hi;
+        if (lock.sub) {
+            if (!lock.ready)
+                lock_make();
+            x = lock.buf[(a->haddr_i - lock.lo) / 4];
+            lock.hwdata = a->haddr_i & 4 ? ((uint64_t) x) << 32 : x;
+        }
+    }
+    b->clk      = a->clk;
+    b->rst_b    = a->rst_b;
+    b->haddr_i  = a->haddr_i;
+    b->hwdata_i = lock.sub ? lock.hwdata : a->hwdata_i;
+    b->hsel_i   = a->hsel_i;
+    b->hwrite_i = a->hwrite_i;
+    b->hready_i = a->hready_i;
+    b->htrans_i = a->htrans_i;
+    b->hsize_i  = a->hsize_i;
+
+    lock_in_b = true;
+    b->eval();
+    lock_in_b = false;
+    if (a->clk)
+        lock_cmp(cycle);
+}
+
+//  per signal and per scope: first, last, cycles, bit-cycles, signals
+
+static void lock_report(const char *fn)
+{
+    typedef struct {
+        int64_t first, last, ncyc, bits, nsig;
+    } lock_agg_t;
+    std::map<std::string, lock_agg_t> agg;
+    std::string name;
+    size_t  i, l;
+    FILE    *fp;
+
+    for (i = 0; i < state.mem.size(); i++) {
+        const lock_sig_t &s = lock.sig[i];
+        if (s.ncyc == 0)
+            continue;
+        name = state.mem[i].name;
+        for (l = 0; l != std::string::npos; l = name.find('.', l + 1)) {
+            auto r = agg.emplace(l > 0 ? name.substr(0, l) : name,
+                        lock_agg_t { s.first, s.last, 0, 0, 0 });
+            lock_agg_t &x = r.first->second;
+            x.first = std::min(x.first, s.first);
+            x.last  = std::max(x.last, s.last);
+            x.ncyc  += s.ncyc;
+            x.bits  += s.bits;
+            x.nsig++;
+        }
+    }
+    printf("[LOCK]\t%zu scopes and signals differed in %ld cycles, "
+            "%ld bit-cycles\n", agg.size(), lock.ncyc, lock.nbits);
+
+    fp = fopen(fn, "w");
+    if (fp == NULL) {
+        perror(fn);
+        return;
+    }
+    fprintf(fp, "#  first  last  cycles  bit_cycles  signals  name\n");
+    for (auto &x : agg) {
+        fprintf(fp, "%ld %ld %ld %ld %ld %s\n", x.second.first,
+                x.second.last, x.second.ncyc, x.second.bits,
+                x.second.nsig, x.first.c_str());
+    }
+    fclose(fp);
+    printf("[SAVE]\t%s (%zu lines)\n", fn, agg.size());
+}
+
+//  === run metrics
+
+//  Wall time of the main loop is split into the model eval(), the trace
+//  dump (or state diff) and the harness code between evals. It is kept
+//  per main_fsm state and by what the host side is doing in the cycle:
+//  stepping, moving data (xfer fsm) or polling status; a transfer or a
+//  wait is charged to the state that started it. Written at exit.
+
+#define MET_FSM     512                 //  main_fsm states, mod
+#define MET_PROG_NS 250000000           //  progress display interval
+
+enum { MET_STEP, MET_XFER, MET_WAIT, MET_CLS };
+static const char *met_cls[MET_CLS] = { "step", "xfer", "wait" };
+
+typedef struct {
+    int64_t     cyc;                    //  full cycles
+    uint64_t    eval, dump, host;       //  nanoseconds
+} met_t;
+
+static struct {
+    bool        on;
+    met_t       ph[MET_FSM][MET_CLS];
+} met;
+
+static inline uint64_t met_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//  size of a trace file, 0 if none
+
+static uint64_t met_size(const char *fn)
+{
+    struct stat sb;
+
+    if (fn == NULL || stat(fn, &sb) != 0)
+        return 0;
+    return sb.st_size;
+}
+
+//  one JSON record per run
+
+static void met_write(const char *fn, const char *op, bool done,
+                        int64_t cycle, double sec, uint64_t bytes)
+{
+    FILE *fp;
+    char host[256];
+    uint64_t eval = 0, dump = 0, hns = 0;
+    const met_t *m;
+    int i, j, n;
+
+    fp = fopen(fn, "w");
+    if (fp == NULL) {
+        perror(fn);
+        return;
+    }
+    if (gethostname(host, sizeof(host)) != 0)
+        strcpy(host, "?");
+    host[sizeof(host) - 1] = 0;
+
+    for (i = 0; i < MET_FSM; i++) {
+        for (j = 0; j < MET_CLS; j++) {
+            m = &met.ph[i][j];
+            eval += m->eval;
+            dump += m->dump;
+            hns += m->host;
+        }
+    }
+
+    fprintf(fp, "{\n\t\"host\": \"%s\",\n\t\"op\": \"%s\",\n"
+                "\t\"done\": %s,\n\t\"cycles\": %ld,\n"
+                "\t\"sec\": %.6f,\n\t\"cycles_per_s\": %.0f,\n"
+                "\t\"trace_bytes\": %lu,\n",
+            host, op, done ? "true" : "false", cycle,
+            sec, sec > 0.0 ? cycle / sec : 0.0, (unsigned long) bytes);
+    fprintf(fp, "\t\"eval_s\": %.6f,\n\t\"dump_s\": %.6f,\n"
+                "\t\"host_s\": %.6f,\n\t\"phases\": [",
+            1E-9 * eval, 1E-9 * dump, 1E-9 * hns);
+
+    n = 0;
+    for (i = 0; i < MET_FSM; i++) {
+        for (j = 0; j < MET_CLS; j++) {
+            m = &met.ph[i][j];
+            if (m->cyc == 0 && m->eval == 0)
+                continue;
+            fprintf(fp, "%s\n\t\t{ \"fsm\": %d, \"what\": \"%s\", "
+                        "\"cycles\": %ld, \"eval_s\": %.6f, "
+                        "\"dump_s\": %.6f, \"host_s\": %.6f }",
+                    n++ ? "," : "", i, met_cls[j], m->cyc,
+                    1E-9 * m->eval, 1E-9 * m->dump, 1E-9 * m->host);
+        }
+    }
+    fprintf(fp, "\n\t]\n}\n");
+    fclose(fp);
+    printf("[SAVE]\t%s\n", fn);
+}
+
 const char usage[] =
     "USAGE: mldsa_wrap [options] [operation]\n\n"
     "Operation is one of: keygen, sign, verify, kgsign\n\n"
     "Options (with default values):\n"
     "\t-t\t<n>\ttimeout in cycles (none)\n"
     "\t-vcd\t<fn>\tvcd output file (trace.vcd)\n"
+    "\t-fst\t<fn>\tfst output file, FST=1 builds (trace.fst)\n"
+    "\t-edge\t\tvcd/fst: one dump per cycle, after the posedge;\n"
+    "\t\t\tread with readvcd -e -clk <clock nets>\n"
     "\t-pk\t<fn>\tpublic/verification key (pk_in.dat, pk_out.dat)\n"
     "\t-sk\t<fn>\tprivate/signing key (sk_in.dat, sk_out.dat)\n"
     "\t-sig\t<fn>\tsignature (sig_in.dat, sig_out.dat)\n"
@@ -156,7 +1384,28 @@ const char usage[] =
     "\t-seed\t<fn>\tkey generation seed (seed_in.dat)\n"
     "\t-rnd\t<fn>\tsigning rnd input (rnd_in.dat)\n"
     "\t-ent\t<fn>\tsigning sca entropy input (ent_in.dat)\n"
-    "\t-vfy\t<fn>\tverify result output block (none)\n";
+    "\t-vfy\t<fn>\tverify result output block (none)\n"
+    "\t-shm\t<name>\tpublish per-cycle records to a shared-memory ring\n"
+    "\t\t\t(toggles from model state, as -state)\n"
+    "\t-shmsig\t<fn>\tring: add per-signal diffs; write signal table\n"
+    "\t\t\t(toggles from an in-process vcd parse instead)\n"
+    "\t-shmwait\t<n>\tring: wait for n lossless readers (0)\n"
+    "\t-state\t<fn>\ttoggle log from model state diffs (no tracing)\n"
+    "\t-statesel <fn>\tstate: +/- signal prefixes to count (all)\n"
+    "\t-sram\t<fn>\tsram table; with -state also access columns\n"
+    "\t-sramlog <fn>\tsram: per-cycle counts of each instance\n"
+    "\t-fault\t<fn>\tfault campaign: <signal>[bit] <cycle|p<a>+n|s<a>+n> "
+                                                        "<flip|sa0|sa1>\n"
+    "\t-fres\t<fn>\tfault: outcome of each fault (fault_res.txt)\n"
+    "\t-fj\t<n>\tfault: parallel faulty runs (cpus)\n"
+    "\t-ft\t<n>\tfault: cycles after injection until hang (1000000)\n"
+    "\t-sess\t<fn>\tsign/verify session: key once, per-line hex inputs\n"
+    "\t-sres\t<fn>\tsession: result per operation (sess_res.txt)\n"
+    "\t-lock\t<f[=v]>\tlockstep with a second model; input field differs:\n"
+    "\t\t\trnd, ent (=hex), s1:<i>, s2:<i> (=coefficient)\n"
+    "\t-llog\t<fn>\tlockstep: per-cycle differences (lock_log.txt)\n"
+    "\t-lres\t<fn>\tlockstep: per-signal and per-scope totals (lock_res.txt)\n"
+    "\t-metrics <fn>\tJSON record of time per phase and fsm state (none)\n";
 
 //  how many 32-bit words needed for x bytes
 #define SZ_U32(x)  (((x) + 3) / 4)
@@ -165,6 +1414,7 @@ int main(int argc, char **argv)
 {
     //  default file names
     const char  *vcd_out_fn     = NULL; //  "trace.vcd";
+    const char  *fst_out_fn     = NULL; //  "trace.fst";
     const char  *seed_in_fn     = "seed_in.dat";
     const char  *hash_in_fn     = "hash_in.dat";
     const char  *ent_in_fn      = "ent_in.dat";
@@ -176,6 +1426,23 @@ int main(int argc, char **argv)
     const char  *sig_in_fn      = "sig_in.dat";
     const char  *sig_out_fn     = "sig_out.dat";
     const char  *vfy_out_fn     = NULL; //  "vfy_out.dat";
+    const char  *shm_name       = NULL; //  "/abr-sim";
+    const char  *shm_sig_fn     = NULL; //  "sig_table.txt";
+    int         shm_wait        = 0;
+    const char  *state_fn       = NULL; //  "trace.log";
+    const char  *state_sel_fn   = NULL; //  "state.sel";
+    const char  *sram_fn        = NULL; //  "sram.txt";
+    const char  *sram_log_fn    = NULL; //  "sram.log";
+    const char  *met_fn         = NULL; //  "metrics.json";
+    const char  *flt_fn         = NULL; //  "faults.txt";
+    const char  *flt_res_fn     = "fault_res.txt";
+    int64_t     flt_timeout     = 1000000;
+    const char  *sess_fn        = NULL; //  "session.txt";
+    const char  *sess_res_fn    = "sess_res.txt";
+    const char  *lock_spec      = NULL; //  "rnd";
+    const char  *lock_log_fn    = "lock_log.txt";
+    const char  *lock_res_fn    = "lock_res.txt";
+    const char  *op_name        = "none";
 
     //  buffers
     uint32_t    pk_in[      SZ_U32( PUBKEY_SZ )         ] = { 0 };
@@ -193,6 +1460,7 @@ int main(int argc, char **argv)
 
     int64_t     max_cycle   = 0;
     bool        get_cycle   = false;
+    bool        edge        = false;
     int         main_op     = -1;
     int         i;
 
@@ -214,6 +1482,11 @@ int main(int argc, char **argv)
             i += 2;
             continue;
 
+        } else if (i + 1 < argc && strcmp(argv[i], "-fst") == 0) {
+            fst_out_fn = argv[i + 1];
+            i += 2;
+            continue;
+
         } else if (i + 1 < argc && strcmp(argv[i], "-pk") == 0) {
             pk_in_fn = pk_out_fn = argv[i + 1];
             i += 2;
@@ -249,28 +1522,123 @@ int main(int argc, char **argv)
             i += 2;
             continue;
 
+        } else if (i + 1 < argc && strcmp(argv[i], "-shm") == 0) {
+            shm_name = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-shmsig") == 0) {
+            shm_sig_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-shmwait") == 0) {
+            shm_wait = atoi(argv[i + 1]);
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-state") == 0) {
+            state_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-statesel") == 0) {
+            state_sel_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-sram") == 0) {
+            sram_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-sramlog") == 0) {
+            sram_log_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-fault") == 0) {
+            flt_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-fres") == 0) {
+            flt_res_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-fj") == 0) {
+            flt.jobs = atoi(argv[i + 1]);
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-ft") == 0) {
+            flt_timeout = strtoll(argv[i + 1], NULL, 0);
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-sess") == 0) {
+            sess_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-sres") == 0) {
+            sess_res_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-lock") == 0) {
+            lock_spec = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-llog") == 0) {
+            lock_log_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-lres") == 0) {
+            lock_res_fn = argv[i + 1];
+            i += 2;
+            continue;
+
+        } else if (i + 1 < argc && strcmp(argv[i], "-metrics") == 0) {
+            met_fn = argv[i + 1];
+            i += 2;
+            continue;
+
         } else if (i + 1 < argc && strcmp(argv[i], "-hash") == 0) {
             hash_in_fn = argv[i + 1];
             i += 2;
             continue;
 
+        //  flags
+        } else if (strcmp(argv[i], "-edge") == 0) {
+            edge = true;
+            i++;
+            continue;
+
         //  operations have no parameters
         } else if (strcmp(argv[i], "keygen") == 0) {
+            op_name   = argv[i];
             main_op   = 100;
             i++;
             continue;
 
         } else if (strcmp(argv[i], "sign") == 0) {
+            op_name   = argv[i];
             main_op   = 200;
             i++;
             continue;
 
         } else if (strcmp(argv[i], "verify") == 0) {
+            op_name   = argv[i];
             main_op   = 300;
             i++;
             continue;
 
         } else if (strcmp(argv[i], "kgsign") == 0) {
+            op_name   = argv[i];
             main_op   = 400;
             i++;
             continue;
@@ -308,39 +1676,261 @@ int main(int argc, char **argv)
     uint32_t    xfer_stop   = 0;
     uint32_t    *xfer_data  = NULL;
 
+    //  before the first eval (instances register in initial blocks)
+    sram.on = sram_fn != NULL || sram_log_fn != NULL;
+    sram.cyc = -1;
+    if (sram_log_fn != NULL) {
+        sram.log = fopen(sram_log_fn, "w");
+        if (sram.log == NULL) {
+            perror(sram_log_fn);
+            return 1;
+        }
+        fprintf(sram.log, "#       c [sram]  id rd wr hdw hdr\n");
+    }
+
+    //  session inputs per operation: sign (hash, rnd, ent), verify (hash, sig)
+    void * const    sign_buf[]  = { hash_in, rnd_in, ent_in };
+    const size_t    sign_len[]  = { MLDSA_MSG_SZ, MLDSA_SIGN_RND_SZ,
+                                    MLDSA_ENTROPY_SZ };
+    void * const    vrfy_buf[]  = { hash_in, sig_in };
+    const size_t    vrfy_len[]  = { MLDSA_MSG_SZ, SIGNATURE_SZ };
+
+    if (sess_fn != NULL) {
+        if (main_op != 200 && main_op != 300) {
+            fprintf(stderr, "%s: -sess is for sign or verify\n", argv[0]);
+            return 1;
+        }
+        sess.in = fopen(sess_fn, "r");
+        if (sess.in == NULL) {
+            perror(sess_fn);
+            return 1;
+        }
+        sess.out = fopen(sess_res_fn, "w");
+        if (sess.out == NULL) {
+            perror(sess_res_fn);
+            return 1;
+        }
+        sig_out_fn  = NULL;             //  results go to the record
+        vfy_out_fn  = NULL;
+    }
+
+    //  faulty runs must not write traces or logs of their own
+    if (flt_fn != NULL && (vcd_out_fn != NULL || fst_out_fn != NULL ||
+            shm_name != NULL || state_fn != NULL || sess_fn != NULL ||
+            sram_log_fn != NULL)) {
+        fprintf(stderr, "%s: -fault runs without -vcd, -fst, -shm, -state, "
+                "-sramlog, -sess\n", argv[0]);
+        return 1;
+    }
+
+    //  lockstep: one run, inputs only from files
+    if (lock_spec != NULL) {
+        if (flt_fn != NULL || sess_fn != NULL) {
+            fprintf(stderr, "%s: -lock runs without -fault, -sess\n",
+                    argv[0]);
+            return 1;
+        }
+        if (lock_field(lock_spec, main_op, rnd_in, ent_in, sk_in) != 0) {
+            fprintf(stderr, "%s: -lock %s: not an input of %s, "
+                    "or a bad value\n", argv[0], lock_spec, op_name);
+            return 1;
+        }
+    }
+
+    //  the in-process ring parser reads both edges
+    if (edge && shm_sig_fn != NULL && state_fn == NULL) {
+        fprintf(stderr, "%s: -edge is for -vcd and -fst, not -shmsig\n",
+                argv[0]);
+        return 1;
+    }
+
+    //  a model traces in one format only
+#ifdef PRESI_FST
+    if (vcd_out_fn != NULL || (shm_sig_fn != NULL && state_fn == NULL)) {
+        fprintf(stderr, "%s: FST build: use -fst; -shmsig needs vcd\n",
+                argv[0]);
+        return 1;
+    }
+#else
+    if (fst_out_fn != NULL) {
+        fprintf(stderr, "%s: -fst needs a model built with FST=1\n",
+                argv[0]);
+        return 1;
+    }
+#endif
+
     //  trace on
     Vmldsa_wrap* mldsa_wrap = new Vmldsa_wrap;
+#ifdef PRESI_FST
+    VerilatedFstC* tfp = NULL;
+#else
     VerilatedVcdC* tfp = NULL;
+    ShmVcdFile* shm_file = NULL;
+#endif
+
+    if (shm_name != NULL) {
+        shm.ring = shmr_create(shm_name, SHMR_SIZE_DEF, shm_wait);
+        if (shm.ring == NULL)
+            return 1;
+        printf("[INIT]\tring %s (%lu bytes)\n", shm_name, shm.ring->size);
+        shmr_wait_readers(shm.ring);
+    }
+
+    //  toggles from model state; the ring needs the vcd parser only for
+    //  per-signal diffs, which refer to vcd signals
+    if (state_fn != NULL || (shm.ring != NULL && shm_sig_fn == NULL)) {
+        if (state_fn != NULL) {
+            state.out = fopen(state_fn, "w");
+            if (state.out == NULL) {
+                perror(state_fn);
+                return 1;
+            }
+            if (shm_sig_fn != NULL)
+                fprintf(stderr, "%s: -shmsig ignored with -state\n",
+                        argv[0]);
+        }
+        state_init(mldsa_wrap->rootp, state_sel_fn);
+        state.on = true;
+    }
+#ifndef PRESI_FST
+    else if (shm.ring != NULL) {
+
+        //  every cycle is published; no threshold
+        vcd_str_init(&shm.st, shm_name, NULL, "dec_prim.cyc", 0, NULL);
+        shm.st.cyc_fn = shm_cyc;
+        shm.sig = shm_sig_fn != NULL;
+        if (shm.sig)
+            shm.st.sig_fn = shm_sig;
+
+        shm_file = new ShmVcdFile;
+        shm_file->tee = vcd_out_fn != NULL;
+    }
 
-    if (vcd_out_fn != NULL) {
+    if (vcd_out_fn != NULL || shm_file != NULL) {
+        Verilated::traceEverOn(true);
+        tfp = new VerilatedVcdC(shm_file);
+        mldsa_wrap->trace(tfp, 99);
+        tfp->open(vcd_out_fn != NULL ? vcd_out_fn : "/dev/null");
+    }
+#else
+    if (fst_out_fn != NULL) {
         Verilated::traceEverOn(true);
-        tfp = new VerilatedVcdC;
+        tfp = new VerilatedFstC;
         mldsa_wrap->trace(tfp, 99);
-        tfp->open(vcd_out_fn);
+        tfp->open(fst_out_fn);
+    }
+#endif
+    if (tfp != NULL && edge)
+        printf("[INIT]\tedge: one dump per cycle\n");
+
+    //  second model; after -state, whose member table it shares
+    if (lock_spec != NULL &&
+        lock_init(mldsa_wrap->rootp, state_sel_fn, lock_log_fn) != 0)
+        return 1;
+
+    //  fault campaign: the golden run forks the faulty ones
+    if (flt_fn != NULL) {
+        if (flt_load(flt_fn, mldsa_wrap->rootp) < 0)
+            return 1;
+        flt.res = (flt_res_t *) mmap(NULL,
+                    (flt.flt.size() + 1) * sizeof(flt_res_t),
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (flt.res == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+        if (flt.jobs <= 0)
+            flt.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+        flt.on = true;
+        flt_trig_on = !flt.trig.empty();
+        printf("[INIT]\tfaults: %zu from %s, %d jobs\n",
+                flt.flt.size(), flt_fn, flt.jobs);
     }
 
     ahb_clear(mldsa_wrap);
 
+    //  simulation speed, reported at exit
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    //  phase timing
+    met.on = met_fn != NULL;
+    met_t       *m          = NULL;
+    int         met_fsm     = 0;        //  state that issued xfer / wait
+    uint64_t    t_a         = 0;
+    uint64_t    t_b         = 0;
+    uint64_t    t_c         = 0;
+    uint64_t    t_prog      = 0;
+
     while (main_fsm >= 0 && !Verilated::gotFinish()) {
         hclk++;
         mldsa_wrap->clk = !mldsa_wrap->clk;
 
+        //  harness time since the last eval goes to the previous phase
+        if (met.on) {
+            t_a = met_ns();
+            if (m != NULL)
+                m->host += t_a - t_c;
+            if (xfer_fsm == 0 && wait_ready == 0)
+                met_fsm = main_fsm;
+            m = &met.ph[(unsigned) met_fsm % MET_FSM][
+                    xfer_fsm ? MET_XFER : wait_ready ? MET_WAIT : MET_STEP];
+        }
+
         //  Evaluate model
         mldsa_wrap->eval();
-        if  (vcd_out_fn != NULL && dump_trace) {
+        if (flt.stuck)
+            flt_apply(&flt.flt[flt.k]);
+        if (lock.b != NULL)
+            lock_eval(mldsa_wrap, cycle);
+        if (met.on)
+            t_b = met_ns();
+        if  (tfp != NULL && dump_trace && (mldsa_wrap->clk || !edge)) {
             tfp->dump(5 * hclk);
         }
+        if (state.on && dump_trace) {
+            state_step(mldsa_wrap->rootp, cycle);
+        }
+        if (sram.log != NULL && dump_trace) {
+            sram_step(STATE_CYC(mldsa_wrap->rootp) >= 0 ?
+                        STATE_CYC(mldsa_wrap->rootp) : cycle);
+        }
+        if (met.on) {
+            t_c = met_ns();
+            m->eval += t_b - t_a;
+            m->dump += t_c - t_b;
+        }
         if (mldsa_wrap->clk)
             continue;
 
         cycle++;
+        if (m != NULL)
+            m->cyc++;
         if (max_cycle > 0 && cycle > max_cycle)
             break;
 
-        //  progress..
-        if ((cycle % 100) == 0) {
-            printf(" %ld \r", cycle);
-            fflush(stdout);
+        //  fault campaign; a child keeps no outputs and has its own timeout
+        if (flt.on) {
+            flt.cyc = cycle;
+            if (flt_fork(cycle)) {
+                sk_out_fn   = NULL;
+                pk_out_fn   = NULL;
+                sig_out_fn  = NULL;
+                vfy_out_fn  = NULL;
+                max_cycle   = cycle + flt_timeout;
+            }
+        } else if (flt.child && mldsa_wrap->error_intr) {
+            flt.res[flt.k].err = 1;
+        }
+
+        //  progress, a few times a second
+        if ((cycle & 0xFF) == 0) {
+            t_a = met_ns();
+            if (t_a - t_prog >= MET_PROG_NS) {
+                printf(" %ld \r", cycle);
+                fflush(stdout);
+                t_prog = t_a;
+            }
         }
 
         //  "ahb" data transfer fsm
@@ -517,6 +2107,13 @@ int main(int argc, char **argv)
             case 200:
                 printf("[INIT]\tsign\n");
 
+                //  session: only the key from a file
+                if (sess.in != NULL) {
+                    read_fn(sk_in, sizeof(sk_in), sk_in_fn);
+                    main_fsm = sess_read(sign_buf, sign_len, 3) > 0 ? 201 : -1;
+                    break;
+                }
+
                 //  message hash
                 read_fn(hash_in, sizeof(hash_in), hash_in_fn);
 
@@ -542,6 +2139,10 @@ int main(int argc, char **argv)
                 break;
 
             case 202:       //  sign: write secret key to device
+                if (sess.key) {
+                    main_fsm++;
+                    break;
+                }
                 xfer_write  = true;
                 xfer_addr   = MLDSA_PRIVKEY_IN;
                 xfer_stop   = MLDSA_PRIVKEY_IN + PRIVKEY_SZ;
@@ -570,6 +2171,7 @@ int main(int argc, char **argv)
 
             case 205:       //  sign: start signing operation
                 printf("[SIGN]\t%ld\tstart\n", cycle);
+                sess.c0     = cycle;
                 dump_trace  = true;
                 ahb_write(mldsa_wrap, MLDSA_CTRL, CTRL_SIGN);
                 wait_ready  = 1;
@@ -590,6 +2192,12 @@ int main(int argc, char **argv)
             case 207:       //  sign: save signature
                 write_fn(sig_out, SIGNATURE_SZ, sig_out_fn);
                 main_fsm    = -1;   //  done
+                if (sess.in != NULL) {
+                    sess_put(cycle, NULL, sig_out, SIGNATURE_SZ);
+                    sess.key = true;
+                    if (sess_read(sign_buf, sign_len, 3) > 0)
+                        main_fsm = 201;
+                }
                 break;
 
             //  === verify
@@ -597,6 +2205,13 @@ int main(int argc, char **argv)
             case 300:
                 printf("[INIT]\tverify\n");
 
+                //  session: only the key from a file
+                if (sess.in != NULL) {
+                    read_fn(pk_in, sizeof(pk_in), pk_in_fn);
+                    main_fsm = sess_read(vrfy_buf, vrfy_len, 2) > 0 ? 301 : -1;
+                    break;
+                }
+
                 //  message hash
                 read_fn(hash_in, sizeof(hash_in), hash_in_fn);
 
@@ -619,6 +2234,10 @@ int main(int argc, char **argv)
                 break;
 
             case 302:       //  verify: write public key to device
+                if (sess.key) {
+                    main_fsm++;
+                    break;
+                }
                 xfer_write  = true;
                 xfer_addr   = MLDSA_PUBKEY;
                 xfer_stop   = MLDSA_PUBKEY + PUBKEY_SZ;
@@ -638,6 +2257,7 @@ int main(int argc, char **argv)
 
             case 304:       //  verify: start verification operation
                 printf("[VRFY]\t%ld\tstart\n", cycle);
+                sess.c0     = cycle;
                 ahb_write(mldsa_wrap, MLDSA_CTRL, CTRL_VERIFY);
                 wait_ready  = 1;
                 main_fsm++;
@@ -661,6 +2281,14 @@ int main(int argc, char **argv)
                     printf("[INFO]\tSignature verify BAD\n");
                 }
                 main_fsm    = -1;   //  done
+                if (sess.in != NULL) {
+                    sess_put(cycle, memcmp(vfy_out, sig_in,
+                                MLDSA_VERIFY_RES_SZ) == 0 ? "OK" : "BAD",
+                                NULL, 0);
+                    sess.key = true;
+                    if (sess_read(vrfy_buf, vrfy_len, 2) > 0)
+                        main_fsm = 301;
+                }
                 break;
 
             //  === kg + sign
@@ -751,14 +2379,76 @@ int main(int argc, char **argv)
                 break;
         }
     }
+
+    //  outputs, for fault classification
+    uint64_t out_h = 0xCBF29CE484222325;
+    out_h = flt_hash(out_h, sk_out, sizeof(sk_out));
+    out_h = flt_hash(out_h, pk_out, sizeof(pk_out));
+    out_h = flt_hash(out_h, sig_out, sizeof(sig_out));
+    out_h = flt_hash(out_h, vfy_out, sizeof(vfy_out));
+
+    if (flt.child) {
+        flt_res_t *r = &flt.res[flt.k];
+        r->fin  = main_fsm < 0;
+        r->cyc  = cycle - flt.flt[flt.k].cyc;
+        r->hash = out_h;
+        r->done = 1;
+        _exit(0);
+    }
     printf("[EXIT]\t%ld\n", cycle);
 
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (t1.tv_sec - t0.tv_sec) + 1E-9 * (t1.tv_nsec - t0.tv_nsec);
+    printf("[TIME]\t%ld\t%.3f s\t%.0f cycles/s\n",
+            cycle, sec, sec > 0.0 ? cycle / sec : 0.0);
+
     //  Final model cleanup
     mldsa_wrap->final();
 
     if (tfp != NULL) {
         tfp->close();
     }
+    if (state.on) {
+        state_emit();
+        if (state.out != NULL)
+            fclose(state.out);
+    }
+    if (sram.log != NULL) {
+        sram_emit();
+        fclose(sram.log);
+    }
+    if (sram_fn != NULL) {
+        sram_table(sram_fn);
+    }
+    if (flt.on) {
+        flt_report(flt_res_fn, out_h);
+    }
+    if (lock.b != NULL) {
+        lock.b->final();
+        if (lock.out != NULL)
+            fclose(lock.out);
+        lock_report(lock_res_fn);
+        delete lock.b;
+    }
+    if (sess.in != NULL) {
+        fclose(sess.in);
+        fclose(sess.out);
+        printf("[SAVE]\t%s (%ld operations)\n", sess_res_fn, sess.n);
+    }
+    if (met_fn != NULL) {
+        uint64_t bytes = met_size(vcd_out_fn) + met_size(fst_out_fn) +
+                            met_size(state_fn);
+#ifndef PRESI_FST
+        if (shm_file != NULL && !shm_file->tee)
+            bytes = shm_file->bytes;
+#endif
+        met_write(met_fn, op_name, main_fsm < 0, cycle, sec, bytes);
+    }
+    if (shm.ring != NULL) {
+        shm_sig_table(shm_sig_fn);
+        shmr_close(shm.ring, shm_name);
+        shm.ring = NULL;
+    }
 
     //  Destroy model
     delete mldsa_wrap;
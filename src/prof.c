@@ -0,0 +1,627 @@
+//  prof.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Per-phase latency profile of the sequencers from run logs.
+
+//  The sequencer hooks log "# cyc [prim] addr: NAME + k" when microcode
+//  step k of phase NAME (at program address addr) starts. A step lasts
+//  until the next tag of the same sequencer (the last one until [EXIT]).
+//  For each address the executions and their cycles are summed; for each
+//  phase the cycles and the visits (entries at +0, e.g. the rejection
+//  rounds of MLDSA_SIGN_MAKE_Y_S) of every run go into exact histograms.
+//  The profile is a text file that can be merged with other shards and
+//  compared with the profile of another build (phases by name, since the
+//  addresses move when the microcode changes).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#define PROF_NAME   40              //  phase name
+#define PROF_SEQ    2               //  [prim], [sec ]
+
+static const char *seq_tag[PROF_SEQ] = { "[prim]", "[sec ]" };
+static const char *seq_name[PROF_SEQ] = { "prim", "sec" };
+
+const char usage[] =
+    "Usage: prof [-o <out.prof>] <run.log[.gz] | dir> ..\n"
+    "       prof [-o <out.prof>] -m <in.prof> ..\n"
+    "       prof [-T <pct>] [-a] -d <a.prof> <b.prof>\n\n"
+    "Cycles and executions of each sequencer step and phase, from the tags\n"
+    "in run logs (or dir/run.log.gz); writes a profile (stdout by default).\n"
+    "-m merges profiles; -d compares build a with build b per phase.\n\n"
+    "\t-o\t<fn>\toutput file\n"
+    "\t-T\t<pct>\tdiff: slower by more than pct%% per visit is a\n"
+    "\t\t\tregression (default 1.0; exit status 2)\n"
+    "\t-a\t\tdiff: list unchanged phases and steps too\n";
+
+//  === exact histograms: sorted (value, count) pairs
+
+typedef struct {
+    int64_t     v;
+    uint64_t    n;
+} hbin_t;
+
+typedef struct {
+    hbin_t      *b;
+    size_t      nb, max;
+} hist_t;
+
+static void hist_add(hist_t *h, int64_t v, uint64_t n)
+{
+    size_t lo = 0, hi = h->nb, m;
+
+    while (lo < hi) {
+        m = (lo + hi) / 2;
+        if (h->b[m].v < v)
+            lo = m + 1;
+        else
+            hi = m;
+    }
+    if (lo < h->nb && h->b[lo].v == v) {
+        h->b[lo].n += n;
+        return;
+    }
+    if (h->nb == h->max) {
+        h->max = h->max > 0 ? 2 * h->max : 8;
+        h->b = (hbin_t *) realloc(h->b, h->max * sizeof(hbin_t));
+        if (h->b == NULL)
+            exit(-1);
+    }
+    memmove(h->b + lo + 1, h->b + lo, (h->nb - lo) * sizeof(hbin_t));
+    h->b[lo].v = v;
+    h->b[lo].n = n;
+    h->nb++;
+}
+
+static uint64_t hist_n(const hist_t *h)
+{
+    uint64_t n = 0;
+    size_t  i;
+
+    for (i = 0; i < h->nb; i++)
+        n += h->b[i].n;
+    return n;
+}
+
+static double hist_avg(const hist_t *h)
+{
+    double  s = 0.0;
+    uint64_t n = 0;
+    size_t  i;
+
+    for (i = 0; i < h->nb; i++) {
+        s += (double) h->b[i].v * h->b[i].n;
+        n += h->b[i].n;
+    }
+    return n > 0 ? s / n : 0.0;
+}
+
+static void hist_put(FILE *fp, const hist_t *h)
+{
+    size_t  i;
+
+    for (i = 0; i < h->nb; i++)
+        fprintf(fp, " %ld:%lu", h->b[i].v, h->b[i].n);
+    fprintf(fp, "\n");
+}
+
+//  " v:n v:n .."
+
+static void hist_get(hist_t *h, char *s)
+{
+    char    *p;
+    int64_t v;
+
+    for (;;) {
+        v = strtoll(s, &p, 10);
+        if (p == s || *p != ':')
+            break;
+        s = p + 1;
+        hist_add(h, v, strtoull(s, &p, 10));
+        s = p;
+    }
+}
+
+//  === profile
+
+typedef struct {
+    int         seq;
+    char        name[PROF_NAME];
+    hist_t      vis;                //  visits per run
+    hist_t      cyc;                //  cycles per run
+    uint64_t    run_vis;            //  current run
+    int64_t     run_cyc;
+    bool        run_on;
+} phase_t;
+
+typedef struct {
+    int         seq;
+    int         addr;
+    int         k;
+    size_t      ph;                 //  phase
+    uint64_t    cnt;                //  executions
+    int64_t     sum, min, max;      //  cycles of an execution
+} step_t;
+
+typedef struct {
+    uint64_t    runs;
+    hist_t      tot;                //  [EXIT] cycle of each run
+    phase_t     *ph;
+    size_t      n_ph, max_ph;
+    step_t      *st;
+    size_t      n_st, max_st;
+    size_t      *at[PROF_SEQ];      //  step index + 1 by address
+    size_t      n_at[PROF_SEQ];
+} prof_t;
+
+static size_t prof_phase(prof_t *pf, int seq, const char *name)
+{
+    size_t  i;
+
+    for (i = 0; i < pf->n_ph; i++) {
+        if (pf->ph[i].seq == seq && strcmp(pf->ph[i].name, name) == 0)
+            return i;
+    }
+    if (pf->n_ph == pf->max_ph) {
+        pf->max_ph = pf->max_ph > 0 ? 2 * pf->max_ph : 64;
+        pf->ph = (phase_t *) realloc(pf->ph, pf->max_ph * sizeof(phase_t));
+        if (pf->ph == NULL)
+            exit(-1);
+    }
+    memset(&pf->ph[i], 0, sizeof(phase_t));
+    pf->ph[i].seq = seq;
+    snprintf(pf->ph[i].name, PROF_NAME, "%s", name);
+    pf->n_ph++;
+    return i;
+}
+
+//  the step at an address (keyed by name and k as well; a merged profile
+//  of different builds may reuse an address)
+
+static size_t prof_step(prof_t *pf, int seq, int addr,
+                        const char *name, int k)
+{
+    step_t  *s;
+    size_t  i, n;
+
+    if (addr < 0)
+        addr = 0;
+    if ((size_t) addr >= pf->n_at[seq]) {
+        n = 2 * addr + 64;
+        pf->at[seq] = (size_t *) realloc(pf->at[seq], n * sizeof(size_t));
+        if (pf->at[seq] == NULL)
+            exit(-1);
+        memset(pf->at[seq] + pf->n_at[seq], 0,
+                (n - pf->n_at[seq]) * sizeof(size_t));
+        pf->n_at[seq] = n;
+    }
+    i = pf->at[seq][addr];
+    if (i > 0) {
+        s = &pf->st[i - 1];
+        if (s->k == k && strcmp(pf->ph[s->ph].name, name) == 0)
+            return i - 1;
+    }
+    for (i = 0; i < pf->n_st; i++) {
+        s = &pf->st[i];
+        if (s->seq == seq && s->addr == addr && s->k == k &&
+            strcmp(pf->ph[s->ph].name, name) == 0)
+            break;
+    }
+    if (i == pf->n_st) {
+        if (pf->n_st == pf->max_st) {
+            pf->max_st = pf->max_st > 0 ? 2 * pf->max_st : 256;
+            pf->st = (step_t *) realloc(pf->st,
+                                        pf->max_st * sizeof(step_t));
+            if (pf->st == NULL)
+                exit(-1);
+        }
+        s = &pf->st[i];
+        memset(s, 0, sizeof(step_t));
+        s->seq = seq;
+        s->addr = addr;
+        s->k = k;
+        s->ph = prof_phase(pf, seq, name);
+        s->min = INT64_MAX;
+        s->max = INT64_MIN;
+        pf->n_st++;
+    }
+    pf->at[seq][addr] = i + 1;
+    return i;
+}
+
+static void step_add(step_t *s, uint64_t cnt, int64_t sum,
+                        int64_t min, int64_t max)
+{
+    s->cnt += cnt;
+    s->sum += sum;
+    if (min < s->min)
+        s->min = min;
+    if (max > s->max)
+        s->max = max;
+}
+
+//  a step execution has ended
+
+static void prof_end(prof_t *pf, size_t i, int64_t dur)
+{
+    step_t  *s = &pf->st[i];
+    phase_t *ph = &pf->ph[s->ph];
+
+    step_add(s, 1, dur, dur, dur);
+    ph->run_on = true;
+    ph->run_cyc += dur;
+    if (s->k == 0)
+        ph->run_vis++;
+}
+
+//  one run log; 0 if it had tags
+
+static int prof_log(prof_t *pf, const char *fn)
+{
+    gzFile  gz;
+    char    buf[512], nm[PROF_NAME];
+    char    *p;
+    int64_t cyc, last[PROF_SEQ], ext = -1;
+    size_t  cur[PROF_SEQ], i;
+    int     seq, addr, k, n = 0;
+
+    gz = gzopen(fn, "r");
+    if (gz == NULL) {
+        perror(fn);
+        return -1;
+    }
+    for (seq = 0; seq < PROF_SEQ; seq++)
+        cur[seq] = SIZE_MAX;
+
+    //  tags may follow the progress counter on the same line
+    while (gzgets(gz, buf, sizeof(buf)) != NULL) {
+        if ((p = strstr(buf, "[EXIT]")) != NULL) {
+            ext = strtoll(p + 6, NULL, 10);
+            continue;
+        }
+        if ((p = strchr(buf, '#')) == NULL)
+            continue;
+        cyc = strtoll(p + 1, &p, 10);
+        while (*p == ' ')
+            p++;
+        for (seq = 0; seq < PROF_SEQ; seq++) {
+            if (strncmp(p, seq_tag[seq], 6) == 0)
+                break;
+        }
+        if (seq == PROF_SEQ ||
+            sscanf(p + 6, "%d: %39s +%d", &addr, nm, &k) != 3)
+            continue;
+
+        if (cur[seq] != SIZE_MAX)
+            prof_end(pf, cur[seq], cyc - last[seq]);
+        cur[seq] = prof_step(pf, seq, addr, nm, k);
+        last[seq] = cyc;
+        n++;
+    }
+    gzclose(gz);
+    if (n == 0) {
+        fprintf(stderr, "%s: no sequencer tags\n", fn);
+        return -1;
+    }
+
+    //  the final steps last until the end of the run
+    for (seq = 0; seq < PROF_SEQ; seq++) {
+        if (cur[seq] != SIZE_MAX && ext >= last[seq])
+            prof_end(pf, cur[seq], ext - last[seq]);
+    }
+    if (ext >= 0)
+        hist_add(&pf->tot, ext, 1);
+
+    for (i = 0; i < pf->n_ph; i++) {
+        if (!pf->ph[i].run_on)
+            continue;
+        hist_add(&pf->ph[i].vis, pf->ph[i].run_vis, 1);
+        hist_add(&pf->ph[i].cyc, pf->ph[i].run_cyc, 1);
+        pf->ph[i].run_on = false;
+        pf->ph[i].run_vis = 0;
+        pf->ph[i].run_cyc = 0;
+    }
+    pf->runs++;
+
+    return 0;
+}
+
+//  === profile file
+
+static void prof_write(const prof_t *pf, FILE *fp)
+{
+    const phase_t *ph;
+    const step_t *s;
+    size_t  i;
+
+    fprintf(fp, "[runs]\t%lu\n", pf->runs);
+    fprintf(fp, "[total]\tcycles");
+    hist_put(fp, &pf->tot);
+
+    //  per phase: runs, average visits and cycles per run and per visit
+    for (i = 0; i < pf->n_ph; i++) {
+        ph = &pf->ph[i];
+        fprintf(fp, "[phase]\t%s\t%-32s\t%lu\t%.3f\t%.1f\t%.1f\n",
+                seq_name[ph->seq], ph->name, hist_n(&ph->cyc),
+                hist_avg(&ph->vis), hist_avg(&ph->cyc),
+                hist_avg(&ph->vis) > 0.0 ?
+                    hist_avg(&ph->cyc) / hist_avg(&ph->vis) : 0.0);
+        fprintf(fp, "[visits]\t%s\t%s", seq_name[ph->seq], ph->name);
+        hist_put(fp, &ph->vis);
+        fprintf(fp, "[cycles]\t%s\t%s", seq_name[ph->seq], ph->name);
+        hist_put(fp, &ph->cyc);
+    }
+
+    //  per address: executions, cycles total / min / max
+    for (i = 0; i < pf->n_st; i++) {
+        s = &pf->st[i];
+        fprintf(fp, "[step]\t%s\t%5d\t%-32s\t+%d\t%lu\t%ld\t%ld\t%ld\n",
+                seq_name[s->seq], s->addr, pf->ph[s->ph].name, s->k,
+                s->cnt, s->sum, s->cnt > 0 ? s->min : 0,
+                s->cnt > 0 ? s->max : 0);
+    }
+}
+
+static int seq_get(const char *s)
+{
+    int seq;
+
+    for (seq = 0; seq < PROF_SEQ; seq++) {
+        if (strcmp(s, seq_name[seq]) == 0)
+            return seq;
+    }
+    return -1;
+}
+
+//  add a profile file to pf
+
+static int prof_read(prof_t *pf, const char *fn)
+{
+    FILE    *fp;
+    char    *buf = NULL, *p;
+    size_t  sz = 0, i;
+    char    tag[16], sq[8], nm[PROF_NAME];
+    int     seq, addr, k, n;
+    uint64_t cnt;
+    int64_t sum, min, max;
+
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    while (getline(&buf, &sz, fp) > 0) {
+        if (sscanf(buf, "%15s", tag) != 1)
+            continue;
+        if (strcmp(tag, "[runs]") == 0) {
+            pf->runs += strtoull(buf + 6, NULL, 10);
+        } else if (strcmp(tag, "[total]") == 0) {
+            p = strstr(buf, "cycles");
+            if (p != NULL)
+                hist_get(&pf->tot, p + 6);
+        } else if (strcmp(tag, "[visits]") == 0 ||
+                    strcmp(tag, "[cycles]") == 0) {
+            if (sscanf(buf, "%*s %7s %39s %n", sq, nm, &n) != 2 ||
+                (seq = seq_get(sq)) < 0)
+                goto fail;
+            i = prof_phase(pf, seq, nm);
+            hist_get(tag[1] == 'v' ? &pf->ph[i].vis : &pf->ph[i].cyc,
+                        buf + n);
+        } else if (strcmp(tag, "[step]") == 0) {
+            if (sscanf(buf, "%*s %7s %d %39s +%d %lu %ld %ld %ld",
+                        sq, &addr, nm, &k, &cnt, &sum, &min, &max) != 8 ||
+                (seq = seq_get(sq)) < 0)
+                goto fail;
+            i = prof_step(pf, seq, addr, nm, k);
+            if (cnt > 0)
+                step_add(&pf->st[i], cnt, sum, min, max);
+        }
+    }
+    free(buf);
+    fclose(fp);
+    return 0;
+
+fail:
+    fprintf(stderr, "%s: bad line: %s", fn, buf);
+    free(buf);
+    fclose(fp);
+    return -1;
+}
+
+//  === comparison
+
+static const phase_t *find_phase(const prof_t *pf, int seq, const char *nm)
+{
+    size_t  i;
+
+    for (i = 0; i < pf->n_ph; i++) {
+        if (pf->ph[i].seq == seq && strcmp(pf->ph[i].name, nm) == 0)
+            return &pf->ph[i];
+    }
+    return NULL;
+}
+
+//  a step of b in a, by name and k (not by address)
+
+static const step_t *find_step(const prof_t *pf, const step_t *s,
+                                const char *nm)
+{
+    size_t  i;
+
+    for (i = 0; i < pf->n_st; i++) {
+        if (pf->st[i].seq == s->seq && pf->st[i].k == s->k &&
+            strcmp(pf->ph[pf->st[i].ph].name, nm) == 0)
+            return &pf->st[i];
+    }
+    return NULL;
+}
+
+//  per-visit cycles, so that the rejection rounds (which depend on the
+//  inputs, not on the build) do not count as a regression
+
+static double ph_lat(const phase_t *ph)
+{
+    double  v = hist_avg(&ph->vis);
+
+    return v > 0.0 ? hist_avg(&ph->cyc) / v : hist_avg(&ph->cyc);
+}
+
+static const char *diff_flag(double a, double b, double th)
+{
+    if (a <= 0.0)
+        return b > 0.0 ? "[slow]" : "";
+    if (100.0 * (b - a) / a > th)
+        return "[slow]";
+    if (100.0 * (a - b) / a > th)
+        return "[fast]";
+    return "";
+}
+
+static int prof_diff(const prof_t *a, const prof_t *b, double th, bool all)
+{
+    const phase_t *pa, *pb;
+    const step_t *sa, *sb;
+    double  la, lb;
+    const char *f;
+    size_t  i;
+    int     slow = 0;
+
+    printf("#\t\t%-32s\t%10s\t%10s\t%9s\t%7s\t%6s\t%6s\n",
+            "per visit", "a", "b", "b-a", "%", "vis a", "vis b");
+    la = hist_avg(&a->tot);
+    lb = hist_avg(&b->tot);
+    printf("[total]\t\t%-32s\t%10.1f\t%10.1f\t%+9.1f\t%+6.2f%%\n",
+            "cycles per run", la, lb, lb - la,
+            la > 0.0 ? 100.0 * (lb - la) / la : 0.0);
+
+    //  phases of b, in b's order, then those that are gone
+    for (i = 0; i < b->n_ph; i++) {
+        pb = &b->ph[i];
+        pa = find_phase(a, pb->seq, pb->name);
+        if (pa == NULL) {
+            printf("[new]\t%s\t%-32s\t%10s\t%10.1f\n",
+                    seq_name[pb->seq], pb->name, "-", ph_lat(pb));
+            continue;
+        }
+        la = ph_lat(pa);
+        lb = ph_lat(pb);
+        f = diff_flag(la, lb, th);
+        slow += f[1] == 's';
+        if (!all && *f == 0)
+            continue;
+        printf("[phase]\t%s\t%-32s\t%10.1f\t%10.1f\t%+9.1f\t%+6.2f%%\t"
+                "%6.3f\t%6.3f\t%s\n", seq_name[pb->seq], pb->name, la, lb,
+                lb - la, la > 0.0 ? 100.0 * (lb - la) / la : 0.0,
+                hist_avg(&pa->vis), hist_avg(&pb->vis), f);
+    }
+    for (i = 0; i < a->n_ph; i++) {
+        pa = &a->ph[i];
+        if (find_phase(b, pa->seq, pa->name) == NULL)
+            printf("[gone]\t%s\t%-32s\t%10.1f\t%10s\n",
+                    seq_name[pa->seq], pa->name, ph_lat(pa), "-");
+    }
+
+    //  steps that moved (per execution)
+    for (i = 0; i < b->n_st; i++) {
+        sb = &b->st[i];
+        sa = find_step(a, sb, b->ph[sb->ph].name);
+        if (sa == NULL || sa->cnt == 0 || sb->cnt == 0)
+            continue;
+        la = (double) sa->sum / sa->cnt;
+        lb = (double) sb->sum / sb->cnt;
+        f = diff_flag(la, lb, th);
+        if (!all && *f == 0)
+            continue;
+        printf("[step]\t%s\t%-28s +%-3d\t%10.1f\t%10.1f\t%+9.1f\t%+6.2f%%\t"
+                "@%5d\t@%5d\t%s\n", seq_name[sb->seq], b->ph[sb->ph].name,
+                sb->k, la, lb, lb - la,
+                la > 0.0 ? 100.0 * (lb - la) / la : 0.0,
+                sa->addr, sb->addr, f);
+    }
+    printf("[diff]\t%lu vs. %lu runs: %d phases slower than %.2f%%\n",
+            a->runs, b->runs, slow, th);
+
+    return slow > 0 ? 2 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    prof_t      pf, pb;
+    const char  *out_fn = NULL;
+    const char  **in_fn;
+    char        path[512];
+    struct stat sb;
+    FILE        *fp;
+    double      th = 1.0;
+    bool        merge = false, diff = false, all = false;
+    int         i, n_in = 0, n = 0;
+
+    memset(&pf, 0, sizeof(pf));
+    memset(&pb, 0, sizeof(pb));
+    in_fn = calloc(argc, sizeof(char *));
+    if (in_fn == NULL)
+        exit(-1);
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0) {
+            merge = true;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            diff = true;
+        } else if (strcmp(argv[i], "-a") == 0) {
+            all = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-T") == 0) {
+            th = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (argv[i][0] != '-') {
+            in_fn[n_in++] = argv[i];
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (n_in < 1 || (diff && (merge || n_in != 2))) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (diff) {
+        if (prof_read(&pf, in_fn[0]) != 0 || prof_read(&pb, in_fn[1]) != 0)
+            return 1;
+        return prof_diff(&pf, &pb, th, all);
+    }
+
+    for (i = 0; i < n_in; i++) {
+        if (merge) {
+            if (prof_read(&pf, in_fn[i]) != 0)
+                return 1;
+            continue;
+        }
+        if (stat(in_fn[i], &sb) == 0 && S_ISDIR(sb.st_mode)) {
+            snprintf(path, sizeof(path), "%s/run.log.gz", in_fn[i]);
+            if (stat(path, &sb) != 0)
+                snprintf(path, sizeof(path), "%s/run.log", in_fn[i]);
+        } else {
+            snprintf(path, sizeof(path), "%s", in_fn[i]);
+        }
+        if (prof_log(&pf, path) != 0)
+            n++;
+    }
+    if (n > 0)
+        fprintf(stderr, "[prof] %d of %d logs skipped\n", n, n_in);
+
+    fp = stdout;
+    if (out_fn != NULL && (fp = fopen(out_fn, "w")) == NULL) {
+        perror(out_fn);
+        return 1;
+    }
+    prof_write(&pf, fp);
+    if (fp != stdout)
+        fclose(fp);
+
+    return 0;
+}
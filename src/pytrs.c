@@ -0,0 +1,682 @@
+//  pytrs.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Python module "trstore": stores and accumulators as buffers.
+
+//  Everything that is already in memory is exported through the buffer
+//  protocol without a copy (numpy.asarray() wraps it): the per-trace
+//  metadata, the matrix of an uncompressed store, its unfinished tile,
+//  and the sums of an accumulator. Compressed chunks are decoded into a
+//  new buffer by window(). The passes over a store use the threads of
+//  accum.c and release the GIL while they run.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <pthread.h>
+#include <math.h>
+
+#include "accum.h"
+
+//  === buffer view of memory owned by another object (or by itself)
+
+typedef struct {
+    PyObject_HEAD
+    PyObject    *owner;             //  keeps the memory alive
+    void        *ptr;
+    bool        own;                //  ptr is ours to free
+    bool        ro;
+    int         ndim;
+    Py_ssize_t  shape[3], strides[3];
+    Py_ssize_t  isz;
+    const char  *fmt;
+} ViewObject;
+
+static void view_dealloc(ViewObject *v)
+{
+    if (v->own)
+        free(v->ptr);
+    Py_XDECREF(v->owner);
+    Py_TYPE(v)->tp_free((PyObject *) v);
+}
+
+static int view_getbuf(ViewObject *v, Py_buffer *b, int flags)
+{
+    if ((flags & PyBUF_WRITABLE) && v->ro) {
+        PyErr_SetString(PyExc_BufferError, "read-only view");
+        return -1;
+    }
+    b->buf      = v->ptr;
+    b->obj      = (PyObject *) v;
+    Py_INCREF(v);
+    b->len      = v->isz;
+    for (int i = 0; i < v->ndim; i++)
+        b->len *= v->shape[i];
+    b->readonly = v->ro;
+    b->itemsize = v->isz;
+    b->format   = (flags & PyBUF_FORMAT) ? (char *) v->fmt : NULL;
+    b->ndim     = v->ndim;
+    b->shape    = v->shape;
+    b->strides  = v->strides;
+    b->suboffsets = NULL;
+    b->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs view_as_buf = {
+    .bf_getbuffer   = (getbufferproc) view_getbuf,
+};
+
+static PyTypeObject ViewType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name        = "trstore.View",
+    .tp_basicsize   = sizeof(ViewObject),
+    .tp_dealloc     = (destructor) view_dealloc,
+    .tp_as_buffer   = &view_as_buf,
+    .tp_flags       = Py_TPFLAGS_DEFAULT,
+    .tp_doc         = "Buffer view; numpy.asarray() wraps it without a copy.",
+};
+
+//  row-major view of ndim dimensions
+
+static PyObject *view_new(PyObject *owner, void *ptr, bool own, bool ro,
+                            const char *fmt, Py_ssize_t isz, int ndim,
+                            const Py_ssize_t *shape)
+{
+    ViewObject  *v;
+    Py_ssize_t  s = isz;
+    int         i;
+
+    v = PyObject_New(ViewObject, &ViewType);
+    if (v == NULL) {
+        if (own)
+            free(ptr);
+        return NULL;
+    }
+    v->owner    = owner;
+    Py_XINCREF(owner);
+    v->ptr      = ptr;
+    v->own      = own;
+    v->ro       = ro;
+    v->fmt      = fmt;
+    v->isz      = isz;
+    v->ndim     = ndim;
+    for (i = ndim - 1; i >= 0; i--) {
+        v->shape[i]     = shape[i];
+        v->strides[i]   = s;
+        s *= shape[i];
+    }
+    return (PyObject *) v;
+}
+
+//  === Store
+
+typedef struct {
+    PyObject_HEAD
+    trs_t       *t;
+} StoreObject;
+
+static PyTypeObject StoreType;
+
+static void store_dealloc(StoreObject *s)
+{
+    trs_close(s->t);
+    Py_TYPE(s)->tp_free((PyObject *) s);
+}
+
+static int store_init(StoreObject *s, PyObject *args, PyObject *kw)
+{
+    static char *kwl[] = { "dir", NULL };
+    const char  *dir;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "s", kwl, &dir))
+        return -1;
+    trs_close(s->t);
+    s->t = trs_open(dir, false);
+    if (s->t == NULL) {
+        PyErr_Format(PyExc_OSError, "%s: cannot open store", dir);
+        return -1;
+    }
+    return 0;
+}
+
+static const char *store_fmt(const trs_t *t)
+{
+    return t->hdr.esz == 2 ? "H" : "I";
+}
+
+//  per-trace metadata records (trs_meta_t), as a structured array
+
+static PyObject *store_meta(StoreObject *s, void *closure)
+{
+    Py_ssize_t n = s->t->hdr.n;
+
+    (void) closure;
+    return view_new((PyObject *) s, (void *) s->t->meta, false, true,
+                "T{B:cls:B:status:h:kappa:i:label:q:last:32s:seed:64s:name:}",
+                sizeof(trs_meta_t), 1, &n);
+}
+
+//  complete tiles of an uncompressed store: [tile][cycle][trace in tile]
+
+static PyObject *store_tiles(StoreObject *s, void *closure)
+{
+    const trs_t *t = s->t;
+    size_t      nchk = trs_nchk(t), i;
+    uint64_t    off;
+    Py_ssize_t  shape[3];
+
+    (void) closure;
+    for (i = 0; i < t->hdr.n_tile * nchk; i++) {
+        off = ((i / nchk) * t->hdr.ncyc + (i % nchk) * TRS_ROWS) *
+                TRS_TILE * t->hdr.esz;
+        if (t->idx[i].how != TRS_RAW || t->idx[i].off != off) {
+            PyErr_SetString(PyExc_ValueError,
+                            "compressed store: use window()");
+            return NULL;
+        }
+    }
+    shape[0] = t->hdr.n_tile;
+    shape[1] = t->hdr.ncyc;
+    shape[2] = TRS_TILE;
+    return view_new((PyObject *) s, (void *) t->mat, false, true,
+                    store_fmt(t), t->hdr.esz, 3, shape);
+}
+
+//  traces of the unfinished tile: [trace][cycle]
+
+static PyObject *store_pend(StoreObject *s, void *closure)
+{
+    const trs_t *t = s->t;
+    Py_ssize_t  shape[2];
+
+    (void) closure;
+    shape[0] = t->hdr.n - t->hdr.n_tile * TRS_TILE;
+    shape[1] = t->hdr.ncyc;
+    return view_new((PyObject *) s, (void *) t->pend, false, true,
+                    store_fmt(t), t->hdr.esz, 2, shape);
+}
+
+static PyObject *store_hdr(StoreObject *s, void *closure)
+{
+    const trs_hdr_t *h = &s->t->hdr;
+
+    switch ((intptr_t) closure) {
+        case 0:     return PyLong_FromUnsignedLongLong(h->n);
+        case 1:     return PyLong_FromLongLong(h->cyc0);
+        case 2:     return PyLong_FromLongLong(h->ncyc);
+        case 3:     return PyLong_FromLong(h->esz);
+        case 4:     return PyLong_FromUnsignedLongLong(h->n_tile);
+        default:    return PyBool_FromLong(h->comp);
+    }
+}
+
+static PyGetSetDef store_getset[] = {
+    { "n",      (getter) store_hdr, NULL, "traces", (void *) 0 },
+    { "cyc0",   (getter) store_hdr, NULL, "first cycle", (void *) 1 },
+    { "ncyc",   (getter) store_hdr, NULL, "cycles per trace", (void *) 2 },
+    { "esz",    (getter) store_hdr, NULL, "element bytes", (void *) 3 },
+    { "n_tile", (getter) store_hdr, NULL, "complete tiles", (void *) 4 },
+    { "comp",   (getter) store_hdr, NULL, "compressed", (void *) 5 },
+    { "meta",   (getter) store_meta, NULL,
+        "per-trace metadata (structured, no copy)", NULL },
+    { "tiles",  (getter) store_tiles, NULL,
+        "[tile][cycle][trace] of an uncompressed store (no copy)", NULL },
+    { "pend",   (getter) store_pend, NULL,
+        "[trace][cycle] of the unfinished tile (no copy)", NULL },
+    { NULL }
+};
+
+//  window(): decode traces [i0, i1) x cycles [c0, c1) into [trace][cycle]
+
+typedef struct {
+    const trs_t *t;
+    const acc_sel_t *sel;
+    uint32_t    *out;
+    size_t      next;               //  next tile to claim
+    size_t      tile1;
+} win_t;
+
+static void *win_thread(void *arg)
+{
+    win_t       *w = (win_t *) arg;
+    const trs_t *t = w->t;
+    const acc_sel_t *sel = w->sel;
+    uint32_t    *buf;
+    size_t      tile, chk, rows, cols, r, j, i;
+    int64_t     c, cw;
+
+    buf = malloc(TRS_ROWS * TRS_TILE * sizeof(uint32_t));
+    if (buf == NULL)
+        exit(-1);
+    for (;;) {
+        tile = __atomic_fetch_add(&w->next, 1, __ATOMIC_RELAXED);
+        if (tile >= w->tile1)
+            break;
+        for (chk = (sel->cyc0 - t->hdr.cyc0) / TRS_ROWS;
+            (int64_t) (chk * TRS_ROWS) < sel->cyc0 + sel->ncyc - t->hdr.cyc0;
+            chk++) {
+            cols = trs_chunk(t, tile, chk, buf, &rows);
+            c = t->hdr.cyc0 + chk * TRS_ROWS;
+            for (j = 0; j < cols; j++) {
+                i = tile * TRS_TILE + j;
+                if (i < sel->i0 || i >= sel->i1)
+                    continue;
+                for (r = 0; r < rows; r++) {
+                    cw = c + r - sel->cyc0;
+                    if (cw >= 0 && cw < sel->ncyc)
+                        w->out[(i - sel->i0) * sel->ncyc + cw] =
+                            buf[r * TRS_TILE + j];
+                }
+            }
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+//  selection from (c0, c1, i0, i1); -1 means the whole store
+
+static void sel_args(acc_sel_t *sel, const trs_t *t, long long c0,
+                        long long c1, long long i0, long long i1)
+{
+    acc_sel_init(sel, t);
+    if (c0 >= 0)
+        sel->cyc0 = c0;
+    if (c1 >= 0)
+        sel->ncyc = c1 - sel->cyc0;
+    if (i0 >= 0)
+        sel->i0 = i0;
+    if (i1 >= 0)
+        sel->i1 = i1;
+    acc_sel_clip(sel, t);
+}
+
+static PyObject *store_window(StoreObject *s, PyObject *args, PyObject *kw)
+{
+    static char *kwl[] = { "c0", "c1", "i0", "i1", "threads", NULL };
+    long long   c0 = -1, c1 = -1, i0 = -1, i1 = -1;
+    int         nthr = acc_nthr(), k;
+    acc_sel_t   sel;
+    win_t       w;
+    pthread_t   *tid;
+    Py_ssize_t  shape[2];
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "|LLLLi", kwl,
+            &c0, &c1, &i0, &i1, &nthr))
+        return NULL;
+    sel_args(&sel, s->t, c0, c1, i0, i1);
+    shape[0] = sel.i1 - sel.i0;
+    shape[1] = sel.ncyc;
+
+    w.t     = s->t;
+    w.sel   = &sel;
+    w.out   = calloc(shape[0] * shape[1] + 1, sizeof(uint32_t));
+    w.next  = sel.i0 / TRS_TILE;
+    w.tile1 = (sel.i1 + TRS_TILE - 1) / TRS_TILE;
+    if (w.out == NULL)
+        return PyErr_NoMemory();
+    if (nthr < 1)
+        nthr = 1;
+    if ((size_t) nthr > w.tile1 - w.next)
+        nthr = w.tile1 > w.next ? w.tile1 - w.next : 1;
+    tid = malloc(nthr * sizeof(pthread_t));
+    if (tid == NULL)
+        exit(-1);
+
+    Py_BEGIN_ALLOW_THREADS
+    for (k = 0; k < nthr; k++) {
+        if (pthread_create(&tid[k], NULL, win_thread, &w) != 0) {
+            perror("pthread_create");
+            exit(-1);
+        }
+    }
+    for (k = 0; k < nthr; k++)
+        pthread_join(tid[k], NULL);
+    Py_END_ALLOW_THREADS
+
+    free(tid);
+    return view_new(NULL, w.out, true, false, "I", 4, 2, shape);
+}
+
+static PyMethodDef store_methods[] = {
+    { "window", (PyCFunction) (void (*)(void)) store_window,
+        METH_VARARGS | METH_KEYWORDS,
+        "window(c0=, c1=, i0=, i1=, threads=): traces [i0, i1) x cycles\n"
+        "[c0, c1) as a new [trace][cycle] uint32 buffer" },
+    { NULL }
+};
+
+static PyTypeObject StoreType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name        = "trstore.Store",
+    .tp_basicsize   = sizeof(StoreObject),
+    .tp_dealloc     = (destructor) store_dealloc,
+    .tp_flags       = Py_TPFLAGS_DEFAULT,
+    .tp_doc         = "Store(dir): a campaign store, read-only.",
+    .tp_methods     = store_methods,
+    .tp_getset      = store_getset,
+    .tp_init        = (initproc) store_init,
+    .tp_new         = PyType_GenericNew,
+};
+
+//  === Acc: accumulator state; the sums are the buffer
+
+typedef struct {
+    PyObject_HEAD
+    acc_t       *a;
+    Py_ssize_t  len, isz;           //  buffer shape and stride
+} AccObject;
+
+static PyTypeObject AccType;
+
+static void acc_dealloc(AccObject *a)
+{
+    acc_free(a->a);
+    Py_TYPE(a)->tp_free((PyObject *) a);
+}
+
+static PyObject *acc_wrap(acc_t *x)
+{
+    AccObject *a;
+
+    a = PyObject_New(AccObject, &AccType);
+    if (a == NULL) {
+        acc_free(x);
+        return NULL;
+    }
+    a->a = x;
+    return (PyObject *) a;
+}
+
+static int acc_getbuf(AccObject *a, Py_buffer *b, int flags)
+{
+    a->len      = a->a->hdr.len;
+    a->isz      = sizeof(double);
+    b->buf      = a->a->v;
+    b->obj      = (PyObject *) a;
+    Py_INCREF(a);
+    b->len      = a->len * sizeof(double);
+    b->readonly = 0;
+    b->itemsize = sizeof(double);
+    b->format   = (flags & PyBUF_FORMAT) ? (char *) "d" : NULL;
+    b->ndim     = 1;
+    b->shape    = &a->len;
+    b->strides  = &a->isz;
+    b->suboffsets = NULL;
+    b->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs acc_as_buf = {
+    .bf_getbuffer   = (getbufferproc) acc_getbuf,
+};
+
+static PyObject *acc_py_load(PyObject *cls, PyObject *args)
+{
+    const char  *fn;
+    acc_t       *x;
+
+    (void) cls;
+    if (!PyArg_ParseTuple(args, "s", &fn))
+        return NULL;
+    x = acc_load(fn);
+    if (x == NULL)
+        return PyErr_Format(PyExc_OSError, "%s: cannot load", fn);
+    return acc_wrap(x);
+}
+
+static PyObject *acc_py_save(AccObject *a, PyObject *args)
+{
+    const char  *fn;
+
+    if (!PyArg_ParseTuple(args, "s", &fn))
+        return NULL;
+    if (acc_save(a->a, fn) != 0)
+        return PyErr_Format(PyExc_OSError, "%s: cannot save", fn);
+    Py_RETURN_NONE;
+}
+
+static PyObject *acc_py_merge(AccObject *a, PyObject *args)
+{
+    AccObject   *b;
+    int         r;
+
+    if (!PyArg_ParseTuple(args, "O!", &AccType, &b))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    r = acc_merge(a->a, b->a);
+    Py_END_ALLOW_THREADS
+    if (r != 0) {
+        PyErr_SetString(PyExc_ValueError, "accumulators do not match");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *acc_hdr(AccObject *a, void *closure)
+{
+    const acc_hdr_t *h = &a->a->hdr;
+
+    switch ((intptr_t) closure) {
+        case 0:     return PyUnicode_FromStringAndSize(h->kind,
+                                strnlen(h->kind, sizeof(h->kind)));
+        case 1:     return PyLong_FromLongLong(h->cyc0);
+        case 2:     return PyLong_FromLongLong(h->ncyc);
+        case 3:     return PyLong_FromUnsignedLongLong(h->dim);
+        case 4:     return PyLong_FromUnsignedLongLong(h->n);
+        case 5:     return PyLong_FromUnsignedLongLong(h->next);
+        case 6:     return PyLong_FromUnsignedLongLong(h->len);
+        default:    return PyLong_FromUnsignedLongLong(h->fix);
+    }
+}
+
+static PyGetSetDef acc_getset[] = {
+    { "kind",   (getter) acc_hdr, NULL, "tool name", (void *) 0 },
+    { "cyc0",   (getter) acc_hdr, NULL, "first cycle", (void *) 1 },
+    { "ncyc",   (getter) acc_hdr, NULL, "window length", (void *) 2 },
+    { "dim",    (getter) acc_hdr, NULL, "tool-specific", (void *) 3 },
+    { "n",      (getter) acc_hdr, NULL, "traces", (void *) 4 },
+    { "next",   (getter) acc_hdr, NULL, "store position", (void *) 5 },
+    { "len",    (getter) acc_hdr, NULL, "sums", (void *) 6 },
+    { "fix",    (getter) acc_hdr, NULL, "leading fixed values", (void *) 7 },
+    { NULL }
+};
+
+static PyMethodDef acc_methods[] = {
+    { "load", (PyCFunction) acc_py_load, METH_VARARGS | METH_CLASS,
+        "load(fn): saved state of any tool" },
+    { "save", (PyCFunction) acc_py_save, METH_VARARGS,
+        "save(fn): write the state (atomically)" },
+    { "merge", (PyCFunction) acc_py_merge, METH_VARARGS,
+        "merge(b): add the sums of a matching state" },
+    { NULL }
+};
+
+static PyTypeObject AccType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name        = "trstore.Acc",
+    .tp_basicsize   = sizeof(AccObject),
+    .tp_dealloc     = (destructor) acc_dealloc,
+    .tp_as_buffer   = &acc_as_buf,
+    .tp_flags       = Py_TPFLAGS_DEFAULT,
+    .tp_doc         = "Accumulator state; the buffer is its sums (float64).",
+    .tp_methods     = acc_methods,
+    .tp_getset      = acc_getset,
+};
+
+//  === kernels
+
+//  tvla layout as in tvla.c: n[2], s1[2][nc], s2[2][nc]
+
+typedef struct {
+    const trs_t *t;
+    acc_t       *a;
+} tvla_ctx_t;
+
+static bool tvla_keep(void *arg, size_t i)
+{
+    const trs_t *t = (const trs_t *) arg;
+
+    return t->meta[i].cls == TRS_FIX || t->meta[i].cls == TRS_RND;
+}
+
+static void tvla_blk(void *ctx, const acc_blk_t *b)
+{
+    const tvla_ctx_t *c = (const tvla_ctx_t *) ctx;
+    int64_t     nc = c->a->hdr.ncyc;
+    const double *x;
+    double      *s1, *s2;
+    size_t      j, r, k;
+
+    for (j = 0; j < b->m; j++) {
+        x = b->x + j * ACC_LD;
+        k = c->t->meta[b->idx[j]].cls;
+        s1 = c->a->v + 2 + k * nc + b->off;
+        s2 = c->a->v + 2 + (2 + k) * nc + b->off;
+        for (r = 0; r < b->rows; r++) {
+            s1[r] += x[r];
+            s2[r] += x[r] * x[r];
+        }
+    }
+}
+
+static PyObject *py_tvla(PyObject *self, PyObject *args, PyObject *kw)
+{
+    static char *kwl[] = { "store", "c0", "c1", "i0", "i1", "threads",
+                            "acc", NULL };
+    StoreObject *s;
+    PyObject    *ao = NULL;
+    long long   c0 = -1, c1 = -1, i0 = -1, i1 = -1;
+    int         nthr = acc_nthr();
+    acc_sel_t   sel;
+    tvla_ctx_t  ctx;
+    acc_t       *a;
+    size_t      i;
+
+    (void) self;
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "O!|LLLLiO!", kwl,
+            &StoreType, &s, &c0, &c1, &i0, &i1, &nthr, &AccType, &ao))
+        return NULL;
+    sel_args(&sel, s->t, c0, c1, i0, i1);
+
+    //  continue a state: its window, traces it has not seen
+    if (ao != NULL) {
+        a = ((AccObject *) ao)->a;
+        if (strcmp(a->hdr.kind, "tvla") != 0) {
+            PyErr_SetString(PyExc_ValueError, "not a tvla state");
+            return NULL;
+        }
+        sel.cyc0 = a->hdr.cyc0;
+        sel.ncyc = a->hdr.ncyc;
+        if (sel.i0 < a->hdr.next)
+            sel.i0 = a->hdr.next;
+        acc_sel_clip(&sel, s->t);
+        Py_INCREF(ao);
+    } else {
+        a = acc_new("tvla", sel.cyc0, sel.ncyc, 2, 2 + 4 * sel.ncyc);
+        ao = acc_wrap(a);
+        if (ao == NULL)
+            return NULL;
+    }
+    sel.keep = tvla_keep;
+    sel.keep_arg = s->t;
+    ctx.t = s->t;
+    ctx.a = a;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = sel.i0; i < sel.i1; i++) {
+        if (!acc_sel_trace(s->t, &sel, i))
+            continue;
+        a->v[s->t->meta[i].cls] += 1.0;
+        a->hdr.n++;
+    }
+    if (sel.i1 > a->hdr.next)
+        a->hdr.next = sel.i1;
+    acc_scan(s->t, &sel, nthr, tvla_blk, &ctx);
+    Py_END_ALLOW_THREADS
+
+    return ao;
+}
+
+//  welch t per cycle of a tvla state; 0 if undefined
+
+static PyObject *py_ttest(PyObject *self, PyObject *args)
+{
+    AccObject   *ao;
+    const acc_t *a;
+    int64_t     nc, j;
+    double      *tv, n0, n1, m0, m1, v0, v1, c;
+    Py_ssize_t  shape[1];
+
+    (void) self;
+    if (!PyArg_ParseTuple(args, "O!", &AccType, &ao))
+        return NULL;
+    a = ao->a;
+    nc = a->hdr.ncyc;
+    if (strcmp(a->hdr.kind, "tvla") != 0 ||
+        a->hdr.len != (uint64_t) (2 + 4 * nc)) {
+        PyErr_SetString(PyExc_ValueError, "not a tvla state");
+        return NULL;
+    }
+    tv = calloc(nc + 1, sizeof(double));
+    if (tv == NULL)
+        return PyErr_NoMemory();
+
+    Py_BEGIN_ALLOW_THREADS
+    n0 = a->v[0];
+    n1 = a->v[1];
+    for (j = 0; j < nc && n0 > 0.0 && n1 > 0.0; j++) {
+        m0 = a->v[2 + j] / n0;
+        m1 = a->v[2 + nc + j] / n1;
+        v0 = a->v[2 + 2 * nc + j] / n0 - m0 * m0;
+        v1 = a->v[2 + 3 * nc + j] / n1 - m1 * m1;
+        c = (v0 > 0.0 ? v0 : 0.0) / n0 + (v1 > 0.0 ? v1 : 0.0) / n1;
+        tv[j] = c > 0.0 ? (m0 - m1) / sqrt(c) : 0.0;
+    }
+    Py_END_ALLOW_THREADS
+
+    shape[0] = nc;
+    return view_new(NULL, tv, true, false, "d", sizeof(double), 1, shape);
+}
+
+static PyMethodDef module_methods[] = {
+    { "tvla", (PyCFunction) (void (*)(void)) py_tvla,
+        METH_VARARGS | METH_KEYWORDS,
+        "tvla(store, c0=, c1=, i0=, i1=, threads=, acc=): fix/rnd sums\n"
+        "of a window (as the tvla tool); with acc, add the traces that it\n"
+        "has not seen" },
+    { "ttest", (PyCFunction) py_ttest, METH_VARARGS,
+        "ttest(acc): Welch t per cycle of a tvla state" },
+    { NULL }
+};
+
+static struct PyModuleDef trstore_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name     = "trstore",
+    .m_doc      = "Campaign stores and accumulators as buffers (see pytrs.c).",
+    .m_size     = -1,
+    .m_methods  = module_methods,
+};
+
+PyMODINIT_FUNC PyInit_trstore(void)
+{
+    PyObject *m;
+
+    if (PyType_Ready(&ViewType) < 0 || PyType_Ready(&StoreType) < 0 ||
+        PyType_Ready(&AccType) < 0)
+        return NULL;
+    m = PyModule_Create(&trstore_module);
+    if (m == NULL)
+        return NULL;
+    Py_INCREF(&StoreType);
+    Py_INCREF(&AccType);
+    if (PyModule_AddObject(m, "Store", (PyObject *) &StoreType) < 0 ||
+        PyModule_AddObject(m, "Acc", (PyObject *) &AccType) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    PyModule_AddIntConstant(m, "TILE", TRS_TILE);
+    PyModule_AddIntConstant(m, "FIX", TRS_FIX);
+    PyModule_AddIntConstant(m, "RND", TRS_RND);
+    PyModule_AddIntConstant(m, "KGR", TRS_KGR);
+    return m;
+}
@@ -2,507 +2,453 @@
 //  2024-11-24  Markku-Juhani O. Saarinen <mjos@iki.fi>
 //  === Read a VCD file and try to create a power trace reasonably fast.
 
+#define _GNU_SOURCE
 #include <stdio.h>
-#include <ctype.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "vcd.h"
+
+#define READ_SZ     0x100000    //  read granularity
+#define SLICE_MAX   0x1000000   //  bytes per stream before yielding
+#define THREAD_MAX  256
+
+//  power model and clock options (both modes)
+static struct {
+    const char  *w_fn;          //  weight file
+    bool        hw;             //  hamming weight model
+    const char  *clk_g;         //  clock net globs
+    bool        edge;           //  one dump per cycle (mldsa_wrap -edge)
+    bool        rf;             //  rise and fall columns
+    bool        step;           //  apply the changes of a step at its end
+} pm;
+
+//  FST input (by file name)
+
+static bool is_fst(const char *fn)
+{
+    size_t l = strlen(fn);
 
-#define LINE_SZ_MAX 1024
-#define TOKEN_MAX   16
-#define ID_SZ_MAX   8
-#define SCOPE_MAX   100
+    return l > 4 && strcmp(fn + l - 4, ".fst") == 0;
+}
 
-typedef struct {
-    char id[ID_SZ_MAX];     //  identifier
-    int d;                  //  width
-    int n;                  //  how many signal names
-    size_t o;               //  first signal name
-    size_t u;               //  how many times updated
-    char *s;                //  pointer to state
-} var_t;
+//  read a stream to the end; uses the same line feeder as the service
 
-char *signame = NULL;       //  buffer for signal names
-size_t signame_sz = 0;      //  size
-size_t signame_max = 0;     //  allocated
+static int read_vcd(const char *fn, const char *timing,
+                    int64_t thresh, const int64_t *dump_tim)
+{
+    vcd_str_t st;
+    int     fd;
+    char    *buf;
+    size_t  buf_sz, buf_n, n;
+    ssize_t r;
+
+    if (is_fst(fn)) {
+#ifdef VCD_FST
+        vcd_str_init(&st, fn, stdout, timing, thresh, dump_tim);
+        vcd_str_model(&st, pm.w_fn, pm.hw);
+        vcd_str_step(&st, pm.step);
+        vcd_str_clock(&st, pm.clk_g, pm.edge, pm.rf);
+        if (vcd_fst_read(&st, fn) != 0)
+            exit(-1);
+        return 0;
+#else
+        fprintf(stderr, "%s: readvcd built without FST support\n", fn);
+        exit(-1);
+#endif
+    }
 
+    //  open file
+    fd = open(fn, O_RDONLY);
+    if (fd < 0) {
+        perror(fn);
+        exit(-1);
+    }
 
-//  hash table; contains an index to *var array
-#define ID_HASH_MAX (96 * 96 * 96)
-size_t *id_hash = NULL;
+    buf_sz = 4 * READ_SZ;
+    buf_n = 0;
+    buf = malloc(buf_sz + 1);
+    if (buf == NULL)
+        exit(-1);
 
-static int id_hash3(const char *id)
-{
-    int a, b, c;
-
-    a = id[0];
-    if (a < 0x20 || a > 0x7F) {
-        a = 0;
-        b = 0;
-        c = 0;
-    } else {
-        a -= 0x20;
-        b = id[1];
-        if (b < 0x20 || b > 0x7F) {
-            b = 0;
-            c = 0;
-        } else {
-            b -= 0x20;
-            c = id[2];
-            if (c < 0x20 || c > 0x7F) {
-                c = 0;
-            } else {
-                c -= 0x20;
-            }
+    vcd_str_init(&st, fn, stdout, timing, thresh, dump_tim);
+    vcd_str_model(&st, pm.w_fn, pm.hw);
+    vcd_str_step(&st, pm.step);
+    vcd_str_clock(&st, pm.clk_g, pm.edge, pm.rf);
+
+    for (;;) {
+        if (buf_sz - buf_n < READ_SZ) {
+            buf_sz <<= 1;
+            buf = realloc(buf, buf_sz + 1);
+            if (buf == NULL)
+                exit(-1);
         }
+        r = read(fd, buf + buf_n, buf_sz - buf_n);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            break;
+        buf_n += r;
+        n = vcd_str_feed(&st, buf, buf_n);
+        buf_n -= n;
+        memmove(buf, buf + n, buf_n);
     }
+    vcd_str_end(&st, buf, buf_n);
 
-    return (96 * a + b) * 96 + c;
-}
+    free(buf);
+    close(fd);
 
-//  comparator signal names via offs table
-int offs_cmp(const void *pa, const void *pb)
-{
-    return strcmp( &signame[*((size_t *) pa)], &signame[*((size_t *) pb)] );
+    return 0;
 }
 
-size_t *offs = NULL;    //  sorted offsets in signal names
-size_t offs_n = 0;
-size_t offs_max = 0;
-
-//  signal states
-var_t *var = NULL;
-size_t var_n = 0;
+//  === service mode: many streams multiplexed on an epoll thread pool
+
+typedef struct svc_s {
+    vcd_str_t   st;             //  parser state
+    char        *fn;            //  input (usually a fifo)
+    char        *out_fn;        //  toggle output
+    int         fd;
+    bool        poll;           //  registered with epoll (else ready list)
+    bool        fst;            //  FST file, read in one go
+    char        *buf;           //  line buffer
+    size_t      buf_sz, buf_n;
+    struct svc_s *next;         //  ready list
+} svc_t;
+
+static struct {
+    const char  *timing;
+    int64_t     thresh;
+    const int64_t *dump_tim;
+    int         epfd;           //  epoll instance
+    int         evfd;           //  eventfd: ready list non-empty / quit
+    pthread_mutex_t lock;
+    pthread_cond_t  done;
+    svc_t       *ready;         //  streams that can't be polled (files)
+    size_t      active;         //  open streams
+    bool        quit;
+} svc = {
+    .lock   = PTHREAD_MUTEX_INITIALIZER,
+    .done   = PTHREAD_COND_INITIALIZER
+};
+
+//  wake up workers (lock must be held)
+
+static void svc_signal(void)
+{
+    uint64_t one = 1;
 
-int max_dim = 0;        //  largest signal width
-size_t st_sz = 0;       //  total number of state bits
+    if (write(svc.evfd, &one, sizeof(one)) != sizeof(one))
+        perror("eventfd");
+}
 
-static var_t *find_id(const char *id)
+static void svc_push(svc_t *s)
 {
-    int x;
-    size_t i;
-
-    i = id_hash[id_hash3(id)];
-
-    while (i < ID_HASH_MAX) {
-        x = strcmp(var[i].id, id);
-        if (x == 0)
-            return &var[i];
-        if (x > 0)
-            return NULL;
-        i++;
-    }
-    return NULL;
+    pthread_mutex_lock(&svc.lock);
+    s->next = svc.ready;
+    svc.ready = s;
+    svc_signal();
+    pthread_mutex_unlock(&svc.lock);
 }
 
-//  read a binary number
-
-int64_t bin_to_int(const char *s, int d)
+static void svc_close(svc_t *s)
 {
-    int64_t i, x;
-
-    x = 0;
-    for (i = 0; i < d; i++) {
-        if (s[i] != '0' && s[i] != '1')
-            return -1;
-        x = (2 * x) + (s[i] - '0');
-    }
-
-    return x;
+    if (!s->fst)
+        vcd_str_end(&s->st, s->buf, s->buf_n);
+    fclose(s->st.out);
+    close(s->fd);
+    fprintf(stderr, "[done] %s -> %s (%lu lines)\n",
+            s->fn, s->out_fn, s->st.line);
+
+    free(s->buf);
+    free(s->fn);
+    free(s->out_fn);
+    free(s);
+
+    pthread_mutex_lock(&svc.lock);
+    svc.active--;
+    pthread_cond_signal(&svc.done);
+    pthread_mutex_unlock(&svc.lock);
 }
 
-char *get_signame(const var_t *v)
-{
-    int i;
-    char *s;
+//  process whatever is available on a stream; false at end of stream
 
-    s = &signame[offs[v->o]];
-    i = strlen(s);
-    while (i > 0 && !isspace(s[i - 1])) {
-        i--;
+static bool svc_read(svc_t *s)
+{
+    size_t  tot, n;
+    ssize_t r;
+
+#ifdef VCD_FST
+    //  not a stream format; holds a worker until done
+    if (s->fst) {
+        if (vcd_fst_read(&s->st, s->fn) != 0)
+            vcd_str_end(&s->st, s->buf, 0);
+        return false;
+    }
+#endif
+
+    tot = 0;
+    while (tot < SLICE_MAX) {
+        if (s->buf_sz - s->buf_n < READ_SZ) {
+            s->buf_sz <<= 1;
+            s->buf = realloc(s->buf, s->buf_sz + 1);
+            if (s->buf == NULL)
+                exit(-1);
+        }
+        r = read(s->fd, s->buf + s->buf_n, s->buf_sz - s->buf_n);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN)
+                return true;
+            perror(s->fn);
+            return false;
+        }
+        if (r == 0)
+            return false;
+        s->buf_n += r;
+        tot += r;
+        n = vcd_str_feed(&s->st, s->buf, s->buf_n);
+        s->buf_n -= n;
+        memmove(s->buf, s->buf + n, s->buf_n);
     }
-    return &s[i];
+    return true;
 }
 
-int read_vcd(const char *fn, const char *timing,
-                int64_t thresh, int64_t *dump_tim)
+static void *svc_worker(void *arg)
 {
-    FILE *fp = NULL;
-    int     fail = 0;
-    uint64_t line = 0;
-    char    buf[LINE_SZ_MAX] = "";
-    char    *tok[TOKEN_MAX];
-    size_t  len[SCOPE_MAX];
-    char    nam[LINE_SZ_MAX];
-    char    tmp[2 * ID_SZ_MAX];
-
-    char    *state = NULL;      //  state array
-    char    *chg = NULL;        //  change line buffer
-
-    //  read the actual changes
-    int64_t tim = 0;            //  current time step
-    int64_t cyc = 0, ncyc = 0;  //  cycle counter (from signals)
-    int64_t hd = 0;             //  hamming distance at time step
-    int64_t sd = 0;             //  hamming distance of signal
-    int64_t bl = 0;             //  number of bits in time step
-
-    bool    sigd = false;       //  dump signal changes?
-    var_t   *cyc_v = NULL;      //  signal vith cycle counter
-
-    size_t i, j, l, n;
-    int x, y, k, d, scope;
-    bool flag;
-
-    char *s, *r;
-    var_t *v;                   //  signal variable
+    struct epoll_event ev;
+    svc_t   *s;
+    uint64_t cnt;
+    int     n;
 
-    //  open file
-    fp = fopen(fn, "r");
-    if (fp == NULL) {
-        perror(fn);
-        exit(-1);
-    }
+    (void) arg;
 
-    //  allocate buffers
-    signame_max = 0x100000;     //  initial buffer size for signal names
-    signame_sz = 0;
-    signame = malloc(signame_max);
-    if (signame == NULL)
-        exit(-1);
-
-    offs_max = 0x10000;         //  initiial number of signal names
-    offs_n = 0;
-    offs = calloc(offs_max, sizeof(size_t));
-    if (offs == NULL)
-        exit(-1);
-
-    //  read the preamble
-    scope = 0;
-    k = 0;
-    while(fgets(buf, sizeof(buf), fp) == buf) {
-        line++;
-        n = 0;
-        flag = true;
-        for (i = 0; i < (int) sizeof(buf); i++) {
-            if (buf[i] == 0)
-                break;
-            if (isspace(buf[i])) {
-                flag = true;
-                buf[i] = 0;
-                continue;
-            }
-            if (flag) {
-                tok[n++] = &buf[i];
-                if (n > TOKEN_MAX)
-                    break;
-                flag = false;
-            }
-        }
-/*
-        printf("%lu %d:", line, scope);
-        for (i = 0; i < n; i++) {
-            printf(" <%s>", tok[i]);
-        }
-        printf("\n");
-*/
-        if (n >= 1 && strcmp(tok[0], "$enddefinitions") == 0)
-            break;
-        if (n >= 3 && strcmp(tok[0], "$scope") == 0) {
-            if (scope > SCOPE_MAX)
-                goto wire_too_long;
-            l = strlen(tok[2]);
-            if (k + l + 1 >= LINE_SZ_MAX)
-                goto wire_too_long;
-            len[scope] = l;
-            memcpy(nam + k, tok[2], l);
-            k += l;
-            nam[k++] = '.';
-            nam[k] = 0;
-            scope++;
+    for (;;) {
+        n = epoll_wait(svc.epfd, &ev, 1, -1);
+        if (n < 0 && errno == EINTR)
             continue;
+        if (n < 0) {
+            perror("epoll_wait");
+            break;
         }
-        if (n >= 1 && strcmp(tok[0], "$upscope") == 0) {
-            if (scope >= 1) {
-                scope--;
-                k -= len[scope] + 1;
-                if (k < 0)
-                    k = 0;
-                nam[k] = 0;
-            }
+        if (n == 0)
             continue;
-        }
-        if (n >= 6 && strcmp(tok[0], "$var") == 0) {
-
-            d = atoi(tok[2]);
-            if (d < 0)
-                d = 0;
-            j = k;
-            l = strlen(tok[4]);
-            if (j + l >= (int) sizeof(nam))
-                goto wire_too_long;
-            memcpy(&nam[j], tok[4], l);
-            j += l;
-            if (n >= ID_SZ_MAX - 1) {
-                l = strlen(tok[5]);
-                if (j + l >= (int) sizeof(nam))
-                    goto wire_too_long;
-                memcpy(&nam[j], tok[5], l);
-                j += l;
-            }
-            nam[j] = 0;
-
-            l = strlen(tok[3]);
-            if (signame_sz + j + l + 20 >= signame_max) {
-                signame_max <<= 1;
-                signame = realloc(signame, signame_max);
-                if (signame == NULL)
-                    exit(-1);
-            }
-
-            if (offs_n + 1 >= offs_max) {
-                offs_max <<= 1;
-                offs = realloc(offs, offs_max * sizeof(size_t));
-                if (offs == NULL)
-                    exit(-1);
-            }
-            offs[offs_n++] = signame_sz;
-
-            memcpy(&signame[signame_sz], tok[3], l);
-            signame_sz += l;
-            snprintf(tmp, sizeof(tmp), " %d ", d);
-            l = strlen(tmp);
-            memcpy(&signame[signame_sz], tmp, l);
-            signame_sz += l;
 
-            memcpy(&signame[signame_sz], nam, j);
-            signame_sz += j;
-            signame[signame_sz++] = 0;
-
-            //  shorten the name again
-            nam[k] = 0;
-        }
-    }
-
-    //  sort it
-    qsort(offs, offs_n, sizeof(size_t), offs_cmp);
-
-    st_sz = 0;
-    max_dim = 0;
-
-    var_n = 0;
-    var = calloc(offs_n, sizeof(var_t));
-
-    for (i = 0; i < offs_n; i++) {
-        s = &signame[offs[i]];
-        for (l = 0; l < ID_SZ_MAX; l++) {
-            if (s[l] == ' ' || s[l] == 0)
+        s = (svc_t *) ev.data.ptr;
+        if (s == NULL) {
+            //  eventfd: the ready list or shutdown
+            pthread_mutex_lock(&svc.lock);
+            s = svc.ready;
+            if (s != NULL) {
+                svc.ready = s->next;
+            } else if (svc.quit) {
+                pthread_mutex_unlock(&svc.lock);
                 break;
-        }
-        memcpy(tmp, s, l);
-        memset(tmp + l, 0, 8 - l);
-        d = atoi(&s[l]);
-        if (d < 0)
-            d = 0;
-        if (d > max_dim)
-            max_dim = d;
-
-        if (var_n == 0 || strcmp(var[var_n-1].id, tmp) != 0) {
-            memcpy(var[var_n].id, tmp, 8);
-            var[var_n].n = 1;
-            var[var_n].d = d;
-            st_sz += d;
-            var[var_n].o = i;
-            var[var_n].u = 0;
-            var[var_n].s = NULL;
-            var_n++;
-        } else {
-            if (var[var_n - 1].d != d) {
-                fprintf(stderr, "ERROR  Dimension mismatch: %s %d != %d\n",
-                        tmp, d, var[var_n - 1].d);
             }
-            var[var_n - 1].n++;
+            if (svc.ready == NULL && !svc.quit) {
+                if (read(svc.evfd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+                    perror("eventfd");
+            }
+            pthread_mutex_unlock(&svc.lock);
+            if (s == NULL)
+                continue;
         }
-    }
-
-    //  create a hash table
 
-    id_hash = calloc(ID_HASH_MAX, sizeof(size_t));
-    if (id_hash == NULL)
-        exit(-1);
-    y = 0;
-    j = 0;
-    for (i = 0; i < var_n; i++) {
-        x = id_hash3(var[i].id);
-        if (x > y) {
-            while (y < x) {
-                id_hash[y++] = j;
+        if (!svc_read(s)) {
+            if (s->poll)
+                epoll_ctl(svc.epfd, EPOLL_CTL_DEL, s->fd, NULL);
+            svc_close(s);
+        } else if (s->poll) {
+            ev.events = EPOLLIN | EPOLLONESHOT;
+            ev.data.ptr = s;
+            if (epoll_ctl(svc.epfd, EPOLL_CTL_MOD, s->fd, &ev) != 0) {
+                perror(s->fn);
+                svc_close(s);
             }
-            id_hash[x] = i;
+        } else {
+            svc_push(s);
         }
-        y = x;
-        j = i;
-    }
-    while (y < ID_HASH_MAX) {
-        id_hash[y++] = j;
     }
+    return NULL;
+}
+
+//  output name: "x.vcd" or "x.fst" -> "x.log"
 
-    printf("%s preamble: %lu lines, %lu signames, %lu ids, "
-            "max var %d, tot %zu bits.\n",
-            fn, line, offs_n, var_n, max_dim, st_sz);
+static char *svc_out_fn(const char *fn)
+{
+    char *out;
+    size_t l;
 
-    //  initialize state array
-    state = malloc(st_sz);
-    if (state == NULL)
+    l = strlen(fn);
+    out = malloc(l + 5);
+    if (out == NULL)
         exit(-1);
-    memset(state, 'x', st_sz);
+    memcpy(out, fn, l + 1);
+    if (l > 4 && (strcmp(fn + l - 4, ".vcd") == 0 || is_fst(fn)))
+        l -= 4;
+    strcpy(out + l, ".log");
+    return out;
+}
 
-    s = state;
-    for (i = 0; i < var_n; i++) {
-        var[i].s = s;
-        s += var[i].d;
-    }
+static void svc_add(const char *fn, const char *out_fn)
+{
+    struct epoll_event ev;
+    svc_t   *s;
+    FILE    *out;
 
-    //  change line buffer
-    max_dim += 64;
-    chg = malloc(max_dim);
-    if (chg == NULL)
+    s = calloc(1, sizeof(svc_t));
+    if (s == NULL)
         exit(-1);
+    s->fn = strdup(fn);
+    s->out_fn = out_fn != NULL ? strdup(out_fn) : svc_out_fn(fn);
+    if (s->fn == NULL || s->out_fn == NULL)
+        exit(-1);
+    s->fst = is_fst(fn);
+#ifndef VCD_FST
+    if (s->fst) {
+        fprintf(stderr, "%s: readvcd built without FST support\n", fn);
+        goto fail;
+    }
+#endif
 
-    //  try to much the timing signal
-    for (i = 0; i < var_n; i++) {
-        s = get_signame(&var[i]);
-        if (strstr(s, timing) != NULL) {
-            printf("[info] timing signal: %s\n", s);
-            cyc_v = &var[i];
-            break;
-        }
+    //  non-blocking open of a fifo succeeds before the writer appears
+    s->fd = open(fn, O_RDONLY | O_NONBLOCK);
+    if (s->fd < 0) {
+        perror(fn);
+        goto fail;
     }
-    if (cyc_v == NULL) {
-        printf("[info] timing signal not found; using ticks: %s\n", timing);
+    out = fopen(s->out_fn, "w");
+    if (out == NULL) {
+        perror(s->out_fn);
+        close(s->fd);
+        goto fail;
     }
+    s->buf_sz = 4 * READ_SZ;
+    s->buf = malloc(s->buf_sz + 1);
+    if (s->buf == NULL)
+        exit(-1);
 
-    //  read the actual changes
-    hd  = 0;        //  hamming distance
-    tim = 0;
-    cyc = -1;
-
-    while (fgets(chg, max_dim, fp) == chg) {
+    fprintf(out, "[info] toggle threshold: %ld\n", svc.thresh);
+    vcd_str_init(&s->st, s->fn, out, svc.timing, svc.thresh, svc.dump_tim);
+    vcd_str_model(&s->st, pm.w_fn, pm.hw);
+    vcd_str_step(&s->st, pm.step);
+    vcd_str_clock(&s->st, pm.clk_g, pm.edge, pm.rf);
+
+    pthread_mutex_lock(&svc.lock);
+    svc.active++;
+    pthread_mutex_unlock(&svc.lock);
+    fprintf(stderr, "[open] %s -> %s\n", s->fn, s->out_fn);
+
+    //  a worker may pick it up right away
+    s->poll = true;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = s;
+    if (epoll_ctl(svc.epfd, EPOLL_CTL_ADD, s->fd, &ev) == 0)
+        return;
+    if (errno != EPERM) {
+        perror(fn);
+        exit(-1);
+    }
 
-        line++;
-        if (chg[0] == 0 || chg[0] == '\n')
-            continue;
+    //  regular files can't be polled; always ready
+    s->poll = false;
+    fcntl(s->fd, F_SETFL, fcntl(s->fd, F_GETFL) & ~O_NONBLOCK);
+    svc_push(s);
+    return;
 
-        //  new time
-        if (chg[0] == '#') {
-            tim = (int64_t) atoll(&chg[1]);
-            if (cyc_v == NULL) {
-                ncyc    = tim;
-            }
-            goto new_time;
-        }
+fail:
+    free(s->fn);
+    free(s->out_fn);
+    free(s);
+}
 
-        s = chg;        //  bit data
-        r = s;          //  signal name
-        d = 0;          //  length of bit data
-
-        if (chg[0] == '0' || chg[0] == '1') {
-            d = 1;
-            s = chg;
-            r = chg + 1;
-        } else if (chg[0] == 'b' || chg[0] == 'B') {
-            s++;
-            d = 0;
-            while(s[d] == '0' || s[d] == '1')
-                d++;
-            r = s + d;
-            while(*r == ' ')
-                r++;
-        } else {
-            fprintf(stderr, "%s:%lu ERROR  format: %s\n",
-                    fn, line, chg);
-            continue;
-        }
+//  read "<file.vcd> [output]" lines until end of input
 
-        for (i = 0; i < ID_SZ_MAX - 1; i++) {
-            if (isspace(r[i]))
-                break;
-        }
-        r[i] = 0;
+static void svc_add_lines(FILE *fp)
+{
+    char buf[LINE_SZ_MAX];
+    char *tok[2], *p;
+    int n;
 
-        v = find_id(r);
-        if (v == NULL) {
-            fprintf(stderr, "%s:%lu ERROR  id %s not found: %s\n",
-                    fn, line, r, chg);
-            continue;
+    while (fgets(buf, sizeof(buf), fp) == buf) {
+        n = 0;
+        p = strtok(buf, " \t\r\n");
+        while (p != NULL && n < 2) {
+            tok[n++] = p;
+            p = strtok(NULL, " \t\r\n");
         }
-        if (d != v->d) {
-            fprintf(stderr, "%s:%lu ERROR  wrong dimension (%d): %s\n",
-                    fn, line, v->d, chg);
+        if (n == 0 || tok[0][0] == '#')
             continue;
-        }
+        svc_add(tok[0], n > 1 ? tok[1] : NULL);
+    }
+}
 
-        if (v->u > 0) {
-            sd = 0;
-            for (i = 0; i < (size_t) d; i++) {
-                if (v->s[i] != s[i]) {
-                    sd++;
-                }
-                v->s[i] = s[i];
-            }
+static int read_svc(int nthr, const char *timing, int64_t thresh,
+                    int argc, char **argv)
+{
+    pthread_t   thr[THREAD_MAX];
+    struct epoll_event ev;
+    bool        from_stdin = false;
+    int         i;
+
+    svc.timing  = timing;
+    svc.thresh  = thresh;
+    svc.dump_tim = NULL;
+
+    svc.epfd = epoll_create1(0);
+    svc.evfd = eventfd(0, EFD_NONBLOCK);
+    if (svc.epfd < 0 || svc.evfd < 0) {
+        perror("epoll");
+        exit(-1);
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(svc.epfd, EPOLL_CTL_ADD, svc.evfd, &ev);
 
-            if (sigd && sd >= thresh) {
-                printf("[sigd] %8ld  %ld_%s\n", sd, cyc, get_signame(v));
-            }
-            bl += d;
-            hd += sd;
-        } else {
-            memcpy(v->s, s, d);
-        }
-        v->u++;
+    printf("[info] service: %d threads, toggle threshold: %ld\n",
+            nthr, thresh);
+    fflush(stdout);
 
-        //  a cycle counter signal?
-        if (cyc_v != NULL && v == cyc_v) {
-            ncyc    = bin_to_int(s, d);
+    for (i = 0; i < nthr; i++) {
+        if (pthread_create(&thr[i], NULL, svc_worker, NULL) != 0) {
+            perror("pthread_create");
+            exit(-1);
         }
+    }
 
-    new_time:
-
-        if (ncyc > cyc) {
-            if (cyc >= 0 && hd >= thresh) {
-                printf("#%8ld [togd]  %ld\n", cyc, hd);
-                hd = 0;
-                bl = 0;
-            }
-            cyc = ncyc;
-
-            //  is this one of the "dump cycles"
-            if (dump_tim != NULL) {
-                sigd = false;
-                i = 0;
-                while (dump_tim[i] >= 0 && !sigd) {
-                    sigd = (dump_tim[i++] == cyc);
-                }
-            }
-        }
+    for (i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-") == 0)
+            from_stdin = true;
+        else
+            svc_add(argv[i], NULL);
     }
-    printf("%s total: %lu lines, last time %ld  cycle %ld.\n",
-        fn, line, tim, cyc);
+    if (from_stdin)
+        svc_add_lines(stdin);
 
-    free(signame);
-    free(offs);
-    free(var);
-    free(id_hash);
-    free(state);
-    free(chg);
-    fclose(fp);
+    //  wait until all streams are finished
+    pthread_mutex_lock(&svc.lock);
+    while (svc.active > 0)
+        pthread_cond_wait(&svc.done, &svc.lock);
+    svc.quit = true;
+    svc_signal();
+    pthread_mutex_unlock(&svc.lock);
 
-    return fail;
+    for (i = 0; i < nthr; i++)
+        pthread_join(thr[i], NULL);
+
+    close(svc.evfd);
+    close(svc.epfd);
 
-wire_too_long:
-    fprintf(stderr, "%s:%lu  Parse error -- wire name too long.\n",
-            fn, line);
-    exit(0);
+    return 0;
 }
 
 //  main
@@ -514,9 +460,75 @@ int main(int argc, char **argv)
     int64_t *dump_tim = NULL;
     int64_t thresh = 1;
 
+    //  power model options come first
+    while (argc >= 2) {
+        if (argc >= 3 && strcmp(argv[1], "-w") == 0) {
+            pm.w_fn = argv[2];
+            argc -= 2;
+            argv += 2;
+        } else if (strcmp(argv[1], "-hw") == 0) {
+            pm.hw = true;
+            argc--;
+            argv++;
+        } else if (argc >= 3 && strcmp(argv[1], "-clk") == 0) {
+            pm.clk_g = argv[2];
+            argc -= 2;
+            argv += 2;
+        } else if (strcmp(argv[1], "-e") == 0) {
+            pm.edge = true;
+            argc--;
+            argv++;
+        } else if (strcmp(argv[1], "-rf") == 0) {
+            pm.rf = true;
+            argc--;
+            argv++;
+        } else if (strcmp(argv[1], "-s") == 0) {
+            pm.step = true;
+            argc--;
+            argv++;
+        } else {
+            break;
+        }
+    }
+    if ((pm.edge || pm.rf) && pm.clk_g == NULL) {
+        fprintf(stderr, "readvcd: -e and -rf need the clock nets (-clk)\n");
+        return 1;
+    }
+
+    //  service mode
+    if (argc >= 5 && strcmp(argv[1], "-m") == 0) {
+        i = atoi(argv[2]);
+        if (i < 1)
+            i = 1;
+        if (i > THREAD_MAX)
+            i = THREAD_MAX;
+        thresh = strtoll(argv[4], NULL, 0);
+        fail += read_svc(i, argv[3], thresh, argc - 5, argv + 5);
+        vcd_hdr_free_all();
+        return fail;
+    }
+
     if (argc < 3) {
-        fprintf(stderr, "Usage: readvcd <file.vcd> <time signal>"
-                        " [threshold] [report cycles]\n");
+        fprintf(stderr, "Usage: readvcd [model] [clock] <file.vcd> <time signal>"
+                        " [threshold] [report cycles]\n"
+                        "       readvcd [model] [clock] -m <threads> <time signal>"
+                        " <threshold> [file.vcd | -] ..\n"
+                        "Power model:\n"
+                        "\t-w <fn>\tper-signal weights: \"<glob> <weight>\""
+                        " per line, last match wins\n"
+                        "\t-hw\tweight of new values instead of toggles\n"
+                        "Clock and time steps:\n"
+                        "\t-clk <g,..>\tclock nets: globs over full names\n"
+                        "\t-e\tone dump per cycle (mldsa_wrap -edge); a"
+                        " high clock net\n\t\tcounts as a rise and a fall\n"
+                        "\t-rf\ttotal, rise and fall toggles per cycle\n"
+                        "\t-s\tapply the changes of a time step when it"
+                        " ends (always for FST)\n"
+                        "Files ending in .fst are read as FST"
+#ifndef VCD_FST
+                        " (not in this build)"
+#endif
+                        ".\n");
         return fail;
     }
     if (argc > 3) {
@@ -543,6 +555,7 @@ int main(int argc, char **argv)
 
     //  read the file
     fail += read_vcd(argv[1], argv[2], thresh, dump_tim);
+    vcd_hdr_free_all();
 
     if (dump_tim != NULL) {
         free(dump_tim);
@@ -550,4 +563,3 @@ int main(int argc, char **argv)
 
     return fail;
 }
-
@@ -0,0 +1,490 @@
+//  scope.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Synthetic oscilloscope: noise, low-pass, resampling, ADC.
+
+//  Turns the exact per-cycle toggle counts of a campaign store into what
+//  a bench measurement might look like, as a new store. Per trace:
+//
+//      toggles -> hold for 1 cycle at u = ceil(spc) samples per cycle
+//              -> low-pass (one-pole IIR stages, FIR) -> resample to spc
+//              -> + gaussian noise -> ADC (bits, range)
+//
+//  The store is cycle-major, so the 256 traces of a tile are processed
+//  side by side as one vector while streaming along the cycle axis; each
+//  thread owns whole tiles. The noise of trace i depends only on the seed
+//  and i, never on the thread count.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "accum.h"
+
+#define SCOPE_IIR   4               //  max one-pole stages
+#define SCOPE_FIR   1024            //  max FIR taps
+
+typedef struct {
+    const trs_t *in;
+    trs_t       *out;
+    int64_t     ncyc;               //  output samples per trace
+    double      spc;                //  samples per cycle
+    int         u;                  //  internal rate (per cycle)
+    int         n_iir;
+    double      iir[SCOPE_IIR];     //  one-pole coefficients
+    int         n_fir;
+    double      *fir;               //  taps at the internal rate
+    double      sigma;              //  noise
+    uint64_t    seed;
+    int         bits;               //  ADC
+    double      lo, hi;             //  ADC input range
+    size_t      next;               //  next tile to claim
+    uint64_t    clip;               //  samples outside the ADC range
+    pthread_mutex_t lock;
+} scope_t;
+
+const char usage[] =
+    "Usage: scope [options] <in store> <out store>\n\n"
+    "Simulated measurement of the toggle traces in <in store>, written to a\n"
+    "new (uncompressed) store. Output sample k is at cycle cyc0 + k / spc.\n\n"
+    "\t-p\t<spc>\tsamples per cycle (default 1)\n"
+    "\t-f\t<tau>\tlow-pass: one-pole IIR stage, time constant in cycles\n"
+    "\t\t\t(up to 4 stages)\n"
+    "\t-F\t<fn>\tlow-pass: FIR taps at ceil(spc) samples per cycle\n"
+    "\t-n\t<sigma>\tgaussian noise, in toggles (default 0)\n"
+    "\t-s\t<seed>\tnoise seed (default 0)\n"
+    "\t-b\t<bits>\tADC resolution (default 12)\n"
+    "\t-v\t<lo:hi>\tADC input range in toggles\n"
+    "\t\t\t(default -4 sigma : input max + 4 sigma)\n"
+    "\t-t\t<n>\tthreads (default: all processors)\n";
+
+//  === noise: splitmix64 per trace, box-muller
+
+//  Branch-free polynomial log and sincos (error < 1e-8) with no 64-bit
+//  integer conversions, so that a row of TRS_TILE normals vectorizes
+//  even on baseline x86-64; the output does not depend on libm.
+
+static inline uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9llu;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBllu;
+    return z ^ (z >> 31);
+}
+
+typedef union {
+    double      d;
+    uint64_t    u;
+} f64_t;
+
+//  uniform in [1, 2) from the top 52 bits
+
+static inline double u12(uint64_t r)
+{
+    f64_t x;
+
+    x.u = 0x3FF0000000000000llu | (r >> 12);
+    return x.d;
+}
+
+//  round to nearest even, |x| < 2^51
+
+static inline double rnd(double x)
+{
+    return (x + 0x1.8p52) - 0x1.8p52;
+}
+
+//  log(u), u in (0, 1]
+
+static inline double log_01(double u)
+{
+    f64_t   x, y;
+    double  e, m, s, z;
+
+    x.d = u;
+    y.u = 0x4330000000000000llu | (x.u >> 52);  //  2^52 + exponent
+    e = y.d - 0x1.0p52 - 1023.0;
+    x.u = (x.u & 0x000FFFFFFFFFFFFFllu) | 0x3FF0000000000000llu;
+    m = x.d;                                    //  [1, 2)
+    e += m > M_SQRT2 ? 1.0 : 0.0;
+    m *= m > M_SQRT2 ? 0.5 : 1.0;
+    s = (m - 1.0) / (m + 1.0);                  //  |s| < 0.172
+    z = s * s;
+    return 2.0 * s * (1.0 + z * (1.0 / 3 + z * (1.0 / 5 + z * (1.0 / 7 +
+            z * (1.0 / 9 + z * (1.0 / 11 + z * (1.0 / 13))))))) +
+            M_LN2 * e;
+}
+
+//  (cos, sin) of 2 pi v, v in [0, 1)
+
+static inline void sincos_01(double v, double *c, double *s)
+{
+    double  q, x, z, sx, cx, a, b;
+
+    q = rnd(v * 4.0);                           //  quadrant 0..4
+    x = 2.0 * M_PI * (v - 0.25 * q);            //  |x| <= pi / 4
+    z = x * x;
+    sx = x * (1.0 - z / 6 * (1.0 - z / 20 * (1.0 - z / 42 *
+            (1.0 - z / 72 * (1.0 - z / 110)))));
+    cx = 1.0 - z / 2 * (1.0 - z / 12 * (1.0 - z / 30 *
+            (1.0 - z / 56 * (1.0 - z / 90 * (1.0 - z / 132)))));
+    a = q == 1.0 || q == 3.0 ? sx : cx;
+    b = q == 1.0 || q == 3.0 ? cx : sx;
+    *c = q == 1.0 || q == 2.0 ? -a : a;
+    *s = q == 2.0 || q == 3.0 ? -b : b;
+}
+
+//  === one tile
+
+typedef struct {
+    double      *iir;               //  [SCOPE_IIR][TRS_TILE]
+    double      *hist;              //  FIR history [n_fir][TRS_TILE]
+    double      y[TRS_TILE], prev[TRS_TILE];
+    double      gn[TRS_TILE];       //  noise of the current row
+    double      gn2[TRS_TILE];      //  second normal of each pair
+    uint64_t    rng[TRS_TILE];
+    double      clip[TRS_TILE];     //  clipped samples per lane
+    uint32_t    *ibuf, *obuf;
+} scope_thr_t;
+
+//  noise + ADC of one output row; a new pair of normals every other row
+
+static void scope_adc(const scope_t *sc, scope_thr_t *w, const double *v,
+                        uint32_t *q, bool pair)
+{
+    double  r, c, s, x, sc_q, qmax;
+    uint64_t a, b;
+    size_t  j;
+
+    if (sc->sigma > 0.0 && pair) {
+        for (j = 0; j < TRS_TILE; j++) {
+            a = mix64(w->rng[j] += 0x9E3779B97F4A7C15llu);
+            b = mix64(w->rng[j] += 0x9E3779B97F4A7C15llu);
+            r = sc->sigma * sqrt(-2.0 * log_01(2.0 - u12(a)));
+            sincos_01(u12(b) - 1.0, &c, &s);
+            w->gn[j] = r * c;
+            w->gn2[j] = r * s;
+        }
+    } else if (sc->sigma > 0.0) {
+        memcpy(w->gn, w->gn2, sizeof(w->gn));
+    }
+
+    qmax = (double) ((1llu << sc->bits) - 1);
+    sc_q = qmax / (sc->hi - sc->lo);
+    for (j = 0; j < TRS_TILE; j++) {
+        x = rnd((v[j] + w->gn[j] - sc->lo) * sc_q);
+        w->clip[j] += (x < 0.0 ? 1.0 : 0.0) + (x > qmax ? 1.0 : 0.0);
+        x = x < 0.0 ? 0.0 : x;
+        x = x > qmax ? qmax : x;
+        q[j] = (uint32_t) (int32_t) (x - 0x1.0p31) + 0x80000000u;
+    }
+}
+
+static int scope_tile(const scope_t *sc, scope_thr_t *w, size_t tile)
+{
+    const trs_t *t = sc->in;
+    const uint32_t *x;
+    double  *s, *h;
+    size_t  m, chk, rows, r, j, l, pos = 0, orow = 0, ochk = 0;
+    int64_t i = 0, k = 0;
+    double  tk, f;
+    int     u, st;
+
+    m = t->hdr.n - tile * TRS_TILE;
+    if (m > TRS_TILE)
+        m = TRS_TILE;
+    for (j = 0; j < TRS_TILE; j++)
+        w->rng[j] = mix64(sc->seed ^ mix64(tile * TRS_TILE + j + 1));
+
+    for (chk = 0; chk < trs_nchk(t); chk++) {
+        trs_chunk(t, tile, chk, w->ibuf, &rows);
+
+        for (r = 0; r < rows; r++) {
+            x = w->ibuf + r * TRS_TILE;
+
+            //  start of the trace: filters settled at the first value
+            if (i == 0) {
+                for (st = 0; st < sc->n_iir; st++) {
+                    for (j = 0; j < TRS_TILE; j++)
+                        w->iir[st * TRS_TILE + j] = x[j];
+                }
+                for (l = 0; l < (size_t) sc->n_fir; l++) {
+                    for (j = 0; j < TRS_TILE; j++)
+                        w->hist[l * TRS_TILE + j] = x[j];
+                }
+            }
+
+            for (u = 0; u < sc->u; u++, i++) {
+
+                for (j = 0; j < TRS_TILE; j++)
+                    w->y[j] = x[j];
+                for (st = 0; st < sc->n_iir; st++) {
+                    s = w->iir + st * TRS_TILE;
+                    f = sc->iir[st];
+                    for (j = 0; j < TRS_TILE; j++) {
+                        s[j] += f * (w->y[j] - s[j]);
+                        w->y[j] = s[j];
+                    }
+                }
+                if (sc->n_fir > 0) {
+                    h = w->hist + pos * TRS_TILE;
+                    memcpy(h, w->y, sizeof(w->y));
+                    memset(w->y, 0, sizeof(w->y));
+                    for (l = 0; l < (size_t) sc->n_fir; l++) {
+                        h = w->hist + ((pos + sc->n_fir - l) % sc->n_fir) *
+                                        TRS_TILE;
+                        f = sc->fir[l];
+                        for (j = 0; j < TRS_TILE; j++)
+                            w->y[j] += f * h[j];
+                    }
+                    pos = (pos + 1) % sc->n_fir;
+                }
+
+                //  output sample k is at internal time k * u / spc
+                tk = (double) k * sc->u / sc->spc;
+                if (tk <= (double) i && k < sc->ncyc) {
+                    f = tk - (double) (i - 1);
+                    if (f < 1.0) {
+                        for (j = 0; j < TRS_TILE; j++)
+                            w->prev[j] += f * (w->y[j] - w->prev[j]);
+                        scope_adc(sc, w, w->prev,
+                                    w->obuf + orow * TRS_TILE, (k & 1) == 0);
+                    } else {
+                        scope_adc(sc, w, w->y,
+                                    w->obuf + orow * TRS_TILE, (k & 1) == 0);
+                    }
+                    k++;
+                    if (++orow == TRS_ROWS) {
+                        if (trs_bulk_chunk(sc->out, tile, ochk++,
+                                            w->obuf, m) != 0)
+                            return -1;
+                        orow = 0;
+                    }
+                }
+                memcpy(w->prev, w->y, sizeof(w->y));
+            }
+        }
+    }
+    if (orow > 0 && trs_bulk_chunk(sc->out, tile, ochk, w->obuf, m) != 0)
+        return -1;
+
+    return 0;
+}
+
+static void *scope_thread(void *arg)
+{
+    scope_t     *sc = (scope_t *) arg;
+    scope_thr_t *w;
+    size_t      tile, j;
+    uint64_t    clip = 0;
+
+    w = calloc(1, sizeof(scope_thr_t));
+    if (w == NULL)
+        exit(-1);
+    w->iir  = calloc(SCOPE_IIR * TRS_TILE, sizeof(double));
+    w->hist = calloc((sc->n_fir + 1) * TRS_TILE, sizeof(double));
+    w->ibuf = malloc(TRS_ROWS * TRS_TILE * sizeof(uint32_t));
+    w->obuf = calloc(TRS_ROWS * TRS_TILE, sizeof(uint32_t));
+    if (w->iir == NULL || w->hist == NULL ||
+        w->ibuf == NULL || w->obuf == NULL)
+        exit(-1);
+
+    for (;;) {
+        tile = __atomic_fetch_add(&sc->next, 1, __ATOMIC_RELAXED);
+        if (tile >= trs_ntile(sc->in))
+            break;
+        if (scope_tile(sc, w, tile) != 0)
+            exit(1);
+    }
+
+    for (j = 0; j < TRS_TILE; j++)
+        clip += (uint64_t) w->clip[j];
+    pthread_mutex_lock(&sc->lock);
+    sc->clip += clip;
+    pthread_mutex_unlock(&sc->lock);
+
+    free(w->iir);
+    free(w->hist);
+    free(w->ibuf);
+    free(w->obuf);
+    free(w);
+    return NULL;
+}
+
+//  === default ADC range: input maximum
+
+static double in_max[256];
+
+static void max_blk(void *ctx, const acc_blk_t *b)
+{
+    size_t  j, r;
+    double  x = in_max[b->thr];
+
+    (void) ctx;
+    for (j = 0; j < b->m; j++) {
+        for (r = 0; r < b->rows; r++) {
+            if (b->x[j * ACC_LD + r] > x)
+                x = b->x[j * ACC_LD + r];
+        }
+    }
+    in_max[b->thr] = x;
+}
+
+static int read_fir(scope_t *sc, const char *fn)
+{
+    char    buf[256];
+    FILE    *fp;
+
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    sc->fir = calloc(SCOPE_FIR, sizeof(double));
+    if (sc->fir == NULL)
+        exit(-1);
+    sc->n_fir = 0;
+    while (sc->n_fir < SCOPE_FIR && fgets(buf, sizeof(buf), fp) != NULL) {
+        if (buf[strspn(buf, " \t")] == '#' ||
+            buf[strspn(buf, " \t\r\n")] == 0)
+            continue;
+        sc->fir[sc->n_fir++] = strtod(buf, NULL);
+    }
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    scope_t     sc;
+    trs_t       *t;
+    trs_meta_t  *meta;
+    acc_sel_t   sel;
+    pthread_t   *th;
+    const char  *in_fn = NULL, *out_fn = NULL, *vr = NULL;
+    int         nthr = acc_nthr(), i;
+    double      tau, x;
+    char        *p;
+
+    memset(&sc, 0, sizeof(sc));
+    sc.spc  = 1.0;
+    sc.bits = 12;
+    pthread_mutex_init(&sc.lock, NULL);
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            sc.spc = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+            tau = strtod(argv[++i], NULL);
+            if (sc.n_iir >= SCOPE_IIR || tau <= 0.0) {
+                fputs(usage, stderr);
+                return 1;
+            }
+            sc.iir[sc.n_iir++] = tau;
+        } else if (i + 1 < argc && strcmp(argv[i], "-F") == 0) {
+            if (read_fir(&sc, argv[++i]) != 0)
+                return 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            sc.sigma = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            sc.seed = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+            sc.bits = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-v") == 0) {
+            vr = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            nthr = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && in_fn == NULL) {
+            in_fn = argv[i];
+        } else if (argv[i][0] != '-' && out_fn == NULL) {
+            out_fn = argv[i];
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (out_fn == NULL || sc.spc <= 0.0 || sc.spc > 256.0 ||
+        sc.bits < 1 || sc.bits > 32 || sc.sigma < 0.0) {
+        fputs(usage, stderr);
+        return 1;
+    }
+    if (nthr < 1)
+        nthr = 1;
+    if (nthr > 256)
+        nthr = 256;
+
+    t = trs_open(in_fn, false);
+    if (t == NULL)
+        return 1;
+
+    //  internal rate; tau in cycles -> coefficient per internal sample
+    sc.u = (int) ceil(sc.spc);
+    for (i = 0; i < sc.n_iir; i++)
+        sc.iir[i] = 1.0 - exp(-1.0 / (sc.iir[i] * sc.u));
+    sc.ncyc = (int64_t) floor((t->hdr.ncyc * sc.u - 1) * sc.spc / sc.u) + 1;
+
+    //  ADC range
+    sc.lo = -4.0 * sc.sigma;
+    if (vr != NULL) {
+        sc.lo = strtod(vr, &p);
+        sc.hi = *p == ':' ? strtod(p + 1, NULL) : sc.lo;
+    } else {
+        acc_sel_init(&sel, t);
+        sel.all = true;
+        acc_scan(t, &sel, nthr, max_blk, NULL);
+        x = 0.0;
+        for (i = 0; i < nthr; i++) {
+            if (in_max[i] > x)
+                x = in_max[i];
+        }
+        sc.hi = x + 4.0 * sc.sigma;
+    }
+    if (sc.hi <= sc.lo) {
+        fprintf(stderr, "%s: empty ADC range %g:%g\n", argv[0], sc.lo, sc.hi);
+        return 1;
+    }
+
+    printf("[info] %lu traces, %ld cycles -> %ld samples (%g per cycle)\n",
+            t->hdr.n, t->hdr.ncyc, sc.ncyc, sc.spc);
+    printf("[info] %d IIR stages, %d FIR taps, noise %g (seed %lu), "
+            "ADC %d bits %g:%g\n", sc.n_iir, sc.n_fir, sc.sigma, sc.seed,
+            sc.bits, sc.lo, sc.hi);
+
+    if (trs_create(out_fn, sc.bits > 16 ? 4 : 2,
+                    (int64_t) llround(t->hdr.cyc0 * sc.spc),
+                    sc.ncyc, false) != 0)
+        return 1;
+    sc.out = trs_open(out_fn, true);
+    sc.in = t;
+    if (sc.out == NULL)
+        return 1;
+
+    th = calloc(nthr, sizeof(pthread_t));
+    if (th == NULL)
+        exit(-1);
+    for (i = 0; i < nthr; i++) {
+        if (pthread_create(&th[i], NULL, scope_thread, &sc) != 0) {
+            perror("pthread_create");
+            exit(-1);
+        }
+    }
+    for (i = 0; i < nthr; i++)
+        pthread_join(th[i], NULL);
+    free(th);
+
+    //  same metadata as the input
+    meta = malloc((t->hdr.n + 1) * sizeof(trs_meta_t));
+    if (meta == NULL)
+        exit(-1);
+    memcpy(meta, t->meta, t->hdr.n * sizeof(trs_meta_t));
+    if (trs_bulk_end(sc.out, t->hdr.n, meta) != 0)
+        return 1;
+    printf("[info] %s: %lu traces, %lu samples clipped\n",
+            out_fn, sc.out->hdr.n, sc.clip);
+
+    free(meta);
+    free(sc.fir);
+    trs_close(sc.out);
+    trs_close(t);
+    return 0;
+}
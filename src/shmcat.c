@@ -0,0 +1,138 @@
+//  shmcat.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Attach to the simulator's shared-memory ring: print toggle lines,
+//      archive the binary records, and/or accumulate statistics.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "shmring.h"
+
+#define REC_MAX     (8 << 20)       //  largest record (with signal diffs)
+
+const char usage[] =
+    "Usage: shmcat [options] <name>\n\n"
+    "Attach to the ring published by mldsa_wrap -shm <name>.\n"
+    "Without options, print records in the readvcd toggle log format.\n\n"
+    "\t-l\t\tlossless: claim a reader slot (simulator may wait)\n"
+    "\t-a\t<fn>\tarchive raw records to a file\n"
+    "\t-s\t\tprint summary statistics at the end\n"
+    "\t-q\t\tdo not print toggle lines\n";
+
+int main(int argc, char **argv)
+{
+    const char  *name = NULL;
+    const char  *arch_fn = NULL;
+    bool        lossless = false;
+    bool        stats = false;
+    bool        quiet = false;
+    FILE        *arch = NULL;
+    shmr_hdr_t  *r;
+    shmr_rec_t  *rec;
+    uint8_t     *buf;
+    uint64_t    pos;
+    int64_t     len;
+    int         slot, i;
+
+    //  statistics
+    uint64_t    n_cyc = 0, n_seq = 0, n_sig = 0, n_ovr = 0;
+    int64_t     tog_sum = 0, tog_max = 0, cyc_max = -1;
+    double      tog_sq = 0.0;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0) {
+            lossless = true;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-a") == 0) {
+            arch_fn = argv[++i];
+        } else if (argv[i][0] != '-' && name == NULL) {
+            name = argv[i];
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (name == NULL) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (arch_fn != NULL) {
+        arch = fopen(arch_fn, "w");
+        if (arch == NULL) {
+            perror(arch_fn);
+            return 1;
+        }
+    }
+    buf = malloc(REC_MAX);
+    if (buf == NULL)
+        exit(-1);
+    rec = (shmr_rec_t *) buf;
+
+    r = shmr_attach(name, lossless, &slot, &pos);
+    if (r == NULL)
+        return 1;
+    fprintf(stderr, "[info] %s: ring %lu bytes, slot %d\n",
+            name, r->size, slot);
+
+    for (;;) {
+        len = shmr_get(r, slot, &pos, buf, REC_MAX);
+        if (len == 0) {
+            usleep(100);
+            continue;
+        }
+        if (len < 0) {
+            n_ovr++;
+            continue;
+        }
+        if (arch != NULL)
+            fwrite(buf, 1, len, arch);
+
+        if (rec->type == SHMR_END)
+            break;
+
+        if (rec->type == SHMR_CYC) {
+            n_cyc++;
+            n_sig += rec->nd;
+            tog_sum += rec->val;
+            tog_sq += (double) rec->val * (double) rec->val;
+            if (rec->val > tog_max)
+                tog_max = rec->val;
+            if (rec->cyc > cyc_max)
+                cyc_max = rec->cyc;
+            if (!quiet)
+                printf("#%8ld [togd]  %ld\n", rec->cyc, rec->val);
+        } else if (rec->type == SHMR_SEQ) {
+            n_seq++;
+            if (!quiet)
+                printf("#%8ld [%s] %4ld\n", rec->cyc,
+                        rec->unit ? "sec " : "prim", rec->val);
+        }
+    }
+    shmr_detach(r, slot);
+
+    if (arch != NULL)
+        fclose(arch);
+    free(buf);
+
+    if (stats) {
+        printf("[stat] cycles %lu, last %ld, seq events %lu, "
+                "signal diffs %lu, overruns %lu\n",
+                n_cyc, cyc_max, n_seq, n_sig, n_ovr);
+        if (n_cyc > 0) {
+            double avg = (double) tog_sum / n_cyc;
+            double var = tog_sq / n_cyc - avg * avg;
+            printf("[stat] toggles: total %ld, avg %.2f, std %.2f, max %ld\n",
+                    tog_sum, avg, var > 0.0 ? sqrt(var) : 0.0, tog_max);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,345 @@
+//  shmring.h
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Shared-memory single-producer / multi-consumer record ring.
+
+//  The simulator publishes binary per-cycle records into a POSIX shared
+//  memory segment; any number of readers attach to it without locks.
+//  By default the producer never blocks (a slow reader sees an overrun
+//  and skips ahead); readers that claim a slot are lossless, and the
+//  producer waits for them only when the ring is full. The slot of a
+//  lossless reader that has died is freed by the producer. Header-only
+//  so that both the C++ harness and the C readers can use it.
+
+#ifndef _SHMRING_H_
+#define _SHMRING_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHMR_MAGIC      0x474E495252534241llu   //  "ABRSRING"
+#define SHMR_READERS    16                      //  lossless reader slots
+#define SHMR_SIZE_DEF   (64 << 20)              //  default data size
+
+//  record types
+#define SHMR_PAD        0       //  skip to the start of the data area
+#define SHMR_CYC        1       //  toggles in cycle (+ signal diffs)
+#define SHMR_SEQ        2       //  sequencer event; unit 0=prim, 1=sec
+#define SHMR_END        3       //  producer is done
+
+typedef struct {
+    uint32_t    len;            //  record length in bytes (multiple of 8)
+    uint16_t    type;           //  record type
+    uint16_t    unit;           //  SHMR_SEQ: sequencer unit
+    int64_t     cyc;            //  cycle
+    int64_t     val;            //  SHMR_CYC: toggles, SHMR_SEQ: address
+    uint32_t    nd;             //  number of shmr_sig_t that follow
+    uint32_t    pad;
+} shmr_rec_t;
+
+typedef struct {
+    uint32_t    id;             //  signal (var) index
+    uint32_t    sd;             //  number of bits toggled
+} shmr_sig_t;
+
+typedef struct {
+    uint64_t    pid;            //  reader process; 0 = free
+    uint64_t    pos;            //  read position
+    uint64_t    pad[6];
+} shmr_slot_t;
+
+typedef struct {
+    uint64_t    magic;          //  set last by the producer
+    uint64_t    size;           //  size of data area (power of two)
+    uint64_t    wait;           //  start once this many readers attached
+    uint64_t    pad0[5];
+    uint64_t    head;           //  end of published records
+    uint64_t    wpos;           //  end of the record being written
+    uint64_t    pad1[6];
+    shmr_slot_t slot[SHMR_READERS];
+} shmr_hdr_t;
+
+//  data area follows the header
+static inline uint8_t *shmr_data(shmr_hdr_t *r)
+{
+    return ((uint8_t *) r) + sizeof(shmr_hdr_t);
+}
+
+static inline uint64_t shmr_ld(const uint64_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void shmr_st(uint64_t *p, uint64_t x)
+{
+    __atomic_store_n(p, x, __ATOMIC_RELEASE);
+}
+
+//  === producer
+
+//  create a fresh segment; readers of a previous one keep their mapping
+
+static inline shmr_hdr_t *shmr_create(const char *name, size_t size,
+                                        int wait)
+{
+    shmr_hdr_t *r;
+    size_t  sz;
+    int     fd;
+
+    sz = 4096;
+    while (sz < size)
+        sz <<= 1;
+
+    shm_unlink(name);
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        perror(name);
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(shmr_hdr_t) + sz) != 0) {
+        perror(name);
+        close(fd);
+        return NULL;
+    }
+    r = (shmr_hdr_t *) mmap(NULL, sizeof(shmr_hdr_t) + sz,
+                            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r == MAP_FAILED) {
+        perror(name);
+        return NULL;
+    }
+    memset(r, 0, sizeof(shmr_hdr_t));
+    r->size = sz;
+    r->wait = wait;
+    shmr_st(&r->magic, SHMR_MAGIC);
+
+    return r;
+}
+
+//  lowest position of an attached lossless reader
+
+static inline uint64_t shmr_tail(shmr_hdr_t *r, uint64_t head)
+{
+    uint64_t t, p;
+    int i;
+
+    t = head;
+    for (i = 0; i < SHMR_READERS; i++) {
+        if (shmr_ld(&r->slot[i].pid) == 0)
+            continue;
+        p = shmr_ld(&r->slot[i].pos);
+        if (p < t)
+            t = p;
+    }
+    return t;
+}
+
+//  wait until the configured number of readers have attached
+
+static inline void shmr_wait_readers(shmr_hdr_t *r)
+{
+    uint64_t n;
+    int i;
+
+    do {
+        n = 0;
+        for (i = 0; i < SHMR_READERS; i++) {
+            if (shmr_ld(&r->slot[i].pid) != 0)
+                n++;
+        }
+        if (n < r->wait)
+            usleep(1000);
+    } while (n < r->wait);
+}
+
+//  free the slots of lossless readers that no longer exist
+
+static inline void shmr_reap(shmr_hdr_t *r)
+{
+    uint64_t pid;
+    int i;
+
+    for (i = 0; i < SHMR_READERS; i++) {
+        pid = shmr_ld(&r->slot[i].pid);
+        if (pid == 0 || kill((pid_t) pid, 0) == 0 || errno != ESRCH)
+            continue;
+        if (__atomic_compare_exchange_n(&r->slot[i].pid, &pid, 0, false,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            fprintf(stderr, "shmr: reader %lu is gone; slot %d freed\n",
+                    (unsigned long) pid, i);
+    }
+}
+
+//  publish a record with "ext" bytes of payload
+
+static inline void shmr_put(shmr_hdr_t *r, shmr_rec_t *rec,
+                            const void *ext, size_t ext_len)
+{
+    uint8_t *d = shmr_data(r);
+    uint64_t head, off, len, need;
+    unsigned n;
+
+    len = (sizeof(shmr_rec_t) + ext_len + 7) & ~((uint64_t) 7);
+    if (len > r->size / 2)              //  can't be represented
+        return;
+    rec->len = len;
+
+    head = r->head;
+    off = head & (r->size - 1);
+    need = off + len > r->size ? r->size - off + len : len;
+
+    //  lossless readers hold back the producer only when full; yield
+    //  first, then sleep, and look for dead readers every ~0.1 s
+    for (n = 0; head + need - shmr_tail(r, head) > r->size; n++) {
+        if (n < 64)
+            sched_yield();
+        else
+            usleep(100);
+        if (n % 1024 == 1023)
+            shmr_reap(r);
+    }
+
+    //  readers validate copies against wpos (a seqlock on positions)
+    shmr_st(&r->wpos, head + need);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (need != len) {
+        ((shmr_rec_t *) (d + off))->len = r->size - off;
+        ((shmr_rec_t *) (d + off))->type = SHMR_PAD;
+        head += r->size - off;
+        off = 0;
+    }
+    memcpy(d + off, rec, sizeof(shmr_rec_t));
+    if (ext_len > 0)
+        memcpy(d + off + sizeof(shmr_rec_t), ext, ext_len);
+
+    shmr_st(&r->head, head + len);
+}
+
+static inline void shmr_close(shmr_hdr_t *r, const char *name)
+{
+    shmr_rec_t rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.type = SHMR_END;
+    shmr_put(r, &rec, NULL, 0);
+    munmap(r, sizeof(shmr_hdr_t) + r->size);
+    shm_unlink(name);
+}
+
+//  === consumer
+
+//  attach (waiting for the segment to appear); *slot >= 0 if lossless
+
+static inline shmr_hdr_t *shmr_attach(const char *name, bool lossless,
+                                        int *slot, uint64_t *pos)
+{
+    shmr_hdr_t *r;
+    struct stat sb;
+    uint64_t zero;
+    int     fd, i;
+
+    for (;;) {
+        fd = shm_open(name, O_RDWR, 0);
+        if (fd >= 0 && fstat(fd, &sb) == 0 &&
+            (size_t) sb.st_size > sizeof(shmr_hdr_t))
+            break;
+        if (fd >= 0)
+            close(fd);
+        usleep(10000);
+    }
+    r = (shmr_hdr_t *) mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+    close(fd);
+    if (r == MAP_FAILED) {
+        perror(name);
+        return NULL;
+    }
+    while (shmr_ld(&r->magic) != SHMR_MAGIC)
+        usleep(1000);
+
+    *slot = -1;
+    *pos = shmr_ld(&r->head);
+    if (!lossless)
+        return r;
+
+    for (i = 0; i < SHMR_READERS; i++) {
+        zero = 0;
+        if (__atomic_compare_exchange_n(&r->slot[i].pid, &zero,
+                (uint64_t) getpid(), false,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *slot = i;
+            //  the producer holds at the old pos of the slot (at most
+            //  the head) until the new one is stored
+            *pos = shmr_ld(&r->head);
+            shmr_st(&r->slot[i].pos, *pos);
+            return r;
+        }
+    }
+    fprintf(stderr, "%s: no free reader slots; attaching lossy\n", name);
+    return r;
+}
+
+//  copy the next record to buf; returns its length, 0 if none is
+//  available yet, -1 on overrun (position is moved to the head)
+
+static inline int64_t shmr_get(shmr_hdr_t *r, int slot, uint64_t *pos,
+                                void *buf, size_t buf_sz)
+{
+    uint8_t *d = shmr_data(r);
+    shmr_rec_t *rec;
+    uint64_t head, off, len;
+
+    for (;;) {
+        head = shmr_ld(&r->head);
+        if (*pos >= head)
+            return 0;
+        if (head - *pos > r->size)
+            goto overrun;
+        off = *pos & (r->size - 1);
+        rec = (shmr_rec_t *) (d + off);
+        len = rec->len;
+        if (rec->type == SHMR_PAD) {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (shmr_ld(&r->wpos) - *pos > r->size)
+                goto overrun;
+            *pos += r->size - off;
+            continue;
+        }
+        if (len < sizeof(shmr_rec_t) || len > buf_sz || off + len > r->size)
+            goto overrun;
+        memcpy(buf, rec, len);
+
+        //  was it overwritten while copying?
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (shmr_ld(&r->wpos) - *pos > r->size)
+            goto overrun;
+        *pos += len;
+        if (slot >= 0)
+            shmr_st(&r->slot[slot].pos, *pos);
+        return len;
+    }
+
+overrun:
+    *pos = shmr_ld(&r->head);
+    if (slot >= 0)
+        shmr_st(&r->slot[slot].pos, *pos);
+    return -1;
+}
+
+static inline void shmr_detach(shmr_hdr_t *r, int slot)
+{
+    if (slot >= 0)
+        shmr_st(&r->slot[slot].pid, 0);
+    munmap(r, sizeof(shmr_hdr_t) + r->size);
+}
+
+#endif
@@ -0,0 +1,534 @@
+//  sigt.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Per-signal fixed-vs-random Welch t-test over a cycle window.
+
+//  Localizes leakage to nets: for each trace (a VCD, read once), the
+//  toggles of every signal (or hierarchy group) inside the cycle window
+//  are counted, and the per-class power sums of these counts give a
+//  Welch t per signal. In a window most of the ~100k ids do not toggle,
+//  so the per-trace counts are flushed through a bit-packed "touched"
+//  set, and only those signals update the class sums. Each thread owns
+//  whole traces and its own sums; they are merged at the end.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "vcd.h"
+#include "accum.h"
+
+#define READ_SZ     0x100000        //  read granularity
+#define SIGT_FIX    0
+#define SIGT_RND    1
+
+//  accumulator layout: n[2], s1[2][ng], s2[2][ng]
+
+typedef struct {
+    const char  *timing;
+    int64_t     cyc0, cyc1;         //  window [cyc0, cyc1)
+    int         depth;              //  group by hierarchy (0: per var)
+
+    //  inputs
+    int         n_in;
+    const char  **in_fn;
+    int         *in_cls;
+    int         next;               //  next input to claim
+
+    //  groups, from the first header seen
+    pthread_mutex_t lock;
+    const vcd_hdr_t *hdr;
+    size_t      ng;                 //  number of groups
+    uint32_t    *grp;               //  group of each var
+    char        **name;             //  name of each group
+
+    acc_t       *a;
+} sigt_t;
+
+typedef struct {
+    sigt_t      *s;
+    vcd_str_t   st;
+    const uint32_t *grp;
+    uint32_t    *cnt;               //  toggles of each group in the trace
+    uint64_t    *hit;               //  touched groups, bit-packed
+    double      *sum;               //  this thread's n, s1, s2
+    double      n[2];               //  traces per class
+    pthread_t   tid;
+} sigt_thr_t;
+
+#define SIGT_N(a)       ((a)->v)
+#define SIGT_S1(a, c)   ((a)->v + 2 + (c) * (a)->hdr.dim)
+#define SIGT_S2(a, c)   ((a)->v + 2 + (2 + (c)) * (a)->hdr.dim)
+
+const char usage[] =
+    "Usage: sigt [options] [-c fix|rnd] <file.vcd | dir> ..\n"
+    "       sigt [options] -m <out.acc> <in.acc> ..\n\n"
+    "Fixed-vs-random Welch t-test of the toggles of each signal in a cycle\n"
+    "window; each VCD (or dir/trace.vcd) is one trace. The class is set by\n"
+    "-c for the inputs that follow, or from \"fix\" / \"rnd\" in the name.\n\n"
+    "\t-w\t<c:d>\tcycle window [c, d] (default: all)\n"
+    "\t-d\t<n>\tgroup signals by the first n levels of hierarchy\n"
+    "\t-T\t<sig>\ttiming signal (default dec_prim.cyc)\n"
+    "\t-t\t<n>\tthreads (default: all processors)\n"
+    "\t-s\t<fn>\tsave the accumulator state (and <fn>.names)\n"
+    "\t-m\t\tmerge saved states instead of reading traces\n"
+    "\t-k\t<n>\treport the n highest |t| (default 20)\n"
+    "\t-o\t<fn>\twrite \"t n_fix mean_fix n_rnd mean_rnd name\" for all\n";
+
+//  === groups
+
+//  first "depth" levels of a hierarchical name (whole name if 0)
+
+static size_t name_pfx(const char *s, int depth)
+{
+    size_t i;
+
+    if (depth <= 0)
+        return strlen(s);
+    for (i = 0; s[i] != 0; i++) {
+        if (s[i] == '.' && --depth == 0)
+            break;
+    }
+    return i;
+}
+
+static int grp_cmp(const void *a, const void *b)
+{
+    const char * const *x = (const char * const *) a;
+    const char * const *y = (const char * const *) b;
+
+    return strcmp(*x, *y);
+}
+
+static void sigt_groups(sigt_t *s, const vcd_hdr_t *hdr)
+{
+    char    **nam;
+    size_t  i, j, l;
+
+    s->hdr = hdr;
+    s->grp = calloc(hdr->var_n + 1, sizeof(uint32_t));
+    nam = calloc(hdr->var_n + 1, sizeof(char *));
+    if (s->grp == NULL || nam == NULL)
+        exit(-1);
+    for (i = 0; i < hdr->var_n; i++) {
+        const char *sn = vcd_signame(hdr, &hdr->var[i]);
+        l = name_pfx(sn, s->depth);
+        nam[i] = strndup(sn, l);
+        if (nam[i] == NULL)
+            exit(-1);
+    }
+
+    //  distinct names, sorted
+    s->name = calloc(hdr->var_n + 1, sizeof(char *));
+    if (s->name == NULL)
+        exit(-1);
+    memcpy(s->name, nam, hdr->var_n * sizeof(char *));
+    qsort(s->name, hdr->var_n, sizeof(char *), grp_cmp);
+    s->ng = 0;
+    for (i = 0; i < hdr->var_n; i++) {
+        if (s->ng == 0 || strcmp(s->name[s->ng - 1], s->name[i]) != 0)
+            s->name[s->ng++] = s->name[i];
+    }
+    for (i = 0; i < hdr->var_n; i++) {
+        j = (char **) bsearch(&nam[i], s->name, s->ng, sizeof(char *),
+                                grp_cmp) - s->name;
+        s->grp[i] = j;
+        if (s->name[j] != nam[i])
+            free(nam[i]);
+    }
+    free(nam);
+
+    //  the requested window: shards merge whatever cycle their traces
+    //  end at (the sums are per signal, not per cycle)
+    s->a = acc_new("sigt", s->cyc0, s->cyc1 - s->cyc0, s->ng, 2 + 4 * s->ng);
+}
+
+//  === one trace
+
+static void sigt_sig(void *arg, const var_t *v, int64_t sd)
+{
+    sigt_thr_t  *w = (sigt_thr_t *) arg;
+    sigt_t      *s = w->s;
+    uint32_t    g;
+
+    if (w->st.cyc < s->cyc0 || w->st.cyc >= s->cyc1)
+        return;
+
+    //  first change seen by this thread: the design's groups
+    if (w->grp == NULL || s->hdr != w->st.hdr) {
+        pthread_mutex_lock(&s->lock);
+        if (s->hdr == NULL)
+            sigt_groups(s, w->st.hdr);
+        pthread_mutex_unlock(&s->lock);
+        if (s->hdr != w->st.hdr) {
+            fprintf(stderr, "%s: not the same design\n", w->st.fn);
+            exit(1);
+        }
+        if (w->grp == NULL) {
+            w->cnt = calloc(s->ng + 1, sizeof(uint32_t));
+            w->hit = calloc(s->ng / 64 + 1, sizeof(uint64_t));
+            w->sum = calloc(2 + 4 * s->ng, sizeof(double));
+            if (w->cnt == NULL || w->hit == NULL || w->sum == NULL)
+                exit(-1);
+            w->grp = s->grp;
+        }
+    }
+
+    g = w->grp[v - w->st.hdr->var];
+    w->cnt[g] += sd;
+    w->hit[g >> 6] |= 1llu << (g & 63);
+}
+
+//  end of a trace: touched groups into the class sums, clear
+
+static void sigt_flush(sigt_thr_t *w, int cls)
+{
+    size_t  ng = w->s->ng, i, g;
+    uint64_t x;
+    double  c, *s1, *s2;
+
+    w->n[cls] += 1.0;
+    if (w->grp == NULL)
+        return;
+    s1 = w->sum + 2 + cls * ng;
+    s2 = w->sum + 2 + (2 + cls) * ng;
+    for (i = 0; i <= ng / 64; i++) {
+        x = w->hit[i];
+        w->hit[i] = 0;
+        while (x != 0) {
+            g = 64 * i + __builtin_ctzll(x);
+            x &= x - 1;
+            c = (double) w->cnt[g];
+            w->cnt[g] = 0;
+            s1[g] += c;
+            s2[g] += c * c;
+        }
+    }
+}
+
+static int sigt_read(sigt_thr_t *w, const char *fn)
+{
+    char    *buf;
+    size_t  buf_sz, buf_n, n;
+    ssize_t r;
+    int     fd;
+
+    fd = open(fn, O_RDONLY);
+    if (fd < 0) {
+        perror(fn);
+        return -1;
+    }
+    buf_sz = 4 * READ_SZ;
+    buf_n = 0;
+    buf = malloc(buf_sz + 1);
+    if (buf == NULL)
+        exit(-1);
+
+    vcd_str_init(&w->st, fn, NULL, w->s->timing, 1, NULL);
+    w->st.sig_fn = sigt_sig;
+    w->st.arg = w;
+
+    for (;;) {
+        if (buf_sz - buf_n < READ_SZ) {
+            buf_sz <<= 1;
+            buf = realloc(buf, buf_sz + 1);
+            if (buf == NULL)
+                exit(-1);
+        }
+        r = read(fd, buf + buf_n, buf_sz - buf_n);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            break;
+        buf_n += r;
+        n = vcd_str_feed(&w->st, buf, buf_n);
+        buf_n -= n;
+        memmove(buf, buf + n, buf_n);
+    }
+    vcd_str_end(&w->st, buf, buf_n);
+
+    free(buf);
+    close(fd);
+    return 0;
+}
+
+static void *sigt_thread(void *arg)
+{
+    sigt_thr_t  *w = (sigt_thr_t *) arg;
+    sigt_t      *s = w->s;
+    int         i;
+
+    for (;;) {
+        i = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED);
+        if (i >= s->n_in)
+            break;
+        if (sigt_read(w, s->in_fn[i]) == 0)
+            sigt_flush(w, s->in_cls[i]);
+    }
+    return NULL;
+}
+
+//  === report
+
+typedef struct {
+    size_t  g;
+    double  t;
+} sigt_top_t;
+
+static int top_cmp(const void *a, const void *b)
+{
+    double x = fabs(((const sigt_top_t *) a)->t);
+    double y = fabs(((const sigt_top_t *) b)->t);
+
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static double welch(const acc_t *a, size_t g, double *m0, double *m1)
+{
+    double  n0 = SIGT_N(a)[0], n1 = SIGT_N(a)[1], v0, v1, d;
+
+    *m0 = n0 > 0.0 ? SIGT_S1(a, 0)[g] / n0 : 0.0;
+    *m1 = n1 > 0.0 ? SIGT_S1(a, 1)[g] / n1 : 0.0;
+    if (n0 < 2.0 || n1 < 2.0)
+        return 0.0;
+    v0 = (SIGT_S2(a, 0)[g] - n0 * *m0 * *m0) / (n0 - 1.0);
+    v1 = (SIGT_S2(a, 1)[g] - n1 * *m1 * *m1) / (n1 - 1.0);
+    d = v0 / n0 + v1 / n1;
+    if (d <= 0.0)
+        return *m0 == *m1 ? 0.0 : copysign(HUGE_VAL, *m0 - *m1);
+    return (*m0 - *m1) / sqrt(d);
+}
+
+static void sigt_report(const acc_t *a, char **name, size_t k,
+                        const char *out_fn)
+{
+    sigt_top_t  *top;
+    FILE        *fp = NULL;
+    size_t      ng = a->hdr.dim, g, nt = 0, nz = 0;
+    double      m0, m1;
+
+    top = calloc(ng + 1, sizeof(sigt_top_t));
+    if (top == NULL)
+        exit(-1);
+    for (g = 0; g < ng; g++) {
+        if (SIGT_S1(a, 0)[g] == 0.0 && SIGT_S1(a, 1)[g] == 0.0)
+            continue;
+        nz++;
+        top[nt].g = g;
+        top[nt].t = welch(a, g, &m0, &m1);
+        nt++;
+    }
+    qsort(top, nt, sizeof(sigt_top_t), top_cmp);
+
+    printf("[info] %.0f fix + %.0f rnd traces, cycles %ld ..", SIGT_N(a)[0],
+            SIGT_N(a)[1], a->hdr.cyc0);
+    if (a->hdr.ncyc < INT64_MAX - a->hdr.cyc0)
+        printf(" %ld", a->hdr.cyc0 + a->hdr.ncyc - 1);
+    printf(", %zu / %zu signals toggled\n", nz, ng);
+
+    if (out_fn != NULL) {
+        fp = fopen(out_fn, "w");
+        if (fp == NULL)
+            perror(out_fn);
+    }
+    for (g = 0; g < nt; g++) {
+        welch(a, top[g].g, &m0, &m1);
+        if (g < k)
+            printf("[sigt] %10.3f  %s\n", top[g].t, name[top[g].g]);
+        if (fp != NULL)
+            fprintf(fp, "%.4f %.0f %.4f %.0f %.4f %s\n", top[g].t,
+                    SIGT_N(a)[0], m0, SIGT_N(a)[1], m1, name[top[g].g]);
+    }
+    if (fp != NULL)
+        fclose(fp);
+    free(top);
+}
+
+//  group names next to a saved state
+
+static int names_save(const char *fn, char **name, size_t ng)
+{
+    char    path[FILENAME_MAX];
+    FILE    *fp;
+    size_t  g;
+
+    snprintf(path, sizeof(path), "%s.names", fn);
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+    for (g = 0; g < ng; g++)
+        fprintf(fp, "%s\n", name[g]);
+    fclose(fp);
+    return 0;
+}
+
+static char **names_load(const char *fn, size_t ng)
+{
+    char    path[FILENAME_MAX], buf[LINE_SZ_MAX];
+    char    **name;
+    FILE    *fp;
+    size_t  g;
+
+    snprintf(path, sizeof(path), "%s.names", fn);
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        perror(path);
+        return NULL;
+    }
+    name = calloc(ng + 1, sizeof(char *));
+    if (name == NULL)
+        exit(-1);
+    for (g = 0; g < ng && fgets(buf, sizeof(buf), fp) != NULL; g++) {
+        buf[strcspn(buf, "\n")] = 0;
+        name[g] = strdup(buf);
+    }
+    fclose(fp);
+    if (g < ng) {
+        fprintf(stderr, "%s: %zu names, expected %zu\n", path, g, ng);
+        return NULL;
+    }
+    return name;
+}
+
+int main(int argc, char **argv)
+{
+    sigt_t      s;
+    sigt_thr_t  *th;
+    struct stat sb;
+    char        path[FILENAME_MAX], *p;
+    const char  *save_fn = NULL, *out_fn = NULL;
+    int         nthr = acc_nthr(), cls = -1, i, j;
+    size_t      k = 20, g;
+    bool        merge = false;
+
+    memset(&s, 0, sizeof(s));
+    s.timing = "dec_prim.cyc";
+    s.cyc1 = INT64_MAX;
+    pthread_mutex_init(&s.lock, NULL);
+    s.in_fn = calloc(argc, sizeof(char *));
+    s.in_cls = calloc(argc, sizeof(int));
+    if (s.in_fn == NULL || s.in_cls == NULL)
+        exit(-1);
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0) {
+            merge = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+            i++;
+            cls = strcmp(argv[i], "fix") == 0 ? SIGT_FIX :
+                    strcmp(argv[i], "rnd") == 0 ? SIGT_RND : -1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-w") == 0) {
+            s.cyc0 = strtoll(argv[++i], &p, 0);
+            s.cyc1 = *p == ':' ? strtoll(p + 1, NULL, 0) + 1 : s.cyc0 + 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            s.depth = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-T") == 0) {
+            s.timing = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            nthr = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            save_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-k") == 0) {
+            k = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (argv[i][0] != '-') {
+            j = cls;
+            if (j < 0)
+                j = strstr(argv[i], "fix") != NULL ? SIGT_FIX :
+                    strstr(argv[i], "rnd") != NULL ? SIGT_RND : -1;
+            if (merge) {
+                s.in_fn[s.n_in++] = argv[i];
+            } else if (j < 0) {
+                fprintf(stderr, "%s: class not known, skipped\n", argv[i]);
+            } else {
+                if (stat(argv[i], &sb) == 0 && S_ISDIR(sb.st_mode)) {
+                    snprintf(path, sizeof(path), "%s/trace.vcd", argv[i]);
+                    s.in_fn[s.n_in] = strdup(path);
+                } else {
+                    s.in_fn[s.n_in] = argv[i];
+                }
+                s.in_cls[s.n_in++] = j;
+            }
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (s.n_in < (merge ? 2 : 1) || s.cyc1 <= s.cyc0) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    //  merge shards: out.acc in.acc ..
+    if (merge) {
+        s.a = acc_merge_files(s.n_in - 1, (char **) s.in_fn + 1);
+        if (s.a == NULL)
+            return 1;
+        if (strcmp(s.a->hdr.kind, "sigt") != 0) {
+            fprintf(stderr, "%s: not a sigt state\n", s.in_fn[1]);
+            return 1;
+        }
+        s.name = names_load(s.in_fn[1], s.a->hdr.dim);
+        if (s.name == NULL)
+            return 1;
+        if (acc_save(s.a, s.in_fn[0]) != 0 ||
+            names_save(s.in_fn[0], s.name, s.a->hdr.dim) != 0)
+            return 1;
+        sigt_report(s.a, s.name, k, out_fn);
+        return 0;
+    }
+
+    if (nthr < 1)
+        nthr = 1;
+    if (nthr > s.n_in)
+        nthr = s.n_in;
+    th = calloc(nthr, sizeof(sigt_thr_t));
+    if (th == NULL)
+        exit(-1);
+    for (i = 0; i < nthr; i++) {
+        th[i].s = &s;
+        if (pthread_create(&th[i].tid, NULL, sigt_thread, &th[i]) != 0) {
+            perror("pthread_create");
+            exit(-1);
+        }
+    }
+    for (i = 0; i < nthr; i++)
+        pthread_join(th[i].tid, NULL);
+
+    if (s.a == NULL) {
+        fprintf(stderr, "%s: no changes in the window\n", argv[0]);
+        return 1;
+    }
+
+    //  merge the threads (integer-valued sums: order does not matter)
+    for (i = 0; i < nthr; i++) {
+        SIGT_N(s.a)[0] += th[i].n[0];
+        SIGT_N(s.a)[1] += th[i].n[1];
+        if (th[i].sum == NULL)
+            continue;
+        for (g = 0; g < 4 * s.ng; g++)
+            s.a->v[2 + g] += th[i].sum[2 + g];
+        free(th[i].cnt);
+        free(th[i].hit);
+        free(th[i].sum);
+    }
+    s.a->hdr.n = (uint64_t) (SIGT_N(s.a)[0] + SIGT_N(s.a)[1]);
+
+    if (save_fn != NULL && (acc_save(s.a, save_fn) != 0 ||
+        names_save(save_fn, s.name, s.ng) != 0))
+        return 1;
+    sigt_report(s.a, s.name, k, out_fn);
+
+    free(th);
+    acc_free(s.a);
+    vcd_hdr_free_all();
+    return 0;
+}
@@ -0,0 +1,309 @@
+//  snr.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Signal-to-noise ratio per cycle, traces grouped by a class label.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "accum.h"
+
+//  per cycle: signal = variance of the class means, noise = mean of the
+//  within-class variances (both weighted by class size); SNR = s / n.
+
+#define SNR_MAXK    65536           //  sanity limit on classes
+
+typedef struct {
+    acc_t       *a;
+    int32_t     *lab;       //  class of each store trace, -1 = none
+    size_t      n_lab;
+    size_t      k;          //  number of classes
+    int64_t     nc;
+} snr_t;
+
+//  accumulator layout: n[k], s1[k][nc], s2[k][nc]
+#define SNR_N(s)    ((s)->a->v)
+#define SNR_S1(s)   ((s)->a->v + (s)->k)
+#define SNR_S2(s)   ((s)->a->v + (s)->k + (s)->k * (s)->nc)
+
+const char usage[] =
+    "Usage: snr [options] <store>\n"
+    "       snr [options] -m <out.acc> <in.acc> ..\n\n"
+    "Per-cycle SNR of the traces in campaign <store>, grouped by the trace\n"
+    "label (trs add: label.txt or -l) or by a label file.\n\n"
+    "\t-l\t<fn>\tlabels: one integer per line, in store order\n"
+    "\t-n\t<k>\tnumber of classes (default: largest label + 1)\n"
+    "\t-t\t<n>\tthreads (default: all processors)\n"
+    "\t-c\t<cls>\tonly traces of class fix, rnd, or kgr\n"
+    "\t-r\t<a:b>\ttrace range\n"
+    "\t-w\t<c:d>\tcycle window\n"
+    "\t-a\t\tinclude runs that timed out\n"
+    "\t-s\t<fn>\tsave the accumulator state\n"
+    "\t-u\t<fn>\tupdate: continue from a saved state, save it back\n"
+    "\t-m\t\tmerge saved states of shards instead of reading a store\n"
+    "\t-k\t<n>\treport the n highest cycles (default 10)\n"
+    "\t-o\t<fn>\twrite \"cycle snr signal noise\" per cycle\n";
+
+static int snr_labels(snr_t *s, const trs_t *t, const char *fn)
+{
+    char    buf[256];
+    FILE    *fp;
+    size_t  i;
+
+    s->n_lab = t->hdr.n;
+    s->lab = malloc((s->n_lab + 1) * sizeof(int32_t));
+    if (s->lab == NULL)
+        exit(-1);
+
+    if (fn == NULL) {
+        for (i = 0; i < s->n_lab; i++)
+            s->lab[i] = t->meta[i].label;
+        return 0;
+    }
+
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    for (i = 0; i < s->n_lab && fgets(buf, sizeof(buf), fp) != NULL; i++)
+        s->lab[i] = atoi(buf);
+    fclose(fp);
+    for (; i < s->n_lab; i++)
+        s->lab[i] = -1;
+    return 0;
+}
+
+static bool snr_keep(void *arg, size_t i)
+{
+    const snr_t *s = (const snr_t *) arg;
+
+    return i < s->n_lab && s->lab[i] >= 0 && (size_t) s->lab[i] < s->k;
+}
+
+//  one chunk of one tile: class sums
+
+static void snr_blk(void *ctx, const acc_blk_t *b)
+{
+    const snr_t *s = (const snr_t *) ctx;
+    const double *x;
+    double  *s1, *s2;
+    size_t  j, r, k;
+
+    for (j = 0; j < b->m; j++) {
+        x = b->x + j * ACC_LD;
+        k = s->lab[b->idx[j]];
+        s1 = SNR_S1(s) + k * s->nc + b->off;
+        s2 = SNR_S2(s) + k * s->nc + b->off;
+        for (r = 0; r < b->rows; r++) {
+            s1[r] += x[r];
+            s2[r] += x[r] * x[r];
+        }
+    }
+}
+
+//  class counts over the selected traces
+
+static void snr_count(snr_t *s, const trs_t *t, const acc_sel_t *sel)
+{
+    size_t i;
+
+    for (i = sel->i0; i < sel->i1; i++) {
+        if (!acc_sel_trace(t, sel, i))
+            continue;
+        SNR_N(s)[s->lab[i]] += 1.0;
+        s->a->hdr.n++;
+    }
+    s->a->hdr.next = sel->i1;
+}
+
+//  snr at cycle j
+
+static double snr_at(const snr_t *s, size_t j, double *sig, double *noi)
+{
+    double  n = 0.0, m1 = 0.0, q = 0.0, s2 = 0.0, nk, x;
+    size_t  k;
+
+    for (k = 0; k < s->k; k++) {
+        nk = SNR_N(s)[k];
+        if (nk <= 0.0)
+            continue;
+        x = SNR_S1(s)[k * s->nc + j];
+        n += nk;
+        m1 += x;
+        q += x * x / nk;
+        s2 += SNR_S2(s)[k * s->nc + j];
+    }
+    if (n <= 0.0) {
+        *sig = *noi = 0.0;
+        return 0.0;
+    }
+    m1 /= n;
+    *sig = q / n - m1 * m1;
+    *noi = (s2 - q) / n;
+    if (*sig < 0.0)
+        *sig = 0.0;
+    return *noi > 0.0 ? *sig / *noi : 0.0;
+}
+
+typedef struct {
+    int64_t j;
+    double  snr;
+} snr_top_t;
+
+static int top_cmp(const void *a, const void *b)
+{
+    double x = ((const snr_top_t *) a)->snr;
+    double y = ((const snr_top_t *) b)->snr;
+
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static void snr_report(const snr_t *s, size_t k, const char *out_fn)
+{
+    snr_top_t   *top;
+    FILE        *fp = NULL;
+    size_t      i, nk = 0;
+    int64_t     j;
+    double      sig, noi;
+
+    if (out_fn != NULL) {
+        fp = fopen(out_fn, "w");
+        if (fp == NULL)
+            perror(out_fn);
+    }
+    top = calloc(s->nc > 0 ? s->nc : 1, sizeof(snr_top_t));
+    if (top == NULL)
+        exit(-1);
+    for (j = 0; j < s->nc; j++) {
+        top[j].j = j;
+        top[j].snr = snr_at(s, j, &sig, &noi);
+        if (fp != NULL)
+            fprintf(fp, "%ld %.6f %.4f %.4f\n",
+                    s->a->hdr.cyc0 + j, top[j].snr, sig, noi);
+    }
+    if (fp != NULL)
+        fclose(fp);
+
+    for (i = 0; i < s->k; i++) {
+        if (SNR_N(s)[i] > 0.0)
+            nk++;
+    }
+    printf("[info] %lu traces, %zu / %zu classes, cycles %ld .. %ld\n",
+            s->a->hdr.n, nk, s->k, s->a->hdr.cyc0,
+            s->a->hdr.cyc0 + s->nc - 1);
+
+    qsort(top, s->nc, sizeof(snr_top_t), top_cmp);
+    if (k > (size_t) s->nc)
+        k = s->nc;
+    for (i = 0; i < k; i++) {
+        printf("[snr] %8ld  %10.6f\n",
+                s->a->hdr.cyc0 + top[i].j, top[i].snr);
+    }
+    free(top);
+}
+
+int main(int argc, char **argv)
+{
+    snr_t       s;
+    trs_t       *t;
+    acc_sel_t   sel;
+    const char  *save_fn = NULL, *upd_fn = NULL, *out_fn = NULL;
+    const char  *lab_fn = NULL, *arg = NULL;
+    int         nthr = acc_nthr(), i, j;
+    size_t      k = 10, n;
+    bool        merge = false;
+
+    memset(&s, 0, sizeof(s));
+    acc_sel_init(&sel, NULL);
+
+    for (i = 1; i < argc; i++) {
+        if ((j = acc_sel_arg(&sel, argc, argv, i)) > 0) {
+            i += j - 1;
+        } else if (strcmp(argv[i], "-m") == 0) {
+            merge = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            nthr = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-l") == 0) {
+            lab_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            s.k = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            save_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-u") == 0) {
+            upd_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-k") == 0) {
+            k = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (argv[i][0] != '-' && arg == NULL) {
+            arg = argv[i];
+        } else if (argv[i][0] != '-' && merge) {
+            break;
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (arg == NULL || (merge && i >= argc)) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (merge) {
+        s.a = acc_merge_files(argc - i, argv + i);
+        if (s.a == NULL)
+            return 1;
+        if (strcmp(s.a->hdr.kind, "snr") != 0) {
+            fprintf(stderr, "%s: not an snr state\n", argv[i]);
+            return 1;
+        }
+        s.k = s.a->hdr.dim;
+        s.nc = s.a->hdr.ncyc;
+        acc_save(s.a, arg);
+        snr_report(&s, k, out_fn);
+        acc_free(s.a);
+        return 0;
+    }
+
+    t = trs_open(arg, false);
+    if (t == NULL || snr_labels(&s, t, lab_fn) != 0)
+        return 1;
+    acc_sel_clip(&sel, t);
+    if (upd_fn != NULL &&
+        acc_resume(&s.a, upd_fn, "snr", s.k, &sel, t) != 0)
+        return 1;
+    if (s.a != NULL)
+        s.k = s.a->hdr.dim;
+    if (s.k == 0) {
+        for (n = 0; n < s.n_lab; n++) {
+            if (s.lab[n] >= 0 && (size_t) s.lab[n] >= s.k)
+                s.k = s.lab[n] + 1;
+        }
+    }
+    if (s.k == 0 || s.k > SNR_MAXK) {
+        fprintf(stderr, "%s: %zu classes\n", arg, s.k);
+        return 1;
+    }
+    sel.keep = snr_keep;
+    sel.keep_arg = &s;
+    if (s.a == NULL)
+        s.a = acc_new("snr", sel.cyc0, sel.ncyc, s.k,
+                        s.k + 2 * s.k * sel.ncyc);
+    s.nc = s.a->hdr.ncyc;
+
+    snr_count(&s, t, &sel);
+    acc_scan(t, &sel, nthr, snr_blk, &s);
+
+    if (upd_fn != NULL)
+        acc_save(s.a, upd_fn);
+    if (save_fn != NULL)
+        acc_save(s.a, save_fn);
+    snr_report(&s, k, out_fn);
+
+    acc_free(s.a);
+    free(s.lab);
+    trs_close(t);
+    return 0;
+}
@@ -0,0 +1,218 @@
+//  trs.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Campaign trace store: create, append, inspect.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "trstore.h"
+
+#define EXIT_LOCKED 75          //  EX_TEMPFAIL: store locked, retry
+
+const char usage[] =
+    "Usage: trs <command> <dir> ..\n\n"
+    "\ttrs create <dir> <cyc0> <ncyc> [-16] [-z]\n"
+    "\t\tnew campaign of ncyc cycles starting at cyc0;\n"
+    "\t\t-16: uint16 elements (saturating), -z: compress chunks\n"
+    "\ttrs add <dir> [-c fix|rnd|kgr] [-l <label>] <src> ..\n"
+    "\t\tappend traces; src is a _tr_* directory (trace.log.gz,\n"
+    "\t\tparam.txt, run.log.gz, label.txt) or a toggle log / gen-sum\n"
+    "\t\t.dat file; -l overrides the label. Exit status 1 if a source\n"
+    "\t\twas skipped or an append failed, 75 if another writer holds\n"
+    "\t\tthe store (nothing was added; try again)\n"
+    "\ttrs info <dir>\t\theader and storage summary\n"
+    "\ttrs meta <dir>\t\tlist per-trace metadata\n"
+    "\ttrs dump <dir> <i>\tprint trace i in readvcd log format\n";
+
+static int cls_arg(const char *s)
+{
+    if (strcmp(s, "fix") == 0)
+        return TRS_FIX;
+    if (strcmp(s, "rnd") == 0)
+        return TRS_RND;
+    if (strcmp(s, "kgr") == 0)
+        return TRS_KGR;
+    return TRS_UNK;
+}
+
+static int cmd_add(const char *dir, int argc, char **argv)
+{
+    trs_t       *t;
+    trs_meta_t  meta;
+    uint32_t    *v;
+    char        path[FILENAME_MAX];
+    struct stat sb;
+    int         cls = -1, i, n = 0, st = 0;
+    int32_t     label = -1;
+
+    t = trs_open(dir, true);
+    if (t == NULL)
+        return errno == EWOULDBLOCK ? EXIT_LOCKED : 1;
+    v = calloc(t->hdr.ncyc, sizeof(uint32_t));
+    if (v == NULL)
+        exit(-1);
+
+    for (i = 0; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+            cls = cls_arg(argv[++i]);
+            continue;
+        }
+        if (i + 1 < argc && strcmp(argv[i], "-l") == 0) {
+            label = atoi(argv[++i]);
+            continue;
+        }
+        if (stat(argv[i], &sb) != 0) {
+            perror(argv[i]);
+            st = 1;
+            continue;
+        }
+        trs_read_meta(argv[i], &meta);
+        if (S_ISDIR(sb.st_mode)) {
+            snprintf(path, sizeof(path), "%s/trace.log.gz", argv[i]);
+            if (stat(path, &sb) != 0)
+                snprintf(path, sizeof(path), "%s/trace.log", argv[i]);
+        } else {
+            snprintf(path, sizeof(path), "%s", argv[i]);
+        }
+        meta.last = trs_read_log(path, t->hdr.cyc0, t->hdr.ncyc, v);
+        if (meta.last < 0) {
+            fprintf(stderr, "%s: no toggle data\n", argv[i]);
+            st = 1;
+            continue;
+        }
+        if (cls >= 0)
+            meta.cls = cls;
+        if (label >= 0)
+            meta.label = label;
+        if (trs_append(t, v, &meta) != 0) {
+            fprintf(stderr, "%s: append failed\n", dir);
+            st = 1;
+            break;
+        }
+        n++;
+    }
+    printf("[add] %s: %d traces added, %lu total\n", dir, n, t->hdr.n);
+
+    free(v);
+    trs_close(t);
+    return st;
+}
+
+static int cmd_info(const char *dir)
+{
+    trs_t   *t;
+    size_t  i, nz = 0, cnt[4] = { 0 };
+    uint64_t raw, sto = 0;
+
+    t = trs_open(dir, false);
+    if (t == NULL)
+        return 1;
+
+    for (i = 0; i < t->hdr.n_tile * trs_nchk(t); i++) {
+        sto += t->idx[i].len;
+        if (t->idx[i].how == TRS_ZLIB)
+            nz++;
+    }
+    for (i = 0; i < t->hdr.n; i++)
+        cnt[t->meta[i].cls < 3 ? t->meta[i].cls : 3]++;
+    raw = t->hdr.n_tile * TRS_TILE * t->hdr.ncyc * t->hdr.esz;
+
+    printf("%s: %lu traces (fix %zu, rnd %zu, kgr %zu, unk %zu)\n",
+            dir, t->hdr.n, cnt[TRS_FIX], cnt[TRS_RND], cnt[TRS_KGR], cnt[3]);
+    printf("%s: cycles %ld .. %ld, uint%d, %s\n", dir, t->hdr.cyc0,
+            t->hdr.cyc0 + t->hdr.ncyc - 1, 8 * t->hdr.esz,
+            t->hdr.comp ? "compressed" : "raw");
+    printf("%s: %lu tiles x %zu chunks (%zu deflated), %lu -> %lu bytes"
+            " (%.2f), %lu pending\n", dir, t->hdr.n_tile, trs_nchk(t), nz,
+            raw, sto, raw > 0 ? (double) sto / raw : 0.0,
+            t->hdr.n - t->hdr.n_tile * TRS_TILE);
+
+    trs_close(t);
+    return 0;
+}
+
+static int cmd_meta(const char *dir)
+{
+    trs_t   *t;
+    size_t  i;
+    int     j;
+    const trs_meta_t *m;
+    static const char *st[] = { "ok", "timeout", "nolog" };
+
+    t = trs_open(dir, false);
+    if (t == NULL)
+        return 1;
+
+    for (i = 0; i < t->hdr.n; i++) {
+        m = &t->meta[i];
+        printf("%6zu %s %-7s %4d %6d %8ld ", i, trs_cls_name(m->cls),
+                m->status < 3 ? st[m->status] : "?",
+                m->kappa, m->label, m->last);
+        for (j = 0; j < 32; j++)
+            printf("%02X", m->seed[j]);
+        printf(" %s\n", m->name);
+    }
+    trs_close(t);
+    return 0;
+}
+
+static int cmd_dump(const char *dir, size_t i)
+{
+    trs_t       *t;
+    uint32_t    *v;
+    int64_t     j;
+
+    t = trs_open(dir, false);
+    if (t == NULL)
+        return 1;
+    v = calloc(t->hdr.ncyc, sizeof(uint32_t));
+    if (v == NULL)
+        exit(-1);
+    if (trs_trace(t, i, v) != 0) {
+        fprintf(stderr, "%s: no trace %zu\n", dir, i);
+    } else {
+        for (j = 0; j < t->hdr.ncyc; j++) {
+            if (v[j] != 0)
+                printf("#%8ld [togd]  %u\n", t->hdr.cyc0 + j, v[j]);
+        }
+    }
+    free(v);
+    trs_close(t);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int     i, esz = 4;
+    bool    comp = false;
+
+    if (argc < 3) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "create") == 0 && argc >= 5) {
+        for (i = 5; i < argc; i++) {
+            if (strcmp(argv[i], "-16") == 0)
+                esz = 2;
+            else if (strcmp(argv[i], "-z") == 0)
+                comp = true;
+        }
+        return trs_create(argv[2], esz, strtoll(argv[3], NULL, 0),
+                            strtoll(argv[4], NULL, 0), comp) != 0;
+    }
+    if (strcmp(argv[1], "add") == 0)
+        return cmd_add(argv[2], argc - 3, argv + 3);
+    if (strcmp(argv[1], "info") == 0)
+        return cmd_info(argv[2]);
+    if (strcmp(argv[1], "meta") == 0)
+        return cmd_meta(argv[2]);
+    if (strcmp(argv[1], "dump") == 0 && argc >= 4)
+        return cmd_dump(argv[2], strtoull(argv[3], NULL, 0));
+
+    fputs(usage, stderr);
+    return 1;
+}
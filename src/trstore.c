@@ -0,0 +1,695 @@
+//  trstore.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Campaign store: all toggle traces as one cycle-major matrix.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "trstore.h"
+
+//  scratch buffer for decompression (one per thread)
+static __thread uint8_t *trs_tmp = NULL;
+
+#define CHK_MAX     ((size_t) TRS_ROWS * TRS_TILE * 4)
+
+static uint8_t *tmp_buf(void)
+{
+    if (trs_tmp == NULL) {
+        trs_tmp = malloc(compressBound(CHK_MAX));
+        if (trs_tmp == NULL)
+            exit(-1);
+    }
+    return trs_tmp;
+}
+
+static int open_in(const char *dir, const char *fn, int flags)
+{
+    char path[FILENAME_MAX];
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, fn);
+    fd = open(path, flags, 0644);
+    if (fd < 0)
+        perror(path);
+    return fd;
+}
+
+static int write_all(int fd, const void *buf, size_t len, off_t off)
+{
+    ssize_t r;
+
+    while (len > 0) {
+        r = pwrite(fd, buf, len, off);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            perror("pwrite");
+            return -1;
+        }
+        buf = ((const uint8_t *) buf) + r;
+        len -= r;
+        off += r;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len, off_t off)
+{
+    ssize_t r;
+
+    while (len > 0) {
+        r = pread(fd, buf, len, off);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return -1;
+        buf = ((uint8_t *) buf) + r;
+        len -= r;
+        off += r;
+    }
+    return 0;
+}
+
+int trs_create(const char *dir, int esz, int64_t cyc0, int64_t ncyc,
+                bool comp)
+{
+    trs_hdr_t hdr;
+    static const char *fns[] = { "trs.mat", "trs.idx", "trs.meta",
+                                 "trs.pend", NULL };
+    int fd, i;
+
+    if ((esz != 2 && esz != 4) || ncyc <= 0) {
+        fprintf(stderr, "%s: bad parameters\n", dir);
+        return -1;
+    }
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        perror(dir);
+        return -1;
+    }
+    fd = open_in(dir, "trs.hdr", O_RDWR | O_CREAT | O_EXCL);
+    if (fd < 0)
+        return -1;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = TRS_MAGIC;
+    hdr.esz     = esz;
+    hdr.comp    = comp ? 1 : 0;
+    hdr.cyc0    = cyc0;
+    hdr.ncyc    = ncyc;
+    if (write_all(fd, &hdr, sizeof(hdr), 0) != 0) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    for (i = 0; fns[i] != NULL; i++) {
+        fd = open_in(dir, fns[i], O_RDWR | O_CREAT | O_TRUNC);
+        if (fd < 0)
+            return -1;
+        close(fd);
+    }
+    return 0;
+}
+
+static void unmap(const void *p, size_t sz)
+{
+    if (p != NULL && sz > 0)
+        munmap((void *) p, sz);
+}
+
+static const void *map(int fd, size_t sz)
+{
+    void *p;
+
+    if (sz == 0)
+        return NULL;
+    p = mmap(NULL, sz, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    return p;
+}
+
+int trs_map(trs_t *t)
+{
+    size_t  n_chk, n_pend;
+
+    if (read_all(t->fd_hdr, &t->hdr, sizeof(trs_hdr_t), 0) != 0 ||
+        t->hdr.magic != TRS_MAGIC) {
+        fprintf(stderr, "%s: not a trace store\n", t->dir);
+        return -1;
+    }
+
+    unmap(t->mat, t->mat_sz);
+    unmap(t->idx, t->idx_sz);
+    unmap(t->meta, t->meta_sz);
+    unmap(t->pend, t->pend_sz);
+
+    n_chk   = t->hdr.n_tile * trs_nchk(t);
+    n_pend  = t->hdr.n - t->hdr.n_tile * TRS_TILE;
+
+    t->idx_sz   = n_chk * sizeof(trs_chk_t);
+    t->idx      = (const trs_chk_t *) map(t->fd_idx, t->idx_sz);
+    t->mat_sz   = 0;
+    if (n_chk > 0)
+        t->mat_sz = t->idx[n_chk - 1].off + t->idx[n_chk - 1].len;
+    t->mat      = (const uint8_t *) map(t->fd_mat, t->mat_sz);
+    t->meta_sz  = t->hdr.n * sizeof(trs_meta_t);
+    t->meta     = (const trs_meta_t *) map(t->fd_meta, t->meta_sz);
+    t->pend_sz  = n_pend * t->hdr.ncyc * t->hdr.esz;
+    t->pend     = (const uint8_t *) map(t->fd_pend, t->pend_sz);
+
+    return 0;
+}
+
+trs_t *trs_open(const char *dir, bool wr)
+{
+    trs_t   *t;
+    int     fl;
+
+    t = calloc(1, sizeof(trs_t));
+    if (t == NULL)
+        exit(-1);
+    t->dir  = strdup(dir);
+    t->wr   = wr;
+    fl      = wr ? O_RDWR : O_RDONLY;
+
+    t->fd_hdr   = open_in(dir, "trs.hdr", fl);
+    t->fd_mat   = open_in(dir, "trs.mat", fl);
+    t->fd_idx   = open_in(dir, "trs.idx", fl);
+    t->fd_meta  = open_in(dir, "trs.meta", fl);
+    t->fd_pend  = open_in(dir, "trs.pend", fl);
+    if (t->fd_hdr < 0 || t->fd_mat < 0 || t->fd_idx < 0 ||
+        t->fd_meta < 0 || t->fd_pend < 0)
+        goto fail;
+
+    //  one appender at a time
+    if (wr && flock(t->fd_hdr, LOCK_EX | LOCK_NB) != 0) {
+        fprintf(stderr, "%s: locked by another writer\n", dir);
+        goto fail;
+    }
+    if (trs_map(t) != 0)
+        goto fail;
+
+    return t;
+
+fail:
+    fl = errno;                         //  EWOULDBLOCK if locked
+    trs_close(t);
+    errno = fl;
+    return NULL;
+}
+
+void trs_close(trs_t *t)
+{
+    if (t == NULL)
+        return;
+    unmap(t->mat, t->mat_sz);
+    unmap(t->idx, t->idx_sz);
+    unmap(t->meta, t->meta_sz);
+    unmap(t->pend, t->pend_sz);
+    if (t->fd_hdr >= 0)
+        close(t->fd_hdr);
+    if (t->fd_mat >= 0)
+        close(t->fd_mat);
+    if (t->fd_idx >= 0)
+        close(t->fd_idx);
+    if (t->fd_meta >= 0)
+        close(t->fd_meta);
+    if (t->fd_pend >= 0)
+        close(t->fd_pend);
+    free(t->dir);
+    free(t);
+}
+
+//  byte-plane shuffle (makes the high bytes of counts compressible)
+
+static void shuffle(uint8_t *d, const uint8_t *s, size_t n, int esz)
+{
+    size_t i;
+    int j;
+
+    for (j = 0; j < esz; j++) {
+        for (i = 0; i < n; i++)
+            d[j * n + i] = s[i * esz + j];
+    }
+}
+
+static void unshuffle(uint32_t *d, const uint8_t *s, size_t n, int esz)
+{
+    size_t i;
+
+    if (esz == 2) {
+        for (i = 0; i < n; i++)
+            d[i] = s[i] | ((uint32_t) s[n + i] << 8);
+    } else {
+        for (i = 0; i < n; i++)
+            d[i] = s[i] | ((uint32_t) s[n + i] << 8) |
+                ((uint32_t) s[2 * n + i] << 16) |
+                ((uint32_t) s[3 * n + i] << 24);
+    }
+}
+
+//  transpose the full pending tile into chunks and append to trs.mat
+
+static int flush_tile(trs_t *t)
+{
+    trs_chk_t   *ent;
+    uint8_t     *rows, *chk, *tmp, *zbuf, *out;
+    size_t      esz, ncyc, nchk, c, r, j, nr, raw;
+    uint64_t    off;
+    uLongf      clen;
+    int         ret = -1;
+
+    esz     = t->hdr.esz;
+    ncyc    = t->hdr.ncyc;
+    nchk    = trs_nchk(t);
+    tmp     = tmp_buf();
+
+    rows    = malloc(TRS_TILE * ncyc * esz);
+    chk     = malloc(CHK_MAX);
+    zbuf    = malloc(compressBound(CHK_MAX));
+    ent     = calloc(nchk, sizeof(trs_chk_t));
+    if (rows == NULL || chk == NULL || zbuf == NULL || ent == NULL)
+        exit(-1);
+    if (read_all(t->fd_pend, rows, TRS_TILE * ncyc * esz, 0) != 0) {
+        fprintf(stderr, "%s: short trs.pend\n", t->dir);
+        goto done;
+    }
+
+    //  end of matrix data
+    off = 0;
+    if (t->hdr.n_tile > 0) {
+        trs_chk_t last;
+        if (read_all(t->fd_idx, &last, sizeof(last),
+                (t->hdr.n_tile * nchk - 1) * sizeof(trs_chk_t)) != 0)
+            goto done;
+        off = last.off + last.len;
+    }
+
+    for (c = 0; c < nchk; c++) {
+        nr = ncyc - c * TRS_ROWS;
+        if (nr > TRS_ROWS)
+            nr = TRS_ROWS;
+
+        //  cycle-major: row r of the chunk holds TRS_TILE traces
+        for (r = 0; r < nr; r++) {
+            for (j = 0; j < TRS_TILE; j++) {
+                memcpy(&chk[(r * TRS_TILE + j) * esz],
+                    &rows[(j * ncyc + c * TRS_ROWS + r) * esz], esz);
+            }
+        }
+        raw = nr * TRS_TILE * esz;
+
+        ent[c].off = off;
+        ent[c].how = TRS_RAW;
+        ent[c].len = raw;
+        out = chk;
+        if (t->hdr.comp) {
+            shuffle(tmp, chk, nr * TRS_TILE, esz);
+            clen = compressBound(CHK_MAX);
+            if (compress2(zbuf, &clen, tmp, raw, 1) == Z_OK && clen < raw) {
+                ent[c].how = TRS_ZLIB;
+                ent[c].len = clen;
+                out = zbuf;
+            }
+        }
+        if (write_all(t->fd_mat, out, ent[c].len, off) != 0)
+            goto done;
+        off += ent[c].len;
+    }
+    if (write_all(t->fd_idx, ent, nchk * sizeof(trs_chk_t),
+            t->hdr.n_tile * nchk * sizeof(trs_chk_t)) != 0)
+        goto done;
+    t->hdr.n_tile++;
+    ret = 0;
+
+done:
+    free(rows);
+    free(chk);
+    free(zbuf);
+    free(ent);
+    return ret;
+}
+
+int trs_append(trs_t *t, const uint32_t *v, const trs_meta_t *meta)
+{
+    uint8_t *row;
+    size_t  i, k, ncyc, esz;
+
+    if (!t->wr)
+        return -1;
+    ncyc    = t->hdr.ncyc;
+    esz     = t->hdr.esz;
+    k       = t->hdr.n - t->hdr.n_tile * TRS_TILE;
+
+    row = malloc(ncyc * esz);
+    if (row == NULL)
+        exit(-1);
+    if (esz == 2) {
+        for (i = 0; i < ncyc; i++)
+            ((uint16_t *) row)[i] = v[i] > 0xFFFF ? 0xFFFF : v[i];
+    } else {
+        memcpy(row, v, ncyc * esz);
+    }
+
+    if (write_all(t->fd_meta, meta, sizeof(trs_meta_t),
+            t->hdr.n * sizeof(trs_meta_t)) != 0 ||
+        write_all(t->fd_pend, row, ncyc * esz, k * ncyc * esz) != 0) {
+        free(row);
+        return -1;
+    }
+    free(row);
+    t->hdr.n++;
+
+    if (k + 1 == TRS_TILE && flush_tile(t) != 0)
+        return -1;
+
+    //  header last; the counts make the new data visible
+    return write_all(t->fd_hdr, &t->hdr, sizeof(trs_hdr_t), 0);
+}
+
+//  bulk writes: chunk (tile, chk) of a full tile is at a fixed offset
+
+static int bulk_ok(const trs_t *t)
+{
+    if (!t->wr || t->hdr.comp || t->hdr.n != 0) {
+        fprintf(stderr, "%s: bulk write needs a new raw store\n", t->dir);
+        return 0;
+    }
+    return 1;
+}
+
+int trs_bulk_chunk(trs_t *t, size_t tile, size_t chk,
+                    const uint32_t *buf, size_t m)
+{
+    uint8_t *row;
+    size_t  esz, ncyc, nr, n, i, j;
+    int     ret = 0;
+
+    if (!bulk_ok(t))
+        return -1;
+    esz     = t->hdr.esz;
+    ncyc    = t->hdr.ncyc;
+    nr      = ncyc - chk * TRS_ROWS;
+    if (nr > TRS_ROWS)
+        nr = TRS_ROWS;
+    n       = nr * TRS_TILE;
+
+    row = malloc(CHK_MAX);
+    if (row == NULL)
+        exit(-1);
+
+    if (m == TRS_TILE) {
+        if (esz == 2) {
+            for (i = 0; i < n; i++)
+                ((uint16_t *) row)[i] = buf[i] > 0xFFFF ? 0xFFFF : buf[i];
+        } else {
+            memcpy(row, buf, n * esz);
+        }
+        ret = write_all(t->fd_mat, row, n * esz,
+                (tile * ncyc + chk * TRS_ROWS) * TRS_TILE * esz);
+    } else {
+
+        //  partial tile: trace-major in trs.pend
+        for (j = 0; j < m && ret == 0; j++) {
+            for (i = 0; i < nr; i++) {
+                if (esz == 2) {
+                    ((uint16_t *) row)[i] = buf[i * TRS_TILE + j] > 0xFFFF ?
+                        0xFFFF : buf[i * TRS_TILE + j];
+                } else {
+                    ((uint32_t *) row)[i] = buf[i * TRS_TILE + j];
+                }
+            }
+            ret = write_all(t->fd_pend, row, nr * esz,
+                    (j * ncyc + chk * TRS_ROWS) * esz);
+        }
+    }
+    free(row);
+    return ret;
+}
+
+int trs_bulk_end(trs_t *t, uint64_t n, const trs_meta_t *meta)
+{
+    trs_chk_t   *ent;
+    size_t      nchk, n_tile, c, i;
+    int         ret;
+
+    if (!bulk_ok(t))
+        return -1;
+    nchk    = trs_nchk(t);
+    n_tile  = n / TRS_TILE;
+
+    ent = calloc(n_tile * nchk + 1, sizeof(trs_chk_t));
+    if (ent == NULL)
+        exit(-1);
+    for (i = 0; i < n_tile * nchk; i++) {
+        c = i % nchk;
+        ent[i].off  = ((i / nchk) * t->hdr.ncyc + c * TRS_ROWS) *
+                        TRS_TILE * t->hdr.esz;
+        ent[i].len  = (t->hdr.ncyc - c * TRS_ROWS > TRS_ROWS ?
+                        TRS_ROWS : t->hdr.ncyc - c * TRS_ROWS) *
+                        TRS_TILE * t->hdr.esz;
+        ent[i].how  = TRS_RAW;
+    }
+    ret = write_all(t->fd_meta, meta, n * sizeof(trs_meta_t), 0);
+    if (ret == 0 && n_tile > 0)
+        ret = write_all(t->fd_idx, ent, n_tile * nchk * sizeof(trs_chk_t), 0);
+    free(ent);
+    if (ret != 0)
+        return -1;
+
+    //  header last
+    t->hdr.n = n;
+    t->hdr.n_tile = n_tile;
+    if (write_all(t->fd_hdr, &t->hdr, sizeof(trs_hdr_t), 0) != 0)
+        return -1;
+    return trs_map(t);
+}
+
+size_t trs_chunk(const trs_t *t, size_t tile, size_t chk,
+                    uint32_t *buf, size_t *rows)
+{
+    const trs_chk_t *ent;
+    const uint8_t *s;
+    size_t  esz, ncyc, nr, n, i, j;
+    uLongf  dlen;
+
+    esz     = t->hdr.esz;
+    ncyc    = t->hdr.ncyc;
+    nr      = ncyc - chk * TRS_ROWS;
+    if (nr > TRS_ROWS)
+        nr = TRS_ROWS;
+    *rows   = nr;
+    n       = nr * TRS_TILE;
+
+    if (tile < t->hdr.n_tile) {
+        ent = &t->idx[tile * trs_nchk(t) + chk];
+        s = t->mat + ent->off;
+        if (ent->how == TRS_ZLIB) {
+            dlen = CHK_MAX;
+            if (uncompress(tmp_buf(), &dlen, s, ent->len) != Z_OK ||
+                dlen != n * esz) {
+                fprintf(stderr, "%s: bad chunk %zu:%zu\n", t->dir, tile, chk);
+                memset(buf, 0, n * sizeof(uint32_t));
+                return 0;
+            }
+            unshuffle(buf, tmp_buf(), n, esz);
+        } else if (esz == 2) {
+            for (i = 0; i < n; i++)
+                buf[i] = ((const uint16_t *) s)[i];
+        } else {
+            memcpy(buf, s, n * sizeof(uint32_t));
+        }
+        return TRS_TILE;
+    }
+
+    //  unfinished tile: transpose from trs.pend
+    if (tile * TRS_TILE >= t->hdr.n)
+        return 0;
+    n = t->hdr.n - tile * TRS_TILE;
+    memset(buf, 0, nr * TRS_TILE * sizeof(uint32_t));
+    for (j = 0; j < n; j++) {
+        s = t->pend + (j * ncyc + chk * TRS_ROWS) * esz;
+        if (esz == 2) {
+            for (i = 0; i < nr; i++)
+                buf[i * TRS_TILE + j] = ((const uint16_t *) s)[i];
+        } else {
+            for (i = 0; i < nr; i++)
+                buf[i * TRS_TILE + j] = ((const uint32_t *) s)[i];
+        }
+    }
+    return n;
+}
+
+int trs_trace(const trs_t *t, size_t i, uint32_t *v)
+{
+    uint32_t *buf;
+    size_t  tile, col, c, r, nr;
+
+    if (i >= t->hdr.n)
+        return -1;
+    buf = malloc(CHK_MAX);
+    if (buf == NULL)
+        exit(-1);
+    tile = i / TRS_TILE;
+    col = i % TRS_TILE;
+    for (c = 0; c < trs_nchk(t); c++) {
+        trs_chunk(t, tile, c, buf, &nr);
+        for (r = 0; r < nr; r++)
+            v[c * TRS_ROWS + r] = buf[r * TRS_TILE + col];
+    }
+    free(buf);
+    return 0;
+}
+
+//  === importing text logs
+
+int64_t trs_read_log(const char *fn, int64_t cyc0, int64_t ncyc,
+                        uint32_t *v)
+{
+    gzFile  gz;
+    char    buf[256];
+    char    *p;
+    int64_t cyc, x, last = -1;
+
+    memset(v, 0, ncyc * sizeof(uint32_t));
+    gz = gzopen(fn, "r");
+    if (gz == NULL) {
+        perror(fn);
+        return -1;
+    }
+    while (gzgets(gz, buf, sizeof(buf)) != NULL) {
+        if (buf[0] != '#')
+            continue;
+        cyc = strtoll(buf + 1, &p, 10);
+        while (*p == ' ')
+            p++;
+        if (strncmp(p, "[togd]", 6) != 0)
+            continue;
+        x = strtoll(p + 6, NULL, 10);
+        if (cyc > last)
+            last = cyc;
+        cyc -= cyc0;
+        if (cyc >= 0 && cyc < ncyc)
+            v[cyc] = x < 0 ? 0 : (x > 0xFFFFFFFF ? 0xFFFFFFFF : x);
+    }
+    gzclose(gz);
+
+    return last;
+}
+
+const char *trs_cls_name(int cls)
+{
+    switch (cls) {
+        case TRS_FIX:   return "fix";
+        case TRS_RND:   return "rnd";
+        case TRS_KGR:   return "kgr";
+    }
+    return "unk";
+}
+
+static int cls_from_name(const char *s)
+{
+    if (strstr(s, "fix") != NULL)
+        return TRS_FIX;
+    if (strstr(s, "rnd") != NULL)
+        return TRS_RND;
+    if (strstr(s, "kgr") != NULL)
+        return TRS_KGR;
+    return TRS_UNK;
+}
+
+static int hexval(int c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+void trs_read_meta(const char *dir, trs_meta_t *meta)
+{
+    char    path[FILENAME_MAX];
+    char    buf[LINE_MAX];
+    FILE    *fp;
+    gzFile  gz;
+    int     i, rounds;
+    bool    save = false, ext = false;
+    const char *s;
+    size_t  l;
+
+    memset(meta, 0, sizeof(trs_meta_t));
+    l = strlen(dir);
+    while (l > 1 && dir[l - 1] == '/')
+        l--;
+    s = memrchr(dir, '/', l);
+    s = s == NULL ? dir : s + 1;
+    snprintf(meta->name, sizeof(meta->name), "%.*s", (int) (dir + l - s), s);
+    meta->cls = cls_from_name(meta->name);
+    meta->status = TRS_NOLOG;
+    meta->kappa = -1;
+    meta->label = -1;
+    meta->last = -1;
+
+    //  param.txt written by flow/gen-*.sh
+    snprintf(path, sizeof(path), "%s/param.txt", dir);
+    fp = fopen(path, "r");
+    if (fp != NULL) {
+        while (fgets(buf, sizeof(buf), fp) != NULL) {
+            if (strncmp(buf, "randxi=", 7) == 0) {
+                for (i = 0; i < 64 && hexval(buf[7 + i]) >= 0; i++) {
+                    meta->seed[i / 2] |= hexval(buf[7 + i]) <<
+                                            ((i & 1) ? 0 : 4);
+                }
+            }
+        }
+        fclose(fp);
+    }
+
+    //  optional class label for profiling (snr)
+    snprintf(path, sizeof(path), "%s/label.txt", dir);
+    fp = fopen(path, "r");
+    if (fp != NULL) {
+        if (fgets(buf, sizeof(buf), fp) != NULL)
+            meta->label = atoi(buf);
+        fclose(fp);
+    }
+
+    //  run log: did it finish; how many signing rounds
+    snprintf(path, sizeof(path), "%s/run.log.gz", dir);
+    gz = gzopen(path, "r");
+    if (gz == NULL) {
+        snprintf(path, sizeof(path), "%s/run.log", dir);
+        gz = gzopen(path, "r");
+    }
+    if (gz == NULL)
+        return;
+    rounds = 0;
+    while (gzgets(gz, buf, sizeof(buf)) != NULL) {
+        if (strstr(buf, "[SAVE]") != NULL)
+            save = true;
+        if (strstr(buf, "[EXIT]") != NULL)
+            ext = true;
+        if (strstr(buf, "MLDSA_SIGN_MAKE_Y_S +  0") != NULL)
+            rounds++;
+    }
+    gzclose(gz);
+
+    meta->status = save ? TRS_OK : (ext ? TRS_TIMEOUT : TRS_NOLOG);
+    if (rounds > 0)
+        meta->kappa = 7 * (rounds - 1);     //  ML-DSA-87: l = 7
+}
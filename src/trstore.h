@@ -0,0 +1,153 @@
+//  trstore.h
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Campaign store: all toggle traces as one cycle-major matrix.
+
+#ifndef _TRSTORE_H_
+#define _TRSTORE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  A campaign is a directory:
+//      trs.hdr     header (counts are authoritative; written last)
+//      trs.mat     tiles of TRS_TILE traces; each tile is a sequence of
+//                  chunks of TRS_ROWS cycles x TRS_TILE traces (cycle-major),
+//                  stored raw or byte-shuffled + deflated
+//      trs.idx     chunk index: tile-major array of trs_chk_t
+//      trs.meta    per-trace metadata records (trs_meta_t)
+//      trs.pend    traces of the unfinished tile, trace-major
+//  Appending a trace writes its meta record and a row to trs.pend; when
+//  the tile is full it is transposed, compressed, and added to trs.mat.
+
+#define TRS_MAGIC   0x3153525452424100llu   //  "\0ABRTRS1"
+#define TRS_TILE    256                     //  traces per tile
+#define TRS_ROWS    256                     //  cycles per chunk
+
+//  trace classes
+#define TRS_FIX     0
+#define TRS_RND     1
+#define TRS_KGR     2
+#define TRS_UNK     255
+
+//  run status
+#define TRS_OK      0       //  output was saved
+#define TRS_TIMEOUT 1       //  exited without output (-t limit)
+#define TRS_NOLOG   2       //  no run log
+
+//  chunk storage
+#define TRS_RAW     0
+#define TRS_ZLIB    1
+
+typedef struct {
+    uint64_t    magic;
+    uint32_t    esz;        //  element size: 2 (uint16) or 4 (uint32)
+    uint32_t    comp;       //  compress chunks?
+    int64_t     cyc0;       //  first cycle (row 0)
+    int64_t     ncyc;       //  cycles per trace (rows)
+    uint64_t    n;          //  number of traces (including pending)
+    uint64_t    n_tile;     //  number of complete tiles
+    uint64_t    pad[25];
+} trs_hdr_t;
+
+typedef struct {
+    uint64_t    off;        //  offset in trs.mat
+    uint32_t    len;        //  stored length
+    uint32_t    how;        //  TRS_RAW or TRS_ZLIB
+} trs_chk_t;
+
+typedef struct {
+    uint8_t     cls;        //  TRS_FIX, TRS_RND, TRS_KGR, TRS_UNK
+    uint8_t     status;     //  TRS_OK, TRS_TIMEOUT, TRS_NOLOG
+    int16_t     kappa;      //  signing counter (7 per rejected round), -1
+    int32_t     label;      //  user label (e.g. for SNR classes), -1
+    int64_t     last;       //  last cycle seen in the trace log
+    uint8_t     seed[32];   //  key generation seed (randxi)
+    char        name[64];   //  source directory
+} trs_meta_t;
+
+typedef struct {
+    char        *dir;
+    bool        wr;         //  opened for appending
+    trs_hdr_t   hdr;
+    int         fd_mat, fd_idx, fd_meta, fd_pend, fd_hdr;
+
+    //  read-only mappings (refreshed by trs_map)
+    const uint8_t   *mat;
+    size_t          mat_sz;
+    const trs_chk_t *idx;
+    size_t          idx_sz;
+    const trs_meta_t *meta;
+    size_t          meta_sz;
+    const uint8_t   *pend;
+    size_t          pend_sz;
+} trs_t;
+
+//  number of chunks per tile
+static inline size_t trs_nchk(const trs_t *t)
+{
+    return (t->hdr.ncyc + TRS_ROWS - 1) / TRS_ROWS;
+}
+
+//  number of tiles including the unfinished one
+static inline size_t trs_ntile(const trs_t *t)
+{
+    return (t->hdr.n + TRS_TILE - 1) / TRS_TILE;
+}
+
+//  create an empty campaign
+int trs_create(const char *dir, int esz, int64_t cyc0, int64_t ncyc,
+                bool comp);
+
+//  open; "wr" locks it for appending (errno is EWOULDBLOCK if another
+//  writer holds the lock)
+trs_t *trs_open(const char *dir, bool wr);
+
+//  refresh mappings (after appends by this or another process)
+int trs_map(trs_t *t);
+
+//  append a trace of hdr.ncyc values (saturated to the element size)
+int trs_append(trs_t *t, const uint32_t *v, const trs_meta_t *meta);
+
+//  close and unmap
+void trs_close(trs_t *t);
+
+//  bulk writing of a new, empty, uncompressed store: the layout is fixed,
+//  so threads can write chunks of different tiles in any order. m is the
+//  number of valid traces (columns) in buf; only the last tile is partial.
+int trs_bulk_chunk(trs_t *t, size_t tile, size_t chk,
+                    const uint32_t *buf, size_t m);
+
+//  after all chunks: metadata of the n traces, index, and header
+int trs_bulk_end(trs_t *t, uint64_t n, const trs_meta_t *meta);
+
+//  a chunk of rows [chk * TRS_ROWS, ..) x TRS_TILE columns as uint32,
+//  row stride TRS_TILE; returns number of valid columns (traces) and the
+//  number of valid rows in *rows. buf must hold TRS_ROWS * TRS_TILE.
+size_t trs_chunk(const trs_t *t, size_t tile, size_t chk,
+                    uint32_t *buf, size_t *rows);
+
+//  a full trace (row of the matrix) as uint32
+int trs_trace(const trs_t *t, size_t i, uint32_t *v);
+
+//  === importing text logs
+
+//  read "# cyc [togd] n" lines from a (gzipped) log into v[cyc - cyc0]
+int64_t trs_read_log(const char *fn, int64_t cyc0, int64_t ncyc,
+                        uint32_t *v);
+
+//  metadata from a _tr_* directory (param.txt, run.log.gz)
+void trs_read_meta(const char *dir, trs_meta_t *meta);
+
+const char *trs_cls_name(int cls);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,557 @@
+//  tvla.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Sequential fix/rnd TVLA over a growing store, with stop criteria.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "accum.h"
+
+//  Welch t per cycle between the fix and rnd traces of a store. With -f
+//  the store is polled for appended traces; each update adds only the new
+//  traces to the sums, prints a snapshot, and checks the stop criteria.
+
+#define TVLA_PH_MAX 4096            //  phase intervals from a run log
+
+typedef struct {
+    acc_t       *a;
+    const trs_t *t;
+    int64_t     nc;
+    double      *tv;        //  t-value per cycle
+} tvla_t;
+
+//  accumulator layout: n[2], s1[2][nc], s2[2][nc]
+#define TVLA_N(s)   ((s)->a->v)
+#define TVLA_S1(s)  ((s)->a->v + 2)
+#define TVLA_S2(s)  ((s)->a->v + 2 + 2 * (s)->nc)
+
+//  sequencer phases: intervals [c0, c1) with a name index
+typedef struct {
+    char        (*name)[40];
+    size_t      n_name;
+    int64_t     *c0, *c1;
+    size_t      *nm;
+    size_t      n;
+} tvla_ph_t;
+
+//  stop criteria
+typedef struct {
+    double      th;         //  |t| threshold
+    uint64_t    pass_n;     //  pass: traces per class, none above th
+    int64_t     *lk0, *lk1; //  leak: each window [lk0, lk1] above th
+    size_t      n_lk;
+    int         k;          //  consecutive snapshots required
+    int         run;        //  current streak
+    const char  *stop_fn;   //  verdict file
+    const char  *stop_cmd;  //  shell command
+} tvla_stop_t;
+
+const char usage[] =
+    "Usage: tvla [options] <store>\n"
+    "       tvla [options] -m <out.acc> <in.acc> ..\n\n"
+    "Per-cycle Welch t-test between the fix and rnd traces of campaign\n"
+    "<store>; with -f, follow the store as traces are appended.\n\n"
+    "\t-f\t\tfollow: poll for new traces until a stop criterion\n"
+    "\t-i\t<sec>\tpoll interval (default 10)\n"
+    "\t-e\t<n>\tsnapshot after at least n new traces (default 1)\n"
+    "\t-p\t<log>\tphase tags ([prim] lines) from a run log\n"
+    "\t-T\t<t>\tthreshold (default 4.5)\n"
+    "\t-P\t<n>\tstop (pass): n traces per class, no cycle above T\n"
+    "\t-L\t<c:d,..>\tstop (leak): every window has a cycle above T\n"
+    "\t-K\t<k>\tcriterion must hold for k snapshots (default 1)\n"
+    "\t-x\t<fn>\twrite the verdict to fn on stop\n"
+    "\t-X\t<cmd>\trun a shell command on stop\n"
+    "\t-t\t<n>\tthreads (default: all processors)\n"
+    "\t-r\t<a:b>\ttrace range\n"
+    "\t-w\t<c:d>\tcycle window\n"
+    "\t-a\t\tinclude runs that timed out\n"
+    "\t-s\t<fn>\tsave the accumulator state\n"
+    "\t-u\t<fn>\tupdate: continue from a saved state, save it back\n"
+    "\t-m\t\tmerge saved states of shards instead of reading a store\n"
+    "\t-k\t<n>\treport the n highest cycles (default 10)\n"
+    "\t-o\t<fn>\tper-cycle output in the format of flow/tvla.py\n";
+
+static volatile sig_atomic_t tvla_quit = 0;
+
+static void tvla_sig(int sig)
+{
+    (void) sig;
+    tvla_quit = 1;
+}
+
+static bool tvla_keep(void *arg, size_t i)
+{
+    const tvla_t *s = (const tvla_t *) arg;
+
+    return s->t->meta[i].cls == TRS_FIX || s->t->meta[i].cls == TRS_RND;
+}
+
+//  one chunk of one tile: class sums
+
+static void tvla_blk(void *ctx, const acc_blk_t *b)
+{
+    const tvla_t *s = (const tvla_t *) ctx;
+    const double *x;
+    double  *s1, *s2;
+    size_t  j, r, k;
+
+    for (j = 0; j < b->m; j++) {
+        x = b->x + j * ACC_LD;
+        k = s->t->meta[b->idx[j]].cls;
+        s1 = TVLA_S1(s) + k * s->nc + b->off;
+        s2 = TVLA_S2(s) + k * s->nc + b->off;
+        for (r = 0; r < b->rows; r++) {
+            s1[r] += x[r];
+            s2[r] += x[r] * x[r];
+        }
+    }
+}
+
+//  add traces [sel->i0, sel->i1) to the sums
+
+static void tvla_add(tvla_t *s, const acc_sel_t *sel, int nthr)
+{
+    size_t i;
+
+    for (i = sel->i0; i < sel->i1; i++) {
+        if (!acc_sel_trace(s->t, sel, i))
+            continue;
+        TVLA_N(s)[s->t->meta[i].cls] += 1.0;
+        s->a->hdr.n++;
+    }
+    s->a->hdr.next = sel->i1;
+    acc_scan(s->t, sel, nthr, tvla_blk, s);
+}
+
+//  mean and (population) standard deviation of class k at cycle j
+
+static double tvla_avg(const tvla_t *s, int k, int64_t j, double *sd)
+{
+    double n = TVLA_N(s)[k], m, v;
+
+    if (n <= 0.0) {
+        *sd = 0.0;
+        return 0.0;
+    }
+    m = TVLA_S1(s)[k * s->nc + j] / n;
+    v = TVLA_S2(s)[k * s->nc + j] / n - m * m;
+    *sd = v > 0.0 ? sqrt(v) : 0.0;
+    return m;
+}
+
+//  welch t at cycle j; 0 if undefined (as flow/tvla.py)
+
+static double tvla_at(const tvla_t *s, int64_t j)
+{
+    double  n0 = TVLA_N(s)[0], n1 = TVLA_N(s)[1];
+    double  m0, m1, d0, d1, c;
+
+    if (n0 <= 0.0 || n1 <= 0.0)
+        return 0.0;
+    m0 = tvla_avg(s, 0, j, &d0);
+    m1 = tvla_avg(s, 1, j, &d1);
+    c = d0 * d0 / n0 + d1 * d1 / n1;
+    return c > 0.0 ? (m0 - m1) / sqrt(c) : 0.0;
+}
+
+//  read phase intervals from the [prim] tags of a (gzipped) run log
+
+static int tvla_phases(tvla_ph_t *ph, const char *fn)
+{
+    gzFile  gz;
+    char    buf[256], nm[40];
+    char    *p;
+    int64_t cyc;
+    size_t  i;
+
+    gz = gzopen(fn, "r");
+    if (gz == NULL) {
+        perror(fn);
+        return -1;
+    }
+    ph->name = malloc(TVLA_PH_MAX * sizeof(*ph->name));
+    ph->c0 = malloc(TVLA_PH_MAX * sizeof(int64_t));
+    ph->c1 = malloc(TVLA_PH_MAX * sizeof(int64_t));
+    ph->nm = malloc(TVLA_PH_MAX * sizeof(size_t));
+    if (ph->name == NULL || ph->c0 == NULL || ph->c1 == NULL ||
+        ph->nm == NULL)
+        exit(-1);
+
+    while (gzgets(gz, buf, sizeof(buf)) != NULL && ph->n < TVLA_PH_MAX) {
+        //  a tag may follow the progress counter on the same line
+        if ((p = strchr(buf, '#')) == NULL)
+            continue;
+        cyc = strtoll(p + 1, &p, 10);
+        while (*p == ' ')
+            p++;
+        if (strncmp(p, "[prim]", 6) != 0 || (p = strchr(p, ':')) == NULL ||
+            sscanf(p + 1, "%39s", nm) != 1)
+            continue;
+
+        //  consecutive tags of the same phase extend the interval
+        if (ph->n > 0 && strcmp(ph->name[ph->nm[ph->n - 1]], nm) == 0)
+            continue;
+        if (ph->n > 0)
+            ph->c1[ph->n - 1] = cyc;
+        for (i = 0; i < ph->n_name && strcmp(ph->name[i], nm) != 0; i++)
+            ;
+        if (i == ph->n_name)
+            strcpy(ph->name[ph->n_name++], nm);
+        ph->nm[ph->n] = i;
+        ph->c0[ph->n] = cyc;
+        ph->c1[ph->n] = INT64_MAX;
+        ph->n++;
+    }
+    gzclose(gz);
+    if (ph->n == 0)
+        fprintf(stderr, "%s: no [prim] tags\n", fn);
+    return 0;
+}
+
+//  windows "c:d,c:d,.." (inclusive)
+
+static int tvla_windows(tvla_stop_t *st, const char *s)
+{
+    char    *p;
+    size_t  n = 1;
+
+    for (p = (char *) s; *p != 0; p++)
+        n += *p == ',';
+    st->lk0 = malloc(n * sizeof(int64_t));
+    st->lk1 = malloc(n * sizeof(int64_t));
+    if (st->lk0 == NULL || st->lk1 == NULL)
+        exit(-1);
+    for (st->n_lk = 0; st->n_lk < n; st->n_lk++) {
+        st->lk0[st->n_lk] = strtoll(s, &p, 0);
+        st->lk1[st->n_lk] = *p == ':' ? strtoll(p + 1, &p, 0) :
+                                st->lk0[st->n_lk];
+        if (*p != ',' && *p != 0)
+            return -1;
+        s = p + 1;
+    }
+    return 0;
+}
+
+typedef struct {
+    int64_t j;
+    double  t;
+} tvla_top_t;
+
+static int top_cmp(const void *a, const void *b)
+{
+    double x = fabs(((const tvla_top_t *) a)->t);
+    double y = fabs(((const tvla_top_t *) b)->t);
+
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+//  per-cycle file, replaced atomically so that it can be plotted live;
+//  cycles without toggles in any trace are left out (as flow/tvla.py)
+
+static void tvla_out(const tvla_t *s, const char *fn)
+{
+    char    tmp[FILENAME_MAX];
+    FILE    *fp;
+    int64_t j;
+    double  m0, m1, d0, d1;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", fn);
+    fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        perror(tmp);
+        return;
+    }
+    for (j = 0; j < s->nc; j++) {
+        m0 = tvla_avg(s, 0, j, &d0);
+        m1 = tvla_avg(s, 1, j, &d1);
+        if (m0 == 0.0 && d0 == 0.0 && m1 == 0.0 && d1 == 0.0)
+            continue;
+        fprintf(fp, "%5ld %9.4f # f:(%5.0f, %8.1f, %8.2f)"
+                " r:(%5.0f, %8.1f, %8.2f) [t]\n",
+                s->a->hdr.cyc0 + j, s->tv[j],
+                TVLA_N(s)[0], m0, d0, TVLA_N(s)[1], m1, d1);
+    }
+    fclose(fp);
+    if (rename(tmp, fn) != 0)
+        perror(fn);
+}
+
+//  snapshot: summary, phases, top cycles; returns number above threshold
+
+static size_t tvla_snap(tvla_t *s, const tvla_ph_t *ph, double th,
+                        size_t k)
+{
+    tvla_top_t  *top;
+    int64_t     j, c0 = s->a->hdr.cyc0, c, d, jm;
+    size_t      i, m, nab = 0;
+    double      x;
+
+    top = calloc(s->nc > 0 ? s->nc : 1, sizeof(tvla_top_t));
+    if (top == NULL)
+        exit(-1);
+    for (j = 0; j < s->nc; j++) {
+        s->tv[j] = tvla_at(s, j);
+        top[j].j = j;
+        top[j].t = s->tv[j];
+        if (fabs(s->tv[j]) > th)
+            nab++;
+    }
+    qsort(top, s->nc, sizeof(tvla_top_t), top_cmp);
+
+    printf("[snap] %.0f fix + %.0f rnd, cycles %ld .. %ld, max |t| %.3f"
+            " at %ld, %zu above %.1f\n", TVLA_N(s)[0], TVLA_N(s)[1],
+            c0, c0 + s->nc - 1, s->nc > 0 ? fabs(top[0].t) : 0.0,
+            s->nc > 0 ? c0 + top[0].j : c0, nab, th);
+
+    //  per phase name: cycles, max |t|, cycles above threshold
+    for (m = 0; m < ph->n_name; m++) {
+        size_t  nc = 0, na = 0;
+        double  mx = 0.0;
+
+        jm = -1;
+        for (i = 0; i < ph->n; i++) {
+            if (ph->nm[i] != m)
+                continue;
+            c = ph->c0[i] > c0 ? ph->c0[i] - c0 : 0;
+            d = ph->c1[i] - c0 < s->nc ? ph->c1[i] - c0 : s->nc;
+            for (j = c; j < d; j++) {
+                x = fabs(s->tv[j]);
+                nc++;
+                if (x > th)
+                    na++;
+                if (x > mx) {
+                    mx = x;
+                    jm = j;
+                }
+            }
+        }
+        if (nc == 0)
+            continue;
+        printf("[phase] %-28s %7zu cyc  max |t| %9.3f at %-8ld %7zu above\n",
+                ph->name[m], nc, mx, jm < 0 ? 0 : c0 + jm, na);
+    }
+
+    if (k > (size_t) s->nc)
+        k = s->nc;
+    for (i = 0; i < k; i++)
+        printf("[tvla] %8ld  %9.3f\n", c0 + top[i].j, top[i].t);
+    fflush(stdout);
+    free(top);
+
+    return nab;
+}
+
+//  check the stop criteria after a snapshot; returns true to stop
+
+static bool tvla_check(const tvla_t *s, tvla_stop_t *st, size_t nab)
+{
+    const char  *verdict = NULL;
+    int64_t     j, c, d;
+    size_t      i, hit = 0;
+    FILE        *fp;
+
+    if (st->pass_n > 0 && nab == 0 &&
+        TVLA_N(s)[0] >= st->pass_n && TVLA_N(s)[1] >= st->pass_n)
+        verdict = "pass";
+
+    for (i = 0; i < st->n_lk; i++) {
+        c = st->lk0[i] - s->a->hdr.cyc0;
+        d = st->lk1[i] - s->a->hdr.cyc0;
+        for (j = c < 0 ? 0 : c; j <= d && j < s->nc; j++) {
+            if (fabs(s->tv[j]) > st->th) {
+                hit++;
+                break;
+            }
+        }
+    }
+    if (st->n_lk > 0 && hit == st->n_lk)
+        verdict = "leak";
+
+    st->run = verdict != NULL ? st->run + 1 : 0;
+    if (st->run < st->k)
+        return false;
+
+    printf("[stop] %s at %.0f fix + %.0f rnd traces\n",
+            verdict, TVLA_N(s)[0], TVLA_N(s)[1]);
+    fflush(stdout);
+    if (st->stop_fn != NULL) {
+        fp = fopen(st->stop_fn, "w");
+        if (fp == NULL) {
+            perror(st->stop_fn);
+        } else {
+            fprintf(fp, "%s %.0f %.0f\n",
+                    verdict, TVLA_N(s)[0], TVLA_N(s)[1]);
+            fclose(fp);
+        }
+    }
+    if (st->stop_cmd != NULL && system(st->stop_cmd) != 0)
+        fprintf(stderr, "[stop] command failed: %s\n", st->stop_cmd);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    tvla_t      s;
+    tvla_ph_t   ph;
+    tvla_stop_t st;
+    trs_t       *t;
+    acc_sel_t   sel;
+    const char  *save_fn = NULL, *upd_fn = NULL, *out_fn = NULL;
+    const char  *ph_fn = NULL, *arg = NULL;
+    int         nthr = acc_nthr(), i, j;
+    size_t      k = 10, nab;
+    uint64_t    lim, evr = 1, last;
+    double      ivl = 10.0;
+    bool        merge = false, follow = false, stop;
+
+    memset(&s, 0, sizeof(s));
+    memset(&ph, 0, sizeof(ph));
+    memset(&st, 0, sizeof(st));
+    st.th = 4.5;
+    st.k = 1;
+    acc_sel_init(&sel, NULL);
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            fputs(usage, stderr);
+            return 1;
+        } else if ((j = acc_sel_arg(&sel, argc, argv, i)) > 0) {
+            i += j - 1;
+        } else if (strcmp(argv[i], "-m") == 0) {
+            merge = true;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            follow = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            ivl = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-e") == 0) {
+            evr = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            ph_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-T") == 0) {
+            st.th = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-P") == 0) {
+            st.pass_n = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-L") == 0) {
+            if (tvla_windows(&st, argv[++i]) != 0) {
+                fprintf(stderr, "-L %s: bad window list\n", argv[i]);
+                return 1;
+            }
+        } else if (i + 1 < argc && strcmp(argv[i], "-K") == 0) {
+            st.k = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-x") == 0) {
+            st.stop_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-X") == 0) {
+            st.stop_cmd = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            nthr = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            save_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-u") == 0) {
+            upd_fn = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-k") == 0) {
+            k = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out_fn = argv[++i];
+        } else if (argv[i][0] != '-' && arg == NULL) {
+            arg = argv[i];
+        } else if (argv[i][0] != '-' && merge) {
+            break;
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (arg == NULL || (merge && i >= argc) || (merge && follow)) {
+        fputs(usage, stderr);
+        return 1;
+    }
+    if (ph_fn != NULL && tvla_phases(&ph, ph_fn) != 0)
+        return 1;
+
+    if (merge) {
+        s.a = acc_merge_files(argc - i, argv + i);
+        if (s.a == NULL)
+            return 1;
+        if (strcmp(s.a->hdr.kind, "tvla") != 0) {
+            fprintf(stderr, "%s: not a tvla state\n", argv[i]);
+            return 1;
+        }
+        s.nc = s.a->hdr.ncyc;
+        s.tv = calloc(s.nc > 0 ? s.nc : 1, sizeof(double));
+        if (s.tv == NULL)
+            exit(-1);
+        acc_save(s.a, arg);
+        nab = tvla_snap(&s, &ph, st.th, k);
+        tvla_check(&s, &st, nab);
+        if (out_fn != NULL)
+            tvla_out(&s, out_fn);
+        acc_free(s.a);
+        return 0;
+    }
+
+    t = trs_open(arg, false);
+    if (t == NULL)
+        return 1;
+    s.t = t;
+    lim = sel.i1;
+    acc_sel_clip(&sel, t);
+    if (upd_fn != NULL && acc_resume(&s.a, upd_fn, "tvla", 2, &sel, t) != 0)
+        return 1;
+    sel.keep = tvla_keep;
+    sel.keep_arg = &s;
+    if (s.a == NULL)
+        s.a = acc_new("tvla", sel.cyc0, sel.ncyc, 2, 2 + 4 * sel.ncyc);
+    s.nc = s.a->hdr.ncyc;
+    s.tv = calloc(s.nc > 0 ? s.nc : 1, sizeof(double));
+    if (s.tv == NULL)
+        exit(-1);
+
+    signal(SIGINT, tvla_sig);
+    signal(SIGTERM, tvla_sig);
+
+    //  first pass over what is there, then follow the store
+    tvla_add(&s, &sel, nthr);
+    last = s.a->hdr.n;
+    for (;;) {
+        nab = tvla_snap(&s, &ph, st.th, k);
+        stop = tvla_check(&s, &st, nab);
+        if (out_fn != NULL)
+            tvla_out(&s, out_fn);
+        if (upd_fn != NULL)
+            acc_save(s.a, upd_fn);
+        if (stop || !follow)
+            break;
+
+        //  wait until at least evr new traces have been added
+        while (!tvla_quit) {
+            usleep((useconds_t) (ivl * 1E6));
+            if (tvla_quit || trs_map(t) != 0)
+                break;
+            sel.i0 = s.a->hdr.next;
+            sel.i1 = lim;
+            acc_sel_clip(&sel, t);
+            if (sel.i1 > sel.i0)
+                tvla_add(&s, &sel, nthr);
+            if (s.a->hdr.n - last >= evr)
+                break;
+        }
+        if (tvla_quit)
+            break;
+        last = s.a->hdr.n;
+    }
+
+    if (save_fn != NULL)
+        acc_save(s.a, save_fn);
+    if (tvla_quit && upd_fn != NULL)
+        acc_save(s.a, upd_fn);
+
+    acc_free(s.a);
+    free(s.tv);
+    trs_close(t);
+    return 0;
+}
@@ -0,0 +1,998 @@
+//  vcd.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === VCD preamble (shared) and change stream (per-trace) parsing.
+
+//  The preamble of a Verilator VCD describes ~165k signal names and is
+//  identical for every simulation of the same model. It is parsed once
+//  into an immutable vcd_hdr_t, which is cached by a hash of the
+//  definition lines; each stream then only allocates its own state.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <ctype.h>
+#include <fnmatch.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "vcd.h"
+
+//  header cache
+static vcd_hdr_t *hdr_cache = NULL;
+static pthread_mutex_t hdr_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int id_hash3(const char *id)
+{
+    int a, b, c;
+
+    a = id[0];
+    if (a < 0x20 || a > 0x7F) {
+        a = 0;
+        b = 0;
+        c = 0;
+    } else {
+        a -= 0x20;
+        b = id[1];
+        if (b < 0x20 || b > 0x7F) {
+            b = 0;
+            c = 0;
+        } else {
+            b -= 0x20;
+            c = id[2];
+            if (c < 0x20 || c > 0x7F) {
+                c = 0;
+            } else {
+                c -= 0x20;
+            }
+        }
+    }
+
+    return (96 * a + b) * 96 + c;
+}
+
+//  comparator for signal names via pointers
+static int ptr_cmp(const void *pa, const void *pb)
+{
+    return strcmp( *((char * const *) pa), *((char * const *) pb) );
+}
+
+const var_t *vcd_find_id(const vcd_hdr_t *hdr, const char *id)
+{
+    int x;
+    size_t i;
+
+    i = hdr->id_hash[id_hash3(id)];
+
+    while (i < hdr->var_n) {
+        x = strcmp(hdr->var[i].id, id);
+        if (x == 0)
+            return &hdr->var[i];
+        if (x > 0)
+            return NULL;
+        i++;
+    }
+    return NULL;
+}
+
+//  read a binary number
+
+static int64_t bin_to_int(const char *s, int d)
+{
+    int64_t i, x;
+
+    x = 0;
+    for (i = 0; i < d; i++) {
+        if (s[i] != '0' && s[i] != '1')
+            return -1;
+        x = (2 * x) + (s[i] - '0');
+    }
+
+    return x;
+}
+
+const char *vcd_signame(const vcd_hdr_t *hdr, const var_t *v)
+{
+    int i;
+    const char *s;
+
+    s = &hdr->signame[hdr->offs[v->o]];
+    i = strlen(s);
+    while (i > 0 && !isspace(s[i - 1])) {
+        i--;
+    }
+    return &s[i];
+}
+
+//  split a line into tokens (modifies the line)
+
+static size_t tokenize(char *buf, char **tok)
+{
+    size_t i, n;
+    bool flag;
+
+    n = 0;
+    flag = true;
+    for (i = 0; buf[i] != 0; i++) {
+        if (isspace(buf[i])) {
+            flag = true;
+            buf[i] = 0;
+            continue;
+        }
+        if (flag) {
+            if (n >= TOKEN_MAX)
+                break;
+            tok[n++] = &buf[i];
+            flag = false;
+        }
+    }
+    return n;
+}
+
+//  FNV-1a
+
+static uint64_t fnv1a(uint64_t h, const char *s, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= (uint8_t) s[i];
+        h *= 0x100000001B3llu;
+    }
+    return h;
+}
+
+static void hdr_free(vcd_hdr_t *hdr)
+{
+    free(hdr->timing);
+    free(hdr->w_fn);
+    free(hdr->w);
+    free(hdr->clk_g);
+    free(hdr->clk);
+    free(hdr->clk_i);
+    free(hdr->signame);
+    free(hdr->offs);
+    free(hdr->var);
+    free(hdr->id_hash);
+    free(hdr);
+}
+
+void vcd_hdr_free_all(void)
+{
+    vcd_hdr_t *hdr;
+
+    pthread_mutex_lock(&hdr_lock);
+    while (hdr_cache != NULL) {
+        hdr = hdr_cache;
+        hdr_cache = hdr->next;
+        hdr_free(hdr);
+    }
+    pthread_mutex_unlock(&hdr_lock);
+}
+
+//  power model weights, one rule per line: "<pattern> <weight>", where
+//  the pattern is a glob over full signal names; the last matching rule
+//  wins, default 1. A var with several names takes the largest weight.
+
+typedef struct {
+    char    pat[LINE_SZ_MAX];
+    double  w;
+} w_rule_t;
+
+static int hdr_weights(vcd_hdr_t *hdr, const char *fn)
+{
+    char    buf[LINE_SZ_MAX], *p;
+    FILE    *fp;
+    w_rule_t *rule = NULL;
+    size_t  i, j, k, n = 0, n_max = 0;
+    double  w, x;
+    const char *s;
+
+    fp = fopen(fn, "r");
+    if (fp == NULL) {
+        perror(fn);
+        return -1;
+    }
+    while (fgets(buf, sizeof(buf), fp) != NULL) {
+        p = buf + strspn(buf, " \t");
+        k = strcspn(p, " \t\r\n#");
+        if (k == 0)
+            continue;
+        if (n >= n_max) {
+            n_max = n_max == 0 ? 64 : 2 * n_max;
+            rule = (w_rule_t *) realloc(rule, n_max * sizeof(w_rule_t));
+            if (rule == NULL)
+                exit(-1);
+        }
+        memcpy(rule[n].pat, p, k);
+        rule[n].pat[k] = 0;
+        rule[n].w = strtod(p + k, NULL);
+        n++;
+    }
+    fclose(fp);
+
+    hdr->w = (double *) malloc((hdr->var_n + 1) * sizeof(double));
+    if (hdr->w == NULL)
+        exit(-1);
+    for (i = 0; i < hdr->var_n; i++) {
+        w = -HUGE_VAL;
+        for (j = 0; j < (size_t) hdr->var[i].n; j++) {
+            s = &hdr->signame[hdr->offs[hdr->var[i].o + j]];
+            s += strlen(s);
+            while (s > hdr->signame && !isspace(s[-1]))
+                s--;
+            x = 1.0;
+            for (k = n; k > 0; k--) {
+                if (fnmatch(rule[k - 1].pat, s, 0) == 0) {
+                    x = rule[k - 1].w;
+                    break;
+                }
+            }
+            if (x > w)
+                w = x;
+        }
+        hdr->w[i] = w;
+    }
+    free(rule);
+
+    return 0;
+}
+
+//  create a header from definition lines
+
+//  clock nets: a var is one if any of its names matches one of the
+//  comma-separated globs
+
+static void hdr_clocks(vcd_hdr_t *hdr, const char *clk_g)
+{
+    char    pat[LINE_SZ_MAX];
+    const char *p, *s;
+    size_t  i, j, k;
+
+    hdr->clk = (uint8_t *) calloc(hdr->var_n + 1, 1);
+    hdr->clk_i = (size_t *) calloc(hdr->var_n + 1, sizeof(size_t));
+    if (hdr->clk == NULL || hdr->clk_i == NULL)
+        exit(-1);
+    hdr->clk_n = 0;
+
+    for (i = 0; i < hdr->var_n; i++) {
+        for (j = 0; j < (size_t) hdr->var[i].n && !hdr->clk[i]; j++) {
+            s = &hdr->signame[hdr->offs[hdr->var[i].o + j]];
+            s += strlen(s);
+            while (s > hdr->signame && !isspace(s[-1]))
+                s--;
+            for (p = clk_g; *p != 0 && !hdr->clk[i]; p += k) {
+                p += *p == ',';
+                k = strcspn(p, ",");
+                if (k == 0 || k >= sizeof(pat))
+                    continue;
+                memcpy(pat, p, k);
+                pat[k] = 0;
+                hdr->clk[i] = fnmatch(pat, s, 0) == 0;
+            }
+        }
+        if (hdr->clk[i])
+            hdr->clk_i[hdr->clk_n++] = i;
+    }
+}
+
+static vcd_hdr_t *hdr_parse(const vcd_str_t *st)
+{
+    char    *buf, *eol;
+    char    *tok[TOKEN_MAX];
+    size_t  len[SCOPE_MAX];
+    char    nam[LINE_SZ_MAX];
+    char    tmp[2 * ID_SZ_MAX];
+    char    **ptr;
+    size_t  signame_max, offs_max;
+    size_t  i, j, l, n;
+    int     x, y, k, d, scope;
+    const char *s;
+    var_t   *var;
+    vcd_hdr_t *hdr;
+
+    hdr = (vcd_hdr_t *) calloc(1, sizeof(vcd_hdr_t));
+    if (hdr == NULL)
+        exit(-1);
+    hdr->h = st->pre_h;
+    hdr->timing = strdup(st->timing);
+    hdr->w_fn = st->w_fn == NULL ? NULL : strdup(st->w_fn);
+    hdr->clk_g = st->clk_g == NULL ? NULL : strdup(st->clk_g);
+
+    //  allocate buffers
+    signame_max = 0x100000;     //  initial buffer size for signal names
+    hdr->signame = (char *) malloc(signame_max);
+    offs_max = 0x10000;         //  initiial number of signal names
+    hdr->offs = (size_t *) calloc(offs_max, sizeof(size_t));
+    if (hdr->timing == NULL || hdr->signame == NULL || hdr->offs == NULL)
+        exit(-1);
+
+    //  definitions; one per line
+    scope = 0;
+    k = 0;
+    nam[0] = 0;
+    for (buf = st->pre; buf < st->pre + st->pre_sz; buf = eol + 1) {
+        eol = (char *) memchr(buf, '\n', st->pre + st->pre_sz - buf);
+        *eol = 0;
+        n = tokenize(buf, tok);
+
+        if (n >= 3 && strcmp(tok[0], "$scope") == 0) {
+            if (scope >= SCOPE_MAX)
+                goto wire_too_long;
+            l = strlen(tok[2]);
+            if (k + l + 1 >= LINE_SZ_MAX)
+                goto wire_too_long;
+            len[scope] = l;
+            memcpy(nam + k, tok[2], l);
+            k += l;
+            nam[k++] = '.';
+            nam[k] = 0;
+            scope++;
+            continue;
+        }
+        if (n >= 1 && strcmp(tok[0], "$upscope") == 0) {
+            if (scope >= 1) {
+                scope--;
+                k -= len[scope] + 1;
+                if (k < 0)
+                    k = 0;
+                nam[k] = 0;
+            }
+            continue;
+        }
+        if (n >= 6 && strcmp(tok[0], "$var") == 0) {
+
+            d = atoi(tok[2]);
+            if (d < 0)
+                d = 0;
+            j = k;
+            l = strlen(tok[4]);
+            if (j + l >= sizeof(nam))
+                goto wire_too_long;
+            memcpy(&nam[j], tok[4], l);
+            j += l;
+            if (n >= ID_SZ_MAX - 1) {
+                l = strlen(tok[5]);
+                if (j + l >= sizeof(nam))
+                    goto wire_too_long;
+                memcpy(&nam[j], tok[5], l);
+                j += l;
+            }
+            nam[j] = 0;
+
+            l = strlen(tok[3]);
+            if (hdr->signame_sz + j + l + 20 >= signame_max) {
+                signame_max <<= 1;
+                hdr->signame = (char *) realloc(hdr->signame, signame_max);
+                if (hdr->signame == NULL)
+                    exit(-1);
+            }
+
+            if (hdr->offs_n + 1 >= offs_max) {
+                offs_max <<= 1;
+                hdr->offs = (size_t *)
+                    realloc(hdr->offs, offs_max * sizeof(size_t));
+                if (hdr->offs == NULL)
+                    exit(-1);
+            }
+            hdr->offs[hdr->offs_n++] = hdr->signame_sz;
+
+            memcpy(&hdr->signame[hdr->signame_sz], tok[3], l);
+            hdr->signame_sz += l;
+            snprintf(tmp, sizeof(tmp), " %d ", d);
+            l = strlen(tmp);
+            memcpy(&hdr->signame[hdr->signame_sz], tmp, l);
+            hdr->signame_sz += l;
+
+            memcpy(&hdr->signame[hdr->signame_sz], nam, j);
+            hdr->signame_sz += j;
+            hdr->signame[hdr->signame_sz++] = 0;
+
+            //  shorten the name again
+            nam[k] = 0;
+        }
+    }
+
+    //  sort it (via pointers, as the buffer is now final)
+    ptr = (char **) calloc(hdr->offs_n + 1, sizeof(char *));
+    if (ptr == NULL)
+        exit(-1);
+    for (i = 0; i < hdr->offs_n; i++)
+        ptr[i] = &hdr->signame[hdr->offs[i]];
+    qsort(ptr, hdr->offs_n, sizeof(char *), ptr_cmp);
+    for (i = 0; i < hdr->offs_n; i++)
+        hdr->offs[i] = ptr[i] - hdr->signame;
+    free(ptr);
+
+    hdr->st_sz = 0;
+    hdr->max_dim = 0;
+
+    hdr->var_n = 0;
+    hdr->var = (var_t *) calloc(hdr->offs_n + 1, sizeof(var_t));
+    if (hdr->var == NULL)
+        exit(-1);
+    var = hdr->var;
+
+    for (i = 0; i < hdr->offs_n; i++) {
+        s = &hdr->signame[hdr->offs[i]];
+        for (l = 0; l < ID_SZ_MAX; l++) {
+            if (s[l] == ' ' || s[l] == 0)
+                break;
+        }
+        if (l >= ID_SZ_MAX)
+            l = ID_SZ_MAX - 1;
+        memcpy(tmp, s, l);
+        memset(tmp + l, 0, ID_SZ_MAX - l);
+        d = atoi(&s[l]);
+        if (d < 0)
+            d = 0;
+        if (d > hdr->max_dim)
+            hdr->max_dim = d;
+
+        if (hdr->var_n == 0 || strcmp(var[hdr->var_n - 1].id, tmp) != 0) {
+            memcpy(var[hdr->var_n].id, tmp, ID_SZ_MAX);
+            var[hdr->var_n].n = 1;
+            var[hdr->var_n].d = d;
+            var[hdr->var_n].o = i;
+            var[hdr->var_n].p = hdr->st_sz;
+            hdr->st_sz += d;
+            hdr->var_n++;
+        } else {
+            if (var[hdr->var_n - 1].d != d) {
+                fprintf(stderr, "ERROR  Dimension mismatch: %s %d != %d\n",
+                        tmp, d, var[hdr->var_n - 1].d);
+            }
+            var[hdr->var_n - 1].n++;
+        }
+    }
+
+    //  create a hash table
+
+    hdr->id_hash = (size_t *) calloc(ID_HASH_MAX, sizeof(size_t));
+    if (hdr->id_hash == NULL)
+        exit(-1);
+    y = 0;
+    j = 0;
+    for (i = 0; i < hdr->var_n; i++) {
+        x = id_hash3(var[i].id);
+        if (x > y) {
+            while (y < x) {
+                hdr->id_hash[y++] = j;
+            }
+            hdr->id_hash[x] = i;
+        }
+        y = x;
+        j = i;
+    }
+    while (y < ID_HASH_MAX) {
+        hdr->id_hash[y++] = j;
+    }
+
+    //  try to match the timing signal
+    hdr->cyc_v = NULL;
+    for (i = 0; i < hdr->var_n; i++) {
+        if (strstr(vcd_signame(hdr, &var[i]), st->timing) != NULL) {
+            hdr->cyc_v = &var[i];
+            break;
+        }
+    }
+
+    if (hdr->w_fn != NULL && hdr_weights(hdr, hdr->w_fn) != 0)
+        exit(-1);
+    if (hdr->clk_g != NULL)
+        hdr_clocks(hdr, hdr->clk_g);
+
+    return hdr;
+
+wire_too_long:
+    fprintf(stderr, "%s:%lu  Parse error -- wire name too long.\n",
+            st->fn, st->line);
+    exit(0);
+}
+
+//  cached header for the stream; hdr_lock held
+
+static vcd_hdr_t *hdr_find(const vcd_str_t *st)
+{
+    vcd_hdr_t *hdr;
+
+    for (hdr = hdr_cache; hdr != NULL; hdr = hdr->next) {
+        if (hdr->h == st->pre_h && strcmp(hdr->timing, st->timing) == 0 &&
+            (hdr->w_fn == NULL ? st->w_fn == NULL :
+                st->w_fn != NULL && strcmp(hdr->w_fn, st->w_fn) == 0) &&
+            (hdr->clk_g == NULL ? st->clk_g == NULL :
+                st->clk_g != NULL && strcmp(hdr->clk_g, st->clk_g) == 0))
+            break;
+    }
+    return hdr;
+}
+
+//  find a cached header or parse a new one. The parse runs unlocked so
+//  that other streams are not held up; if another thread cached the same
+//  header meanwhile, that one is used and ours is dropped.
+
+static const vcd_hdr_t *hdr_get(const vcd_str_t *st)
+{
+    vcd_hdr_t *hdr, *nh;
+
+    pthread_mutex_lock(&hdr_lock);
+    hdr = hdr_find(st);
+    pthread_mutex_unlock(&hdr_lock);
+    if (hdr != NULL)
+        return hdr;
+
+    nh = hdr_parse(st);
+
+    pthread_mutex_lock(&hdr_lock);
+    hdr = hdr_find(st);
+    if (hdr == NULL) {
+        hdr = nh;
+        hdr->next = hdr_cache;
+        hdr_cache = hdr;
+        nh = NULL;
+    }
+    pthread_mutex_unlock(&hdr_lock);
+    if (nh != NULL)
+        hdr_free(nh);
+
+    return hdr;
+}
+
+void vcd_str_init(vcd_str_t *st, const char *fn, FILE *out,
+                    const char *timing, int64_t thresh,
+                    const int64_t *dump_tim)
+{
+    memset(st, 0, sizeof(vcd_str_t));
+    st->fn      = fn;
+    st->out     = out;
+    st->timing  = timing;
+    st->thresh  = thresh;
+    st->dump_tim = dump_tim;
+    st->in_pre  = true;
+    st->pre_h   = 0xCBF29CE484222325llu;
+    st->pre_max = 0x100000;
+    st->pre     = (char *) malloc(st->pre_max);
+    if (st->pre == NULL)
+        exit(-1);
+}
+
+void vcd_str_model(vcd_str_t *st, const char *w_fn, bool hw)
+{
+    st->w_fn    = w_fn;
+    st->hw      = hw;
+    st->pm      = w_fn != NULL || hw;
+}
+
+void vcd_str_step(vcd_str_t *st, bool step)
+{
+    st->step    = step;
+}
+
+void vcd_str_clock(vcd_str_t *st, const char *clk_g, bool edge, bool rf)
+{
+    st->clk_g   = clk_g;
+    st->edge    = edge && clk_g != NULL;
+    st->rf      = rf && clk_g != NULL;
+    if (st->edge)
+        st->step = true;
+}
+
+//  preamble ends; attach the shared header and set up private state
+
+static void str_start(vcd_str_t *st)
+{
+    const vcd_hdr_t *hdr;
+
+    hdr = hdr_get(st);
+    st->hdr = hdr;
+    free(st->pre);
+    st->pre = NULL;
+    st->in_pre = false;
+
+    if (st->out != NULL) {
+        fprintf(st->out, "%s preamble: %lu lines, %lu signames, %lu ids, "
+                "max var %d, tot %zu bits.\n",
+                st->fn, st->line, hdr->offs_n, hdr->var_n,
+                hdr->max_dim, hdr->st_sz);
+    }
+
+    //  initialize state array
+    st->state = (char *) malloc(hdr->st_sz + 1);
+    st->seen = (uint8_t *) calloc(hdr->var_n + 1, 1);
+    if (st->state == NULL || st->seen == NULL)
+        exit(-1);
+    memset(st->state, 'x', hdr->st_sz);
+
+    if (st->out == NULL) {
+        //  quiet
+    } else if (hdr->cyc_v != NULL) {
+        fprintf(st->out, "[info] timing signal: %s\n",
+                vcd_signame(hdr, hdr->cyc_v));
+    } else {
+        fprintf(st->out, "[info] timing signal not found; using ticks: %s\n",
+                st->timing);
+    }
+    if (st->out != NULL && st->pm) {
+        fprintf(st->out, "[info] power model: %s, weights: %s\n",
+                st->hw ? "hw" : "hd", st->w_fn != NULL ? st->w_fn : "1");
+    }
+    if (st->out != NULL && st->clk_g != NULL) {
+        fprintf(st->out, "[info] clock nets: %zu (%s)%s%s\n", hdr->clk_n,
+                st->clk_g, st->edge ? ", one step per cycle" : "",
+                st->rf ? ", rise/fall columns" : "");
+    }
+
+    //  read the actual changes
+    st->hd  = 0;        //  hamming distance
+    st->pw  = 0.0;      //  weighted
+    st->tim = 0;
+    st->cyc = -1;
+}
+
+//  a preamble line
+
+static void str_pre_line(vcd_str_t *st, const char *buf, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len && isspace(buf[i]); i++)
+        ;
+    buf += i;
+    len -= i;
+
+    //  the date changes between runs; not part of the definitions
+    if (st->in_date || (len >= 5 && memcmp(buf, "$date", 5) == 0)) {
+        st->in_date = memmem(buf, len, "$end", 4) == NULL;
+        return;
+    }
+    if (len >= 15 && memcmp(buf, "$enddefinitions", 15) == 0) {
+        str_start(st);
+        return;
+    }
+    if (!(len >= 4 && memcmp(buf, "$var", 4) == 0) &&
+        !(len >= 6 && memcmp(buf, "$scope", 6) == 0) &&
+        !(len >= 8 && memcmp(buf, "$upscope", 8) == 0))
+        return;
+
+    st->pre_h = fnv1a(st->pre_h, buf, len);
+    if (st->pre_sz + len + 1 >= st->pre_max) {
+        while (st->pre_sz + len + 1 >= st->pre_max)
+            st->pre_max <<= 1;
+        st->pre = (char *) realloc(st->pre, st->pre_max);
+        if (st->pre == NULL)
+            exit(-1);
+    }
+    memcpy(st->pre + st->pre_sz, buf, len);
+    st->pre_sz += len;
+    st->pre[st->pre_sz++] = '\n';
+}
+
+//  a new cycle if the counter changed: report the previous one
+
+static void str_cycle(vcd_str_t *st)
+{
+    size_t i;
+
+    if (st->ncyc <= st->cyc)
+        return;
+    if (st->pm)
+        st->hd = llround(st->pw);
+    if (st->pm)
+        st->hd_f = llround(st->pw_f);
+    if (st->cyc >= 0 && st->hd >= st->thresh) {
+        if (st->out != NULL && st->rf) {
+            fprintf(st->out, "#%8ld [togd]  %ld %ld %ld\n",
+                    st->cyc, st->hd, st->hd - st->hd_f, st->hd_f);
+        } else if (st->out != NULL) {
+            fprintf(st->out, "#%8ld [togd]  %ld\n", st->cyc, st->hd);
+        }
+        if (st->cyc_fn != NULL)
+            st->cyc_fn(st->arg, st->cyc, st->hd);
+        st->hd = 0;
+        st->pw = 0.0;
+        st->hd_f = 0;
+        st->pw_f = 0.0;
+    }
+    st->cyc = st->ncyc;
+
+    //  is this one of the "dump cycles"
+    if (st->dump_tim != NULL) {
+        st->sigd = false;
+        i = 0;
+        while (st->dump_tim[i] >= 0 && !st->sigd) {
+            st->sigd = (st->dump_tim[i++] == st->cyc);
+        }
+    }
+}
+
+//  [sigd] lines of a step are sorted by name
+
+static int chg_cmp(const void *a, const void *b, void *hdr)
+{
+    const vcd_hdr_t *h = (const vcd_hdr_t *) hdr;
+
+    return strcmp(vcd_signame(h, ((const vcd_chg_t *) a)->v),
+                    vcd_signame(h, ((const vcd_chg_t *) b)->v));
+}
+
+//  set bits of the clock nets at the end of a step; -1 if any is unknown
+
+static int64_t str_clk_ones(const vcd_str_t *st, const var_t *v)
+{
+    const char *vs = &st->state[v->p];
+    int64_t n = 0;
+    int     i;
+
+    if (!st->seen[v - st->hdr->var])
+        return -1;
+    for (i = 0; i < v->d; i++)
+        n += vs[i] == '1';
+    return n;
+}
+
+//  edge: every clock net that is high had a rise and a fall in the cycle;
+//  its first value is not a toggle (as in a full dump), only the fall is
+
+static void str_edge(vcd_str_t *st)
+{
+    const vcd_hdr_t *hdr = st->hdr;
+    const var_t *v;
+    int64_t n, k;
+    double  w;
+    size_t  i;
+    bool    first;
+
+    for (i = 0; i < hdr->clk_n; i++) {
+        v = &hdr->var[hdr->clk_i[i]];
+        first = st->seen[hdr->clk_i[i]] == 2;
+        if (first)
+            st->seen[hdr->clk_i[i]] = 1;
+        n = str_clk_ones(st, v);
+        if (n <= 0)
+            continue;
+        k = first ? n : 2 * n;
+        if (st->sig_fn != NULL)
+            st->sig_fn(st->arg, v, k);
+        if (st->sigd && k >= st->thresh && st->out != NULL) {
+            fprintf(st->out, "[sigd] %8ld  %ld_%s\n",
+                    k, st->cyc, vcd_signame(hdr, v));
+        }
+        st->hd += k;
+        st->hd_f += n;
+        if (st->pm) {
+            w = hdr->w != NULL ? hdr->w[v - hdr->var] : 1.0;
+            st->pw += w * (st->hw ? k - n : k);
+            st->pw_f += st->hw ? 0.0 : w * n;
+        }
+    }
+}
+
+//  a change: hooks, [sigd] line, and the sums of the cycle and the step
+
+static void str_add(vcd_str_t *st, const var_t *v, int64_t sd, double pw)
+{
+    if (st->sig_fn != NULL && sd > 0)
+        st->sig_fn(st->arg, v, sd);
+    if (st->sigd && sd >= st->thresh && st->out != NULL) {
+        fprintf(st->out, "[sigd] %8ld  %ld_%s\n",
+                sd, st->cyc, vcd_signame(st->hdr, v));
+    }
+    st->hd += sd;
+    st->pw += pw;
+    st->hd_s += sd;
+    st->pw_s += pw;
+}
+
+//  end of a time step. With step, all of its changes belong to the cycle
+//  that the counter has at the end of the step, whatever order they were
+//  listed in; otherwise they have been counted as they were read.
+
+static void str_step(vcd_str_t *st)
+{
+    const vcd_chg_t *c;
+    size_t  i;
+    bool    fall;
+
+    if (st->step) {
+        str_cycle(st);
+        if (st->sigd && st->out != NULL && st->chg_n > 1) {
+            qsort_r(st->chg, st->chg_n, sizeof(vcd_chg_t), chg_cmp,
+                    (void *) st->hdr);
+        }
+        for (i = 0; i < st->chg_n; i++) {
+            c = &st->chg[i];
+            str_add(st, c->v, c->sd, c->pw);
+        }
+        st->chg_n = 0;
+    }
+
+    if (st->edge && st->hdr != NULL)
+        str_edge(st);
+
+    //  a falling edge step: every (known) clock net is low
+    if (st->rf && !st->edge && st->hdr != NULL) {
+        fall = st->hdr->clk_n > 0;
+        for (i = 0; i < st->hdr->clk_n && fall; i++)
+            fall = str_clk_ones(st, &st->hdr->var[st->hdr->clk_i[i]]) <= 0;
+        if (fall) {
+            st->hd_f += st->hd_s;
+            st->pw_f += st->pw_s;
+        }
+    }
+    st->hd_s = 0;
+    st->pw_s = 0.0;
+}
+
+//  a value change line (NUL-terminated)
+
+static void str_chg_line(vcd_str_t *st, char *chg)
+{
+    const vcd_hdr_t *hdr = st->hdr;
+    const var_t *v;
+    vcd_chg_t *c;
+    char    *s, *r, *vs;
+    int64_t sd, hw;
+    double  pw;
+    size_t  i;
+    int     d;
+
+    if (chg[0] == 0 || chg[0] == '\n')
+        return;
+
+    //  new time
+    if (chg[0] == '#') {
+        str_step(st);
+        st->tim = (int64_t) atoll(&chg[1]);
+        if (hdr->cyc_v == NULL) {
+            st->ncyc = st->tim;
+            str_cycle(st);
+        }
+        return;
+    }
+
+    s = chg;        //  bit data
+    r = s;          //  signal name
+    d = 0;          //  length of bit data
+
+    if (chg[0] == '0' || chg[0] == '1') {
+        d = 1;
+        s = chg;
+        r = chg + 1;
+    } else if (chg[0] == 'b' || chg[0] == 'B') {
+        s++;
+        d = 0;
+        while(s[d] == '0' || s[d] == '1')
+            d++;
+        r = s + d;
+        while(*r == ' ')
+            r++;
+    } else {
+        fprintf(stderr, "%s:%lu ERROR  format: %s\n",
+                st->fn, st->line, chg);
+        return;
+    }
+
+    for (i = 0; i < ID_SZ_MAX - 1; i++) {
+        if (r[i] == 0 || isspace(r[i]))
+            break;
+    }
+    r[i] = 0;
+
+    v = vcd_find_id(hdr, r);
+    if (v == NULL) {
+        fprintf(stderr, "%s:%lu ERROR  id %s not found: %s\n",
+                st->fn, st->line, r, chg);
+        return;
+    }
+    if (d != v->d) {
+        fprintf(stderr, "%s:%lu ERROR  wrong dimension (%d): %s\n",
+                st->fn, st->line, v->d, chg);
+        return;
+    }
+
+    vs = &st->state[v->p];
+    if (st->edge && hdr->clk[v - hdr->var]) {
+        //  edge: clock nets count by value at the end of the step
+        memcpy(vs, s, d);
+        if (!st->seen[v - hdr->var])
+            st->seen[v - hdr->var] = 2;
+    } else if (st->seen[v - hdr->var]) {
+        sd = 0;
+        for (i = 0; i < (size_t) d; i++) {
+            if (vs[i] != s[i]) {
+                sd++;
+            }
+            vs[i] = s[i];
+        }
+
+        //  power model: weight x (distance or weight of the new value)
+        pw = 0.0;
+        if (st->pm) {
+            hw = sd;
+            if (st->hw) {
+                hw = 0;
+                for (i = 0; i < (size_t) d; i++)
+                    hw += s[i] == '1';
+            }
+            pw = (hdr->w != NULL ? hdr->w[v - hdr->var] : 1.0) * hw;
+        }
+
+        if (!st->step) {
+            str_add(st, v, sd, pw);
+        } else {
+            if (st->chg_n >= st->chg_max) {
+                st->chg_max = st->chg_max > 0 ? 2 * st->chg_max : 1024;
+                st->chg = (vcd_chg_t *)
+                    realloc(st->chg, st->chg_max * sizeof(vcd_chg_t));
+                if (st->chg == NULL)
+                    exit(-1);
+            }
+            c = &st->chg[st->chg_n++];
+            c->v = v;
+            c->sd = sd;
+            c->pw = pw;
+        }
+    } else {
+        memcpy(vs, s, d);
+        st->seen[v - hdr->var] = 1;
+    }
+
+    //  a cycle counter signal?
+    if (v == hdr->cyc_v) {
+        st->ncyc = bin_to_int(s, d);
+        if (!st->step)
+            str_cycle(st);
+    }
+}
+
+size_t vcd_str_feed(vcd_str_t *st, char *buf, size_t len)
+{
+    char *p, *eol, *end;
+
+    p = buf;
+    end = buf + len;
+    while (p < end && (eol = (char *) memchr(p, '\n', end - p)) != NULL) {
+        st->line++;
+        if (st->in_pre) {
+            str_pre_line(st, p, eol - p);
+        } else {
+            *eol = 0;
+            str_chg_line(st, p);
+        }
+        p = eol + 1;
+    }
+    return p - buf;
+}
+
+void vcd_str_end(vcd_str_t *st, char *buf, size_t len)
+{
+    //  last line may lack a newline (buf must have room for a NUL)
+    if (len > 0) {
+        st->line++;
+        buf[len] = 0;
+        if (st->in_pre) {
+            str_pre_line(st, buf, len);
+        } else {
+            str_chg_line(st, buf);
+        }
+    }
+    if (st->in_pre)
+        str_start(st);
+    str_step(st);
+
+    if (st->out != NULL) {
+        fprintf(st->out, "%s total: %lu lines, last time %ld  cycle %ld.\n",
+            st->fn, st->line, st->tim, st->cyc);
+    }
+
+    free(st->pre);
+    free(st->state);
+    free(st->seen);
+    free(st->chg);
+    st->pre = NULL;
+    st->state = NULL;
+    st->seen = NULL;
+    st->chg = NULL;
+    st->chg_n = st->chg_max = 0;
+}
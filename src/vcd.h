@@ -0,0 +1,159 @@
+//  vcd.h
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === VCD preamble (shared) and change stream (per-trace) parsing.
+
+#ifndef _VCD_H_
+#define _VCD_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINE_SZ_MAX 1024
+#define TOKEN_MAX   16
+#define ID_SZ_MAX   8
+#define SCOPE_MAX   100
+
+//  hash table; contains an index to *var array
+#define ID_HASH_MAX (96 * 96 * 96)
+
+typedef struct {
+    char id[ID_SZ_MAX];     //  identifier
+    int d;                  //  width
+    int n;                  //  how many signal names
+    size_t o;               //  first signal name
+    size_t p;               //  offset of state in the state array
+} var_t;
+
+//  immutable header data; shared by all streams from the same design
+
+typedef struct vcd_hdr_s {
+    uint64_t h;             //  hash of the definitions
+    char    *timing;        //  timing signal pattern
+    char    *signame;       //  buffer for signal names
+    size_t  signame_sz;     //  size
+    size_t  *offs;          //  sorted offsets in signal names
+    size_t  offs_n;
+    var_t   *var;           //  signal variables
+    size_t  var_n;
+    size_t  *id_hash;       //  index to var[] by first three id chars
+    int     max_dim;        //  largest signal width
+    size_t  st_sz;          //  total number of state bits
+    var_t   *cyc_v;         //  signal with cycle counter (or NULL)
+    char    *w_fn;          //  weight file (or NULL)
+    double  *w;             //  weight of each var (or NULL: all 1)
+    char    *clk_g;         //  clock net globs (or NULL)
+    uint8_t *clk;           //  is the var a clock net? (or NULL)
+    size_t  *clk_i;         //  indices of the clock nets
+    size_t  clk_n;
+    struct vcd_hdr_s *next; //  header cache
+} vcd_hdr_t;
+
+//  a change of the current time step (applied when the step ends)
+
+typedef struct {
+    const var_t *v;         //  variable
+    int64_t sd;             //  toggled bits
+    double  pw;             //  power model contribution
+} vcd_chg_t;
+
+//  private state of a single VCD stream
+
+typedef struct {
+    const char *fn;         //  file name for messages
+    FILE    *out;           //  toggle output (or NULL)
+    const char *timing;     //  timing signal pattern
+    int64_t thresh;         //  toggle threshold
+    const int64_t *dump_tim;    //  report cycles (terminated by -1)
+
+    uint64_t line;          //  line number
+    bool    in_pre;         //  still reading the preamble
+    bool    in_date;        //  inside a $date .. $end block
+    uint64_t pre_h;         //  running hash of the definitions
+    char    *pre;           //  preamble text (kept until header known)
+    size_t  pre_sz;
+    size_t  pre_max;
+
+    const vcd_hdr_t *hdr;   //  shared header
+    char    *state;         //  signal states
+    uint8_t *seen;          //  has the var been assigned yet?
+
+    int64_t tim;            //  current time step
+    int64_t cyc, ncyc;      //  cycle counter (from signals)
+    int64_t hd;             //  hamming distance at time step
+    const char *w_fn;       //  power model: weight file (or NULL)
+    bool    hw;             //  power model: weight of new value, not hd
+    bool    pm;             //  power model in use
+    double  pw;             //  weighted toggles at time step
+    bool    sigd;           //  dump signal changes?
+    const char *clk_g;      //  clock nets: comma-separated globs (or NULL)
+    bool    edge;           //  one time step per cycle, after the posedge
+    bool    rf;             //  rise and fall columns
+    int64_t hd_f;           //  falling edge part of hd
+    double  pw_f;           //  .. and of pw
+    bool    step;           //  apply the changes of a step at its end
+    vcd_chg_t *chg;         //  changes of the current time step (step)
+    size_t  chg_n, chg_max;
+    int64_t hd_s;           //  toggles of the current time step
+    double  pw_s;
+
+    //  optional hooks: a cycle is complete / a signal toggled
+    void    (*cyc_fn)(void *arg, int64_t cyc, int64_t hd);
+    void    (*sig_fn)(void *arg, const var_t *v, int64_t sd);
+    void    *arg;
+} vcd_str_t;
+
+//  look up a variable by id
+const var_t *vcd_find_id(const vcd_hdr_t *hdr, const char *id);
+
+//  last component (full hierarchical name) of a signal name
+const char *vcd_signame(const vcd_hdr_t *hdr, const var_t *v);
+
+//  start a stream; output goes to "out" (NULL: hooks only)
+void vcd_str_init(vcd_str_t *st, const char *fn, FILE *out,
+                    const char *timing, int64_t thresh,
+                    const int64_t *dump_tim);
+
+//  power model (before the first feed): per-signal weights from file
+//  w_fn (NULL: 1), and hamming weight of new values instead of distance
+void vcd_str_model(vcd_str_t *st, const char *w_fn, bool hw);
+
+//  apply the changes of a time step together when it ends (before the
+//  first feed): they count for the cycle that the counter has at the end
+//  of the step, and the [sigd] lines of a step are sorted by name. By
+//  default a change counts as it is read. FST input always uses this.
+void vcd_str_step(vcd_str_t *st, bool step);
+
+//  clock nets (before the first feed). Plain dumps have a step for each
+//  clock edge: with rf, the steps where every clock net is low are counted
+//  as the falling edge. With edge, a dump has one step per cycle, after
+//  the posedge; a clock net that is high then rose and will fall in the
+//  cycle, so it counts as two toggles (one of each) instead of by change;
+//  in the step of its first value only the fall counts. edge implies step.
+void vcd_str_clock(vcd_str_t *st, const char *clk_g, bool edge, bool rf);
+
+//  feed data; returns number of bytes consumed (only complete lines)
+size_t vcd_str_feed(vcd_str_t *st, char *buf, size_t len);
+
+//  process a final line without a newline, print summary, free state
+void vcd_str_end(vcd_str_t *st, char *buf, size_t len);
+
+//  free all cached headers
+void vcd_hdr_free_all(void);
+
+#ifdef VCD_FST
+//  run an initialized stream over an FST file (vcd_fst.c), including the
+//  final vcd_str_end(); -1 if it can't be opened (stream not ended)
+int vcd_fst_read(vcd_str_t *st, const char *fn);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+//  vcd_fst.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === FST input: hierarchy and value changes fed to the VCD line parser.
+
+//  The FST reader (fstapi.c of GTKWave, shipped with Verilator under
+//  include/gtkwave) decodes the compressed blocks; each change is turned
+//  back into a VCD line and fed to the same parser, so the output is the
+//  same as from the VCD of the run. Ids are made from the FST handles.
+//  FST lists the changes of a time step by handle, not in the order of
+//  the VCD, so the stream applies them only when the step ends
+//  (vcd_str_step); the output is that of the VCD read with readvcd -s.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fstapi.h"
+#include "vcd.h"
+
+#define FST_BUF_SZ  0x100000
+
+typedef struct {
+    vcd_str_t   *st;
+    char        *buf;       //  complete VCD lines
+    size_t      buf_n, buf_sz;
+    uint32_t    *len;       //  width of each handle, 0 = skipped
+    uint64_t    tim;        //  last time written
+    bool        tim_ok;
+} fst_rd_t;
+
+//  hand over the buffered lines
+
+static void fst_flush(fst_rd_t *r)
+{
+    size_t n;
+
+    n = vcd_str_feed(r->st, r->buf, r->buf_n);
+    r->buf_n -= n;
+    memmove(r->buf, r->buf + n, r->buf_n);
+}
+
+//  room for l more bytes
+
+static char *fst_room(fst_rd_t *r, size_t l)
+{
+    if (r->buf_n + l + 1 > r->buf_sz)
+        fst_flush(r);
+    if (r->buf_n + l + 1 > r->buf_sz) {
+        while (r->buf_n + l + 1 > r->buf_sz)
+            r->buf_sz <<= 1;
+        r->buf = (char *) realloc(r->buf, r->buf_sz);
+        if (r->buf == NULL)
+            exit(-1);
+    }
+    return r->buf + r->buf_n;
+}
+
+//  VCD identifier of a handle (94 printable characters, as Verilator)
+
+static size_t fst_id(char *s, fstHandle h)
+{
+    size_t l = 0;
+
+    h--;
+    do {
+        s[l++] = '!' + h % 94;
+        h /= 94;
+    } while (h > 0);
+    s[l] = 0;
+
+    return l;
+}
+
+//  value change callback
+
+static void fst_chg(void *arg, uint64_t t, fstHandle h,
+                    const unsigned char *val)
+{
+    fst_rd_t *r = (fst_rd_t *) arg;
+    char    *p;
+    uint32_t l = r->len[h];
+
+    if (l == 0)
+        return;
+    if (!r->tim_ok || t != r->tim) {
+        p = fst_room(r, 24);
+        r->buf_n += sprintf(p, "#%lu\n", (unsigned long) t);
+        r->tim = t;
+        r->tim_ok = true;
+    }
+    p = fst_room(r, l + ID_SZ_MAX + 4);
+    if (l == 1) {
+        *p++ = val[0];
+    } else {
+        *p++ = 'b';
+        memcpy(p, val, l);
+        p += l;
+        *p++ = ' ';
+    }
+    p += fst_id(p, h);
+    *p++ = '\n';
+    r->buf_n = p - r->buf;
+}
+
+int vcd_fst_read(vcd_str_t *st, const char *fn)
+{
+    fst_rd_t    r;
+    void        *ctx;
+    struct fstHier *h;
+    char        id[ID_SZ_MAX + 8];
+    char        *p;
+    size_t      l;
+
+    ctx = fstReaderOpen(fn);
+    if (ctx == NULL) {
+        fprintf(stderr, "%s: not an FST file\n", fn);
+        return -1;
+    }
+
+    vcd_str_step(st, true);
+    memset(&r, 0, sizeof(r));
+    r.st = st;
+    r.buf_sz = FST_BUF_SZ;
+    r.buf = (char *) malloc(r.buf_sz);
+    r.len = (uint32_t *) calloc(fstReaderGetMaxHandle(ctx) + 1,
+                                sizeof(uint32_t));
+    if (r.buf == NULL || r.len == NULL)
+        exit(-1);
+
+    //  definitions
+    while ((h = fstReaderIterateHier(ctx)) != NULL) {
+        switch (h->htyp) {
+
+            case FST_HT_SCOPE:
+                l = strlen(h->u.scope.name);
+                p = fst_room(&r, l + 32);
+                r.buf_n += sprintf(p, "$scope module %s $end\n",
+                                    h->u.scope.name);
+                break;
+
+            case FST_HT_UPSCOPE:
+                p = fst_room(&r, 16);
+                r.buf_n += sprintf(p, "$upscope $end\n");
+                break;
+
+            case FST_HT_VAR:
+                //  only bit vectors; the VCD path rejects reals too
+                if (h->u.var.typ == FST_VT_VCD_REAL ||
+                    h->u.var.typ == FST_VT_VCD_REAL_PARAMETER ||
+                    h->u.var.typ == FST_VT_VCD_REALTIME ||
+                    h->u.var.typ == FST_VT_SV_SHORTREAL ||
+                    h->u.var.typ == FST_VT_GEN_STRING ||
+                    h->u.var.length == 0)
+                    break;
+                r.len[h->u.var.handle] = h->u.var.length;
+                fst_id(id, h->u.var.handle);
+                l = strlen(h->u.var.name);
+                p = fst_room(&r, l + 64);
+                r.buf_n += sprintf(p, "$var wire %u %s %s $end\n",
+                                    h->u.var.length, id, h->u.var.name);
+                break;
+        }
+    }
+    p = fst_room(&r, 32);
+    r.buf_n += sprintf(p, "$enddefinitions $end\n");
+    fst_flush(&r);
+
+    //  changes, in time order
+    fstReaderSetFacProcessMaskAll(ctx);
+    fstReaderIterBlocks(ctx, fst_chg, &r, NULL);
+    fst_flush(&r);
+    vcd_str_end(st, r.buf, r.buf_n);
+
+    fstReaderClose(ctx);
+    free(r.buf);
+    free(r.len);
+
+    return 0;
+}
@@ -0,0 +1,538 @@
+//  vcdbench.c
+//  2026-10-19  Markku-Juhani O. Saarinen <mjos@iki.fi>
+//  === Synthetic VCD generator and trace pipeline microbenchmarks.
+
+//  The generator writes a Verilator-like VCD: a clock, the dec_prim.cyc
+//  cycle counter, and n ids with widths drawn from a distribution, extra
+//  names (aliases) for some ids, nested scopes, and a given fraction of
+//  the ids changing in each half cycle. The defaults approximate the
+//  Adams Bridge sign trace (~100k ids, ~165k names, ~2.6M state bits).
+//  The benchmarks run the parser of vcd.c (as readvcd does, on 1 MB
+//  chunks) on generated data in memory. Results are printed as lines
+//  "[bench] <name> <value> <unit>" for comparing commits.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "vcd.h"
+
+#define READ_SZ     0x100000        //  feed granularity (as readvcd)
+#define WCLS_MAX    16
+
+const char usage[] =
+    "Usage: vcdbench [options] [gen | parse | lookup | hd | all]\n\n"
+    "gen writes a synthetic VCD to stdout; the others time the parser on\n"
+    "one in memory (default: all).\n\n"
+    "\t-n\t<n>\tnumber of ids (default 100160)\n"
+    "\t-a\t<f>\textra names per id (default 0.65)\n"
+    "\t-W\t<dist>\twidths \"w:weight,..\" (default: sign trace profile)\n"
+    "\t-d\t<f>\tfraction of ids changing per cycle (default 0.08)\n"
+    "\t-c\t<n>\tclock cycles (default 250)\n"
+    "\t-i\t<n>\tminimum id length, up to 7 (default 1)\n"
+    "\t-h\t<n>\tscope depth (default 4)\n"
+    "\t-s\t<n>\trandom seed (default 1)\n"
+    "\t-r\t<n>\trepetitions, the best is reported (default 3)\n";
+
+typedef struct {
+    int         w;
+    double      p;
+} wcls_t;
+
+typedef struct {
+    size_t      n_id;
+    double      alias;
+    wcls_t      cls[WCLS_MAX];
+    int         n_cls;
+    double      dens;
+    int64_t     ncyc;
+    int         id_len;
+    int         depth;
+    uint64_t    seed;
+} gen_t;
+
+//  growing output buffer; flushed to fp if set
+
+typedef struct {
+    char        *b;
+    size_t      n, max;
+    FILE        *fp;
+} buf_t;
+
+static uint64_t rng_s;
+
+static inline uint64_t rng(void)
+{
+    rng_s ^= rng_s << 13;
+    rng_s ^= rng_s >> 7;
+    rng_s ^= rng_s << 17;
+    return rng_s;
+}
+
+static inline double rng_f(void)
+{
+    return (rng() >> 11) * 0x1.0p-53;
+}
+
+static double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1E-9 * t.tv_nsec;
+}
+
+//  room for l more bytes
+
+static char *buf_room(buf_t *o, size_t l)
+{
+    if (o->fp != NULL && o->n + l > READ_SZ) {
+        fwrite(o->b, 1, o->n, o->fp);
+        o->n = 0;
+    }
+    if (o->n + l > o->max) {
+        o->max = o->max > 0 ? 2 * o->max : 4 * READ_SZ;
+        while (o->n + l > o->max)
+            o->max *= 2;
+        o->b = (char *) realloc(o->b, o->max);
+        if (o->b == NULL)
+            exit(-1);
+    }
+    return o->b + o->n;
+}
+
+static void buf_str(buf_t *o, const char *s)
+{
+    size_t l = strlen(s);
+
+    memcpy(buf_room(o, l), s, l);
+    o->n += l;
+}
+
+//  base-94 id, as Verilator; lengths from id_len
+
+static void gen_id(char *s, const gen_t *g, size_t i)
+{
+    uint64_t x = i;
+    int     l = 0, k;
+
+    for (k = 1; k < g->id_len; k++)
+        x += (uint64_t) pow(94, k);
+    do {
+        s[l++] = '!' + x % 94;
+        x = x / 94;
+    } while (x > 0 && l < ID_SZ_MAX - 1);
+    s[l] = 0;
+}
+
+//  widths "w:weight,.."
+
+static int gen_dist(gen_t *g, const char *s)
+{
+    char    *p;
+
+    g->n_cls = 0;
+    while (*s != 0 && g->n_cls < WCLS_MAX) {
+        g->cls[g->n_cls].w = strtol(s, &p, 10);
+        if (p == s || *p != ':' || g->cls[g->n_cls].w < 1)
+            return -1;
+        s = p + 1;
+        g->cls[g->n_cls].p = strtod(s, &p);
+        if (p == s)
+            return -1;
+        g->n_cls++;
+        s = *p == ',' ? p + 1 : p;
+    }
+    return g->n_cls > 0 ? 0 : -1;
+}
+
+static int gen_width(const gen_t *g, double tot)
+{
+    double  u = rng_f() * tot;
+    int     i;
+
+    for (i = 0; i < g->n_cls - 1; i++) {
+        u -= g->cls[i].p;
+        if (u < 0.0)
+            break;
+    }
+    return g->cls[i].w;
+}
+
+//  value line of id i
+
+static void gen_val(buf_t *o, const gen_t *g, size_t i, const char *v, int w)
+{
+    char    *p;
+
+    p = buf_room(o, w + ID_SZ_MAX + 4);
+    if (w > 1)
+        *p++ = 'b';
+    memcpy(p, v, w);
+    p += w;
+    if (w > 1)
+        *p++ = ' ';
+    gen_id(p, g, i);
+    p += strlen(p);
+    *p++ = '\n';
+    o->n = p - o->b;
+}
+
+//  one change of id i (new random value with at least one toggle)
+
+static void gen_chg(buf_t *o, const gen_t *g, size_t i, char *v, int w)
+{
+    int     j;
+
+    for (j = 0; j < w; j++) {
+        if (rng() & 1)
+            v[j] ^= 1;
+    }
+    v[rng() % w] ^= 1;
+    gen_val(o, g, i, v, w);
+}
+
+static void gen_vcd(const gen_t *g, buf_t *o)
+{
+    char    line[256], id[ID_SZ_MAX + 1], cyc[32];
+    char    **v;
+    int     *w, d, j, cur[16], nxt[16];
+    size_t  i, k, nchg;
+    double  tot = 0.0;
+    int64_t t;
+
+    rng_s = g->seed * 0x9E3779B97F4A7C15llu + 1;
+    for (j = 0; j < g->n_cls; j++)
+        tot += g->cls[j].p;
+
+    //  id 0: clk, id 1: cycle counter
+    w = (int *) malloc(g->n_id * sizeof(int));
+    v = (char **) malloc(g->n_id * sizeof(char *));
+    if (w == NULL || v == NULL)
+        exit(-1);
+    for (i = 0; i < g->n_id; i++) {
+        w[i] = i == 0 ? 1 : i == 1 ? 26 : gen_width(g, tot);
+        v[i] = (char *) malloc(w[i]);
+        if (v[i] == NULL)
+            exit(-1);
+        memset(v[i], '0', w[i]);
+    }
+
+    buf_str(o, "$version Generated by vcdbench $end\n"
+                "$timescale 100ps $end\n"
+                " $scope module TOP $end\n");
+    gen_id(id, g, 0);
+    snprintf(line, sizeof(line), "  $var wire 1 %s clk $end\n", id);
+    buf_str(o, line);
+    buf_str(o, "  $scope module mldsa_wrap $end\n"
+                "   $scope module dec_prim $end\n");
+    gen_id(id, g, 1);
+    snprintf(line, sizeof(line),
+                "    $var wire 26 %s cyc [25:0] $end\n", id);
+    buf_str(o, line);
+    buf_str(o, "   $upscope $end\n");
+
+    //  groups of 64 ids; the group number in base 16 is the scope path
+    d = 0;
+    for (i = 2; i < g->n_id; i++) {
+        k = (i - 2) / 64;
+        for (j = g->depth - 1; j >= 0; j--) {
+            nxt[j] = k % 16;
+            k /= 16;
+        }
+        for (j = 0; j < d && j < g->depth && cur[j] == nxt[j]; j++)
+            ;
+        while (d > j) {
+            buf_str(o, "   $upscope $end\n");
+            d--;
+        }
+        while (d < g->depth) {
+            snprintf(line, sizeof(line), "   $scope module u%d $end\n",
+                        nxt[d]);
+            buf_str(o, line);
+            cur[d] = nxt[d];
+            d++;
+        }
+        gen_id(id, g, i);
+        if (w[i] > 1)
+            snprintf(cyc, sizeof(cyc), " [%d:0]", w[i] - 1);
+        else
+            cyc[0] = 0;
+        snprintf(line, sizeof(line), "    $var wire %d %s s%zu%s $end\n",
+                    w[i], id, i, cyc);
+        buf_str(o, line);
+        if (rng_f() < g->alias) {
+            snprintf(line, sizeof(line),
+                        "    $var wire %d %s s%zu_a%s $end\n",
+                        w[i], id, i, cyc);
+            buf_str(o, line);
+        }
+    }
+    while (d > 0) {
+        buf_str(o, "   $upscope $end\n");
+        d--;
+    }
+    buf_str(o, "  $upscope $end\n $upscope $end\n$enddefinitions $end\n");
+
+    //  initial values
+    buf_str(o, "#0\n");
+    for (i = 0; i < g->n_id; i++)
+        gen_val(o, g, i, v[i], w[i]);
+
+    //  half cycles: clock, counter on the rising edge, random changes
+    nchg = (size_t) (0.5 * g->dens * (g->n_id - 2) + 0.5);
+    for (t = 1; t <= 2 * g->ncyc; t++) {
+        snprintf(line, sizeof(line), "#%ld\n", 5 * t);
+        buf_str(o, line);
+        v[0][0] ^= 1;
+        gen_val(o, g, 0, v[0], 1);
+        if (v[0][0] == '1') {
+            for (j = 0; j < 26; j++)
+                v[1][j] = '0' + (((t / 2) >> (25 - j)) & 1);
+            gen_val(o, g, 1, v[1], 26);
+        }
+        for (k = 0; k < nchg && g->n_id > 2; k++) {
+            i = 2 + rng() % (g->n_id - 2);
+            gen_chg(o, g, i, v[i], w[i]);
+        }
+    }
+    if (o->fp != NULL) {
+        fwrite(o->b, 1, o->n, o->fp);
+        o->n = 0;
+    }
+
+    for (i = 0; i < g->n_id; i++)
+        free(v[i]);
+    free(v);
+    free(w);
+}
+
+//  === benchmarks
+
+typedef struct {
+    double      sec;                //  best time
+    uint64_t    lines;
+    const vcd_hdr_t *hdr;
+} run_t;
+
+//  parse a VCD in memory with the stream parser; first run builds the
+//  header, the others find it in the cache
+
+static void parse_run(const buf_t *in, run_t *r)
+{
+    vcd_str_t st;
+    char    *buf;
+    size_t  off, n, l;
+    double  t0;
+
+    buf = (char *) malloc(2 * READ_SZ + 1);
+    if (buf == NULL)
+        exit(-1);
+    vcd_str_init(&st, "bench", NULL, "dec_prim.cyc", 1, NULL);
+    n = 0;
+    off = 0;
+    t0 = now();
+    while (off < in->n) {
+        l = in->n - off < READ_SZ ? in->n - off : READ_SZ;
+        memcpy(buf + n, in->b + off, l);
+        off += l;
+        n += l;
+        l = vcd_str_feed(&st, buf, n);
+        n -= l;
+        memmove(buf, buf + l, n);
+    }
+    r->hdr = st.hdr;
+    r->lines = st.line;
+    vcd_str_end(&st, buf, n);
+    r->sec = now() - t0;
+    free(buf);
+}
+
+static void put(const char *name, double v, const char *unit)
+{
+    printf("[bench]\t%-16s\t%12.3f\t%s\n", name, v, unit);
+    fflush(stdout);
+}
+
+static void bench_parse(const gen_t *g, int rep)
+{
+    buf_t   o;
+    run_t   r;
+    double  t, best = INFINITY;
+    int     i;
+
+    memset(&o, 0, sizeof(o));
+    t = now();
+    gen_vcd(g, &o);
+    t = now() - t;
+    put("gen", o.n / t * 1E-6, "MB/s");
+    put("vcd_size", o.n * 1E-6, "MB");
+
+    vcd_hdr_free_all();
+    parse_run(&o, &r);
+    put("parse_first", o.n / r.sec * 1E-6, "MB/s");
+    put("hdr_ids", r.hdr != NULL ? r.hdr->var_n : 0, "ids");
+    for (i = 0; i < rep; i++) {
+        parse_run(&o, &r);
+        if (r.sec < best)
+            best = r.sec;
+    }
+    put("parse", o.n / best * 1E-6, "MB/s");
+    put("parse_lines", r.lines / best * 1E-6, "Mlines/s");
+    free(o.b);
+}
+
+static void bench_lookup(const gen_t *g, int rep)
+{
+    gen_t   g1 = *g;
+    buf_t   o;
+    run_t   r;
+    char    (*id)[ID_SZ_MAX];
+    size_t  n, i, j, hit;
+    double  t, best = INFINITY;
+    int     k;
+
+    //  the preamble only
+    g1.ncyc = 0;
+    memset(&o, 0, sizeof(o));
+    gen_vcd(&g1, &o);
+    vcd_hdr_free_all();
+    parse_run(&o, &r);
+    free(o.b);
+    if (r.hdr == NULL)
+        return;
+
+    n = 1 << 20;
+    id = malloc(n * ID_SZ_MAX);
+    if (id == NULL)
+        exit(-1);
+    for (i = 0; i < n; i++) {
+        j = rng() % r.hdr->var_n;
+        memcpy(id[i], r.hdr->var[j].id, ID_SZ_MAX);
+    }
+    hit = 0;
+    for (k = 0; k < rep; k++) {
+        t = now();
+        for (i = 0; i < n; i++)
+            hit += vcd_find_id(r.hdr, id[i]) != NULL;
+        t = now() - t;
+        if (t < best)
+            best = t;
+    }
+    if (hit != rep * n)
+        fprintf(stderr, "[bench] lookup: %zu misses\n", rep * n - hit);
+    put("lookup", best / n * 1E9, "ns/op");
+    free(id);
+}
+
+//  cost of a change (bit compare and state update) by width
+
+static void bench_hd(const gen_t *g, int rep)
+{
+    static const int wid[] = { 1, 8, 32, 64, 300, 1024, 4096 };
+    gen_t   g1 = *g;
+    buf_t   o;
+    run_t   r;
+    char    name[32];
+    double  best, chg;
+    size_t  i;
+    int     k;
+
+    for (i = 0; i < sizeof(wid) / sizeof(wid[0]); i++) {
+        g1.n_id = 1002;
+        g1.alias = 0.0;
+        g1.n_cls = 1;
+        g1.cls[0].w = wid[i];
+        g1.cls[0].p = 1.0;
+        g1.dens = 1.0;
+        g1.ncyc = 1 + (1 << 22) / (1000 * (wid[i] + 8));
+
+        memset(&o, 0, sizeof(o));
+        gen_vcd(&g1, &o);
+        vcd_hdr_free_all();
+        best = INFINITY;
+        for (k = 0; k < rep + 1; k++) {
+            parse_run(&o, &r);
+            if (k > 0 && r.sec < best)
+                best = r.sec;
+        }
+        chg = 2.0 * g1.ncyc * 500;
+        snprintf(name, sizeof(name), "hd_w%d", wid[i]);
+        put(name, best / chg * 1E9, "ns/chg");
+        free(o.b);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    gen_t   g;
+    buf_t   o;
+    const char *cmd = "all";
+    int     i, rep = 3;
+
+    memset(&g, 0, sizeof(g));
+    g.n_id = 100160;
+    g.alias = 0.65;
+    gen_dist(&g, "1:55,2:5,4:5,8:8,16:5,32:12,64:8,256:1.5,300:0.5,"
+                    "135168:0.005");
+    g.dens = 0.08;
+    g.ncyc = 250;
+    g.id_len = 1;
+    g.depth = 4;
+    g.seed = 1;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            g.n_id = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-a") == 0) {
+            g.alias = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-W") == 0) {
+            if (gen_dist(&g, argv[++i]) != 0) {
+                fputs(usage, stderr);
+                return 1;
+            }
+        } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            g.dens = strtod(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+            g.ncyc = strtoll(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            g.id_len = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-h") == 0) {
+            g.depth = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            g.seed = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            rep = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            cmd = argv[i];
+        } else {
+            fputs(usage, stderr);
+            return 1;
+        }
+    }
+    if (g.n_id < 2 || g.id_len < 1 || g.id_len > ID_SZ_MAX - 1 ||
+        g.depth < 0 || g.depth > 15 || rep < 1) {
+        fputs(usage, stderr);
+        return 1;
+    }
+
+    if (strcmp(cmd, "gen") == 0) {
+        memset(&o, 0, sizeof(o));
+        o.fp = stdout;
+        gen_vcd(&g, &o);
+        free(o.b);
+        return 0;
+    }
+    if (strcmp(cmd, "parse") == 0 || strcmp(cmd, "all") == 0)
+        bench_parse(&g, rep);
+    if (strcmp(cmd, "lookup") == 0 || strcmp(cmd, "all") == 0)
+        bench_lookup(&g, rep);
+    if (strcmp(cmd, "hd") == 0 || strcmp(cmd, "all") == 0)
+        bench_hd(&g, rep);
+    vcd_hdr_free_all();
+
+    return 0;
+}